@@ -19,16 +19,35 @@ package io.glutenproject.execution;
 
 import io.glutenproject.vectorized.CHColumnVector;
 import io.glutenproject.vectorized.GeneralInIterator;
+import org.apache.spark.TaskContext;
 import org.apache.spark.sql.vectorized.ColumnarBatch;
+import org.apache.spark.util.memory.TaskResources;
 
 import java.util.Iterator;
 
 public class ColumnarNativeIterator extends GeneralInIterator implements Iterator<byte[]> {
+  // the task consuming this iterator, it is created on the task thread
+  private final TaskContext taskContext = TaskContext.get();
 
   public ColumnarNativeIterator(Iterator<ColumnarBatch> delegated) {
     super(delegated);
   }
 
+  /**
+   * Called by the native thread prefetching from this iterator before it starts, so that the
+   * delegated iterator runs within the task as it does on the task thread.
+   */
+  public void attachTaskContext() {
+    if (taskContext != null) {
+      TaskResources.setLocalTaskContext(taskContext);
+    }
+  }
+
+  /** Called by the native prefetch thread once it stops reading. */
+  public void detachTaskContext() {
+    TaskResources.unsetLocalTaskContext();
+  }
+
   private static byte[] longtoBytes(long data) {
     return new byte[]{
         (byte) ((data >> 56) & 0xff),
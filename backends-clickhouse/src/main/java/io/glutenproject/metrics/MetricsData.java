@@ -35,6 +35,15 @@ public class MetricsData {
   protected long outputRows = 0;
   protected long outputVectors = 0;
   protected long outputBytes = 0;
+  @JsonProperty("memory_bytes")
+  protected long memoryBytes = 0;
+  // The resources used by the whole task, only set on the root rel.
+  @JsonProperty("cpu_time")
+  protected long cpuTime = 0;
+  @JsonProperty("spill_bytes")
+  protected long spillBytes = 0;
+  @JsonProperty("peak_memory")
+  protected long peakMemory = 0;
   protected List<MetricsStep> steps;
 
   public long getId() {
@@ -132,4 +141,36 @@ public class MetricsData {
   public void setOutputWaitTime(long outputWaitTime) {
     this.outputWaitTime = outputWaitTime;
   }
+
+  public long getCpuTime() {
+    return cpuTime;
+  }
+
+  public void setCpuTime(long cpuTime) {
+    this.cpuTime = cpuTime;
+  }
+
+  public long getMemoryBytes() {
+    return memoryBytes;
+  }
+
+  public void setMemoryBytes(long memoryBytes) {
+    this.memoryBytes = memoryBytes;
+  }
+
+  public long getSpillBytes() {
+    return spillBytes;
+  }
+
+  public void setSpillBytes(long spillBytes) {
+    this.spillBytes = spillBytes;
+  }
+
+  public long getPeakMemory() {
+    return peakMemory;
+  }
+
+  public void setPeakMemory(long peakMemory) {
+    this.peakMemory = peakMemory;
+  }
 }
@@ -113,6 +113,46 @@ public class CHColumnVector extends ColumnVector {
     return nativeGetDouble(rowId, blockAddress, columnPosition);
   }
 
+  private native long nativeCopyRange(
+      long blockAddress,
+      int columnPosition,
+      int rowId,
+      int numRows,
+      long nullsAddress,
+      long valuesAddress,
+      long valuesCapacity,
+      long offsetsAddress);
+
+  /**
+   * Copy rows [rowId, rowId + numRows) of this column into off-heap memory with one native call,
+   * in the layout of Spark's OffHeapColumnVector.
+   *
+   * @param nullsAddress one byte per row, 1 for null. Skipped when 0
+   * @param valuesAddress fixed-width values, or the concatenated bytes of strings
+   * @param valuesCapacity bytes available at valuesAddress
+   * @param offsetsAddress numRows + 1 int offsets into the string bytes, unused for other types
+   * @return bytes written at valuesAddress, or the negated number of bytes needed if valuesCapacity
+   *     is too small, in which case nothing is copied. A negative rowId or numRows, or a range past
+   *     the end of the column, throws an exception
+   */
+  public long copyRange(
+      int rowId,
+      int numRows,
+      long nullsAddress,
+      long valuesAddress,
+      long valuesCapacity,
+      long offsetsAddress) {
+    return nativeCopyRange(
+        blockAddress,
+        columnPosition,
+        rowId,
+        numRows,
+        nullsAddress,
+        valuesAddress,
+        valuesCapacity,
+        offsetsAddress);
+  }
+
   @Override
   public ColumnarArray getArray(int rowId) {
     return null;
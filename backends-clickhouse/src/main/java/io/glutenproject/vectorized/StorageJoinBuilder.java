@@ -36,6 +36,7 @@ public class StorageJoinBuilder implements AutoCloseable {
 
   public static native void nativeCleanBuildHashTable(String hashTableId, long hashTableData);
   public static native long nativeCloneBuildHashTable(long hashTableData);
+  public static native void nativeDropBuildSideCache(String hashTableId);
 
   private ShuffleInputStream in;
 
@@ -37,6 +37,19 @@ class CHMetricsApi extends MetricsApi with Logging with LogLevelUtil {
     MetricsUtil.updateNativeMetrics(child, relMap, joinParamsMap, aggParamsMap)
   }
 
+  override def genWholeStageTransformerMetrics(
+      sparkContext: SparkContext): Map[String, SQLMetric] =
+    super.genWholeStageTransformerMetrics(sparkContext) ++ Map(
+      "cpuTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "cpu time"),
+      "spilledBytes" -> SQLMetrics.createSizeMetric(sparkContext, "bytes written for spilling"),
+      "peakMemoryBytes" -> SQLMetrics.createSizeMetric(sparkContext, "peak memory bytes")
+    )
+
+  override def wholeStageMetricsUpdatingFunction(
+      metrics: Map[String, SQLMetric]): IMetrics => Unit = {
+    MetricsUtil.updateWholeStageMetrics(metrics)
+  }
+
   override def genBatchScanTransformerMetrics(sparkContext: SparkContext): Map[String, SQLMetric] =
     Map(
       "inputRows" -> SQLMetrics.createMetric(sparkContext, "number of input rows"),
@@ -335,7 +348,8 @@ class CHMetricsApi extends MetricsApi with Logging with LogLevelUtil {
       "fillingRightJoinSideTime" -> SQLMetrics.createTimingMetric(
         sparkContext,
         "filling right join side time"),
-      "conditionTime" -> SQLMetrics.createTimingMetric(sparkContext, "join condition time")
+      "conditionTime" -> SQLMetrics.createTimingMetric(sparkContext, "join condition time"),
+      "hashTableBytes" -> SQLMetrics.createSizeMetric(sparkContext, "hash table bytes")
     )
 
   override def genHashJoinTransformerMetricsUpdater(
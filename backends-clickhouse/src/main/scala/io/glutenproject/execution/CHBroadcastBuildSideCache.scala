@@ -81,6 +81,9 @@ object CHBroadcastBuildSideCache extends Logging with RemovalListener[String, Br
   def invalidateBroadcastHashtable(broadcastHashtableId: String): Unit = {
     // Cleanup operations on the backend are idempotent.
     buildSideRelationCache.invalidate(broadcastHashtableId)
+    // The build side cached on local disk outlives the evictions of the hash table, and is
+    // only dropped with the broadcast.
+    StorageJoinBuilder.nativeDropBuildSideCache(broadcastHashtableId)
   }
 
   /** Only used in UT. */
@@ -83,6 +83,7 @@ class HashJoinMetricsUpdater(val metrics: Map[String, SQLMetric])
           metrics("outputVectors") += joinMetricsData.outputVectors
           metrics("inputWaitTime") += (joinMetricsData.inputWaitTime / 1000L).toLong
           metrics("outputWaitTime") += (joinMetricsData.outputWaitTime / 1000L).toLong
+          metrics("hashTableBytes") += joinMetricsData.memoryBytes
           totalTime += joinMetricsData.time
 
           MetricsUtil
@@ -171,6 +171,26 @@ object MetricsUtil extends Logging {
     (newOperatorIdx, curMetricsIdx)
   }
 
+  /**
+   * Update the metrics of the whole stage with the resources used by the task, which native
+   * reports on the root rel, the last of the metrics data.
+   *
+   * @param metrics
+   *   the metrics of the whole stage transformer
+   */
+  def updateWholeStageMetrics(metrics: Map[String, SQLMetric]): IMetrics => Unit = {
+    imetrics =>
+      {
+        val metricsDataList = imetrics.asInstanceOf[NativeMetrics].metricsDataList
+        if (!metricsDataList.isEmpty) {
+          val root = metricsDataList.get(metricsDataList.size() - 1)
+          metrics("cpuTime") += root.cpuTime * 1000L
+          metrics("spilledBytes") += root.spillBytes
+          metrics("peakMemoryBytes") += root.peakMemory
+        }
+      }
+  }
+
   /** Get all processors */
   def getAllProcessorList(metricData: MetricsData): Seq[MetricsProcessor] = {
     metricData.steps.asScala.flatMap(
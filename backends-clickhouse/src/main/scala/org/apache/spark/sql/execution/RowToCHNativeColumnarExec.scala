@@ -59,6 +59,9 @@ case class RowToCHNativeColumnarExec(child: SparkPlan)
               case u: UnsafeRow => u.getBytes
               case i: InternalRow => projection.apply(i).getBytes
             }
+            // The native side stops once a block reaches the configured rows or bytes,
+            // the rest of the rows are converted by the following calls.
+            private val sparkRowIterator = new SparkRowIterator(byteArrayIterator)
 
             private var last_address: Long = 0
 
@@ -67,13 +70,11 @@ case class RowToCHNativeColumnarExec(child: SparkPlan)
                 cvt.freeBlock(last_address)
                 last_address = 0
               }
-              byteArrayIterator.hasNext
+              sparkRowIterator.hasNext
             }
 
             override def next(): ColumnarBatch = {
               val start = System.nanoTime()
-              val slice = byteArrayIterator.take(8192);
-              val sparkRowIterator = new SparkRowIterator(slice)
               last_address =
                 cvt.convertSparkRowsToCHColumn(sparkRowIterator, fieldNames, fieldTypes);
               val block = new CHNativeBlock(last_address)
@@ -28,6 +28,17 @@ import org.apache.spark.sql.execution.metric.{SQLMetric, SQLMetrics}
 import java.{lang, util}
 
 class MetricsHandler extends MetricsApi with Logging{
+  override def genWholeStageTransformerMetrics(
+      sparkContext: SparkContext): Map[String, SQLMetric] =
+    super.genWholeStageTransformerMetrics(sparkContext) ++ Map(
+      "numCoalescedBatches" -> SQLMetrics.createMetric(
+        sparkContext, "number of batches coalesced into output batches"))
+
+  override def wholeStageMetricsUpdatingFunction(
+      metrics: Map[String, SQLMetric]): IMetrics => Unit = {
+    MetricsUtil.updateWholeStageMetrics(metrics)
+  }
+
   override def metricsUpdatingFunction(
       child: SparkPlan,
       relMap: util.HashMap[lang.Long, util.ArrayList[lang.Long]],
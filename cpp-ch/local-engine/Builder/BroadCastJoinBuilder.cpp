@@ -1,5 +1,12 @@
 #include "BroadCastJoinBuilder.h"
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
 #include <jni.h>
+#include <unistd.h>
+#include <IO/MMapReadBufferFromFile.h>
+#include <IO/WriteBufferFromFile.h>
+#include <IO/copyData.h>
 #include <Parser/SerializedPlanParser.h>
 #include <jni/SharedPointerWrapper.h>
 #include <jni/jni_common.h>
@@ -8,6 +15,8 @@
 #include <Common/JNIUtils.h>
 #include <Common/MemoryTracker.h>
 #include <Common/ThreadPool.h>
+#include <Common/escapeForFileName.h>
+#include <Common/thread_local_rng.h>
 #include <Common/logger_useful.h>
 
 namespace DB
@@ -43,8 +52,83 @@ namespace BroadCastJoinBuilder
         DB::JoinKind kind;
         DB::JoinStrictness strictness;
         DB::ColumnsDescription columns;
+        size_t build_threads;
     };
 
+    /// Serialized build sides kept on local disk by hash table id, so that a hash table is built from a memory mapped file
+    /// instead of being streamed from the JVM again. A file outlives the evictions of its hash table from
+    /// CHBroadcastBuildSideCache, and is only removed with the broadcast itself or when the backend is destroyed.
+    /// The files live in a directory of this executor process only, since several executors may share the configured
+    /// cache path.
+    struct LocalCacheFile
+    {
+        /// Held while the build side is copied, so that the hash table is only copied once.
+        std::mutex mutex;
+        std::filesystem::path path;
+        bool written = false;
+        bool removed = false;
+    };
+    /// Only guards the map, the files of different hash tables are copied concurrently.
+    static std::mutex local_cache_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<LocalCacheFile>> local_cache_files;
+
+    static std::filesystem::path localCacheDir()
+    {
+        const auto & config = SerializedPlanParser::global_context->getConfigRef();
+        std::filesystem::path cache_path = config.getString("broadcast_join.local_cache.cache_path", "/tmp/gluten/broadcast_cache");
+        return cache_path / ("executor_" + std::to_string(getpid()));
+    }
+
+    static std::shared_ptr<LocalCacheFile> getLocalCacheFile(const std::string & key)
+    {
+        std::lock_guard lock(local_cache_mutex);
+        auto & cache_file = local_cache_files[key];
+        if (!cache_file)
+        {
+            cache_file = std::make_shared<LocalCacheFile>();
+            cache_file->path = localCacheDir() / (escapeForFileName(key) + ".native");
+        }
+        return cache_file;
+    }
+
+    std::unique_ptr<DB::ReadBuffer> openBuildSide(const StorageJoinContext & context)
+    {
+        /// Owns the global reference to the java stream, even if the stream is not read.
+        auto java_in = std::make_unique<ReadBufferFromJavaInputStream>(context.input, context.io_buffer_size);
+        const auto & config = SerializedPlanParser::global_context->getConfigRef();
+        if (!config.getBool("broadcast_join.local_cache.enabled", false))
+            return java_in;
+
+        auto cache_file = getLocalCacheFile(context.key);
+        std::lock_guard lock(cache_file->mutex);
+        /// The broadcast was dropped meanwhile, don't leave a file behind it
+        if (cache_file->removed)
+            return java_in;
+        if (!cache_file->written)
+        {
+            /// Copy the native blocks as they are, then rename so that a failed copy never leaves a partial file.
+            const auto & file = cache_file->path;
+            std::filesystem::create_directories(file.parent_path());
+            auto tmp_file = file.string() + "." + std::to_string(thread_local_rng()) + ".tmp";
+            try
+            {
+                DB::WriteBufferFromFile out(tmp_file);
+                DB::copyData(*java_in, out);
+                out.finalize();
+                std::filesystem::rename(tmp_file, file);
+            }
+            catch (...)
+            {
+                std::error_code ec;
+                std::filesystem::remove(tmp_file, ec);
+                throw;
+            }
+            cache_file->written = true;
+            LOG_DEBUG(&Poco::Logger::get("BroadCastJoinBuilder"), "Cache broadcast build side {} in {}.", context.key, file.string());
+        }
+        return std::make_unique<DB::MMapReadBufferFromFile>(cache_file->path, 0);
+    }
+
     std::shared_ptr<StorageJoinFromReadBuffer> buildInBackground(
         const std::string & key,
         jobject input,
@@ -55,14 +139,15 @@ namespace BroadCastJoinBuilder
         const DB::ColumnsDescription & columns_)
     {
         std::shared_ptr<StorageJoinFromReadBuffer> result;
-        StorageJoinContext context{key, input, io_buffer_size, key_names_, kind_, strictness_, columns_};
+        size_t build_threads = SerializedPlanParser::global_context->getConfigRef().getUInt64("broadcast_join.build_threads", 1);
+        StorageJoinContext context{key, input, io_buffer_size, key_names_, kind_, strictness_, columns_, build_threads};
         // use another thread, exclude broadcast memory allocation from current memory tracker
         auto func = [&context, &result]() -> void
         {
             try
             {
                 result = std::make_shared<StorageJoinFromReadBuffer>(
-                    std::make_unique<ReadBufferFromJavaInputStream>(context.input, context.io_buffer_size),
+                    openBuildSide(context),
                     context.key_names,
                     true,
                     SizeLimits(),
@@ -71,8 +156,13 @@ namespace BroadCastJoinBuilder
                     context.columns,
                     ConstraintsDescription(),
                     context.key,
-                    true);
-                LOG_DEBUG(&Poco::Logger::get("BroadCastJoinBuilder"), "Create broadcast storage join {}.", context.key);
+                    true,
+                    context.build_threads);
+                LOG_DEBUG(
+                    &Poco::Logger::get("BroadCastJoinBuilder"),
+                    "Create broadcast storage join {} with {} build threads.",
+                    context.key,
+                    context.build_threads);
             }
             catch (DB::Exception & e)
             {
@@ -94,6 +184,28 @@ namespace BroadCastJoinBuilder
         LOG_DEBUG(&Poco::Logger::get("BroadCastJoinBuilder"), "Broadcast hash table {} is cleaned", hash_table_id);
     }
 
+    void dropBuildSideCache(const std::string & hash_table_id)
+    {
+        std::shared_ptr<LocalCacheFile> cache_file;
+        {
+            std::lock_guard lock(local_cache_mutex);
+            auto it = local_cache_files.find(hash_table_id);
+            if (it == local_cache_files.end())
+                return;
+            cache_file = it->second;
+            local_cache_files.erase(it);
+        }
+        /// Waits for a copy in progress. A build side being read keeps its mapping after the file is removed.
+        std::lock_guard lock(cache_file->mutex);
+        cache_file->removed = true;
+        if (cache_file->written)
+        {
+            std::error_code ec;
+            std::filesystem::remove(cache_file->path, ec);
+            LOG_DEBUG(&Poco::Logger::get("BroadCastJoinBuilder"), "Cached broadcast build side {} is dropped", hash_table_id);
+        }
+    }
+
     std::shared_ptr<StorageJoinFromReadBuffer> getJoin(const std::string & key)
     {
         jlong result = callJavaGet(key);
@@ -178,6 +290,14 @@ namespace BroadCastJoinBuilder
     void destroy(JNIEnv * env)
     {
         env->DeleteGlobalRef(Java_CHBroadcastBuildSideCache);
+
+        std::lock_guard lock(local_cache_mutex);
+        if (!local_cache_files.empty())
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(local_cache_files.begin()->second->path.parent_path(), ec);
+            local_cache_files.clear();
+        }
     }
 
 }
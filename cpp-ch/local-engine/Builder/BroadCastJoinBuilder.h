@@ -19,6 +19,8 @@ namespace BroadCastJoinBuilder
         const std::string & join_type,
         const std::string & named_struct);
     void cleanBuildHashTable(const std::string & hash_table_id, jlong instance);
+    /// Remove the build side copied to local disk, once the broadcast itself is not used anymore.
+    void dropBuildSideCache(const std::string & hash_table_id);
     std::shared_ptr<StorageJoinFromReadBuffer> getJoin(const std::string & hash_table_id);
 
 
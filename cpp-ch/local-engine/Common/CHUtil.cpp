@@ -35,6 +35,7 @@
 #include <QueryPipeline/QueryPipelineBuilder.h>
 #include <QueryPipeline/printPipeline.h>
 #include <Storages/Output/WriteBufferBuilder.h>
+#include <Storages/SubstraitSource/ParquetMetaDataCache.h>
 #include <Storages/SubstraitSource/ReadBufferBuilder.h>
 #include <substrait/algebra.pb.h>
 #include <substrait/plan.pb.h>
@@ -481,6 +482,8 @@ void BackendInitializerUtil::initConfig(std::string * plan)
             config->setString(key.substr(CH_RUNTIME_CONFIG_PREFIX.size()), value);
         else if (S3_CONFIGS.find(key) != S3_CONFIGS.end())
             config->setString(S3_CONFIGS.at(key), value);
+        else if (key == GLUTEN_TASK_OFFHEAP)
+            config->setString("task_offheap_size_in_bytes", value);
     }
 }
 
@@ -650,6 +653,12 @@ void BackendInitializerUtil::init(std::string * plan)
             initCompiledExpressionCache();
             LOG_INFO(logger, "Init compiled expressions cache factory.");
 
+#if USE_PARQUET
+            /// 0 disables the cache
+            ParquetMetaDataCache::instance().init(config->getUInt64("parquet_metadata_cache_size", 256UL << 20));
+            LOG_INFO(logger, "Init parquet metadata cache.");
+#endif
+
             GlobalThreadPool::initialize();
 
             const size_t active_parts_loading_threads = config->getUInt("max_active_parts_loading_thread_pool_size", 64);
@@ -669,6 +678,16 @@ void BackendFinalizerUtil::finalizeGlobally()
     auto * logger = BackendInitializerUtil::logger;
     if (global_context)
     {
+#if USE_PARQUET
+        const auto stats = ParquetMetaDataCache::instance().getStats();
+        LOG_INFO(
+            logger,
+            "Parquet metadata cache: {} hits, {} misses, {} entries of {} bytes.",
+            stats.hits,
+            stats.misses,
+            stats.entries,
+            stats.bytes);
+#endif
         global_context->shutdown();
         global_context.reset();
         shared_context.reset();
@@ -4,10 +4,10 @@ namespace local_engine
 {
 JNIEnv * JNIUtils::getENV(int * attach)
 {
+    *attach = 0;
     if (vm == nullptr)
         return nullptr;
 
-    *attach = 0;
     JNIEnv * jni_env = nullptr;
 
     int status = vm->GetEnv(reinterpret_cast<void **>(&jni_env), JNI_VERSION_1_8);
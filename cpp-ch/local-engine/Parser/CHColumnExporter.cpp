@@ -0,0 +1,114 @@
+#include "CHColumnExporter.h"
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnString.h>
+#include <Columns/ColumnsNumber.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <DataTypes/IDataType.h>
+#include <Common/Exception.h>
+#include <Common/assert_cast.h>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+    extern const int BAD_ARGUMENTS;
+    extern const int UNKNOWN_TYPE;
+}
+}
+
+namespace local_engine
+{
+using namespace DB;
+
+CHColumnExporter::CHColumnExporter(const ColumnWithTypeAndName & column, size_t from_, size_t length_) : from(from_), length(length_)
+{
+    full_column = column.column->convertToFullColumnIfConst();
+    if (from > full_column->size() || length > full_column->size() - from)
+        throw Exception(
+            ErrorCodes::BAD_ARGUMENTS,
+            "Rows [{}, {}) out of range of column {} with {} rows",
+            from,
+            from + length,
+            column.name,
+            full_column->size());
+
+    if (const auto * nullable = checkAndGetColumn<ColumnNullable>(*full_column))
+    {
+        null_map = &nullable->getNullMapData();
+        nested_column = nullable->getNestedColumnPtr();
+    }
+    else
+        nested_column = full_column;
+    nested_type = removeNullable(column.type);
+
+    WhichDataType which(nested_type);
+    if (which.isString())
+        is_string = true;
+    else if (which.isDate())
+    {
+        is_date = true;
+        value_size = sizeof(Int32);
+    }
+    else if (
+        which.isUInt8() || which.isInt8() || which.isInt16() || which.isInt32() || which.isInt64() || which.isFloat32()
+        || which.isFloat64() || which.isDate32() || which.isDecimal32() || which.isDecimal64() || which.isDateTime64())
+        value_size = nested_type->getSizeOfValueInMemory();
+    else
+        throw Exception(ErrorCodes::UNKNOWN_TYPE, "CHColumnExporter doesn't support type {}", nested_type->getName());
+}
+
+size_t CHColumnExporter::valuesBytes() const
+{
+    if (!is_string)
+        return value_size * length;
+    if (!length)
+        return 0;
+
+    /// Offsets include the terminating zero of each string
+    const auto & offsets = assert_cast<const ColumnString &>(*nested_column).getOffsets();
+    return offsets[from + length - 1] - offsets[from - 1] - length;
+}
+
+void CHColumnExporter::exportNulls(UInt8 * dst) const
+{
+    if (null_map)
+        memcpy(dst, null_map->data() + from, length);
+    else
+        memset(dst, 0, length);
+}
+
+void CHColumnExporter::exportValues(char * values_dst, Int32 * offsets_dst) const
+{
+    if (is_string)
+    {
+        const auto & string_column = assert_cast<const ColumnString &>(*nested_column);
+        const auto & offsets = string_column.getOffsets();
+        const auto * chars = string_column.getChars().data();
+        Int32 pos = 0;
+        offsets_dst[0] = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            size_t row = from + i;
+            size_t size = offsets[row] - offsets[row - 1] - 1;
+            memcpy(values_dst + pos, chars + offsets[row - 1], size);
+            pos += size;
+            offsets_dst[i + 1] = pos;
+        }
+        return;
+    }
+
+    if (!length)
+        return;
+
+    if (is_date)
+    {
+        const auto & data = assert_cast<const ColumnUInt16 &>(*nested_column).getData();
+        auto * out = reinterpret_cast<Int32 *>(values_dst);
+        for (size_t i = 0; i < length; ++i)
+            out[i] = data[from + i];
+        return;
+    }
+
+    memcpy(values_dst, nested_column->getDataAt(from).data, value_size * length);
+}
+}
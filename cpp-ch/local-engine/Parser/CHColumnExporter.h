@@ -0,0 +1,39 @@
+#pragma once
+#include <Core/ColumnWithTypeAndName.h>
+#include <Core/Types.h>
+
+namespace local_engine
+{
+/// Copies rows [from, from + length) of a CH column into caller provided memory in the layout of Spark's
+/// off-heap column vectors, so that a column-wise reader pays one JNI call per column per batch instead of one per value.
+///  - nulls: one byte per row, 1 for null
+///  - fixed-width values: packed in Spark's width, Date is widened to Int32 days
+///  - strings: length + 1 Int32 offsets starting from 0, and the concatenated bytes without terminating zeros
+class CHColumnExporter
+{
+public:
+    CHColumnExporter(const DB::ColumnWithTypeAndName & column, size_t from_, size_t length_);
+
+    bool isString() const { return is_string; }
+
+    /// Bytes taken by the exported values of the range
+    size_t valuesBytes() const;
+
+    void exportNulls(UInt8 * dst) const;
+
+    /// offsets_dst is only written for strings
+    void exportValues(char * values_dst, Int32 * offsets_dst) const;
+
+private:
+    /// Owns the materialized column of a const input, which null_map and nested_column point into
+    DB::ColumnPtr full_column;
+    DB::ColumnPtr nested_column;
+    DB::DataTypePtr nested_type;
+    const DB::NullMap * null_map = nullptr;
+    size_t from;
+    size_t length;
+    bool is_string = false;
+    bool is_date = false;
+    size_t value_size = 0;
+};
+}
@@ -5,6 +5,7 @@
 #include <Columns/ColumnMap.h>
 #include <Columns/ColumnNullable.h>
 #include <Columns/ColumnString.h>
+#include <Columns/ColumnTuple.h>
 #include <Columns/IColumn.h>
 #include <Core/Types.h>
 #include <DataTypes/DataTypeArray.h>
@@ -67,6 +68,18 @@ ALWAYS_INLINE bool isBitSet(const char * bitmap, int32_t index)
     return word & mask;
 }
 
+/// Types of the elements of an array, of the keys and values of a map or of the fields of a tuple
+static DataTypes getChildTypes(const DataTypePtr & type_without_nullable)
+{
+    if (const auto * array_type = typeid_cast<const DataTypeArray *>(type_without_nullable.get()))
+        return {array_type->getNestedType()};
+    if (const auto * map_type = typeid_cast<const DataTypeMap *>(type_without_nullable.get()))
+        return {map_type->getKeyType(), map_type->getValueType()};
+    if (const auto * tuple_type = typeid_cast<const DataTypeTuple *>(type_without_nullable.get()))
+        return tuple_type->getElements();
+    return {};
+}
+
 static void writeFixedLengthNonNullableValue(
     char * buffer_address, int64_t field_offset, const ColumnWithTypeAndName & col, int64_t num_rows, const std::vector<int64_t> & offsets)
 {
@@ -134,11 +147,9 @@ static void writeVariableLengthNonNullableValue(
     }
     else
     {
-        Field field;
         for (size_t i = 0; i < static_cast<size_t>(num_rows); i++)
         {
-            field = std::move((*col.column)[i]);
-            int64_t offset_and_size = writer.write(i, field, 0);
+            int64_t offset_and_size = writer.write(i, *col.column, i, 0);
             memcpy(buffer_address + offsets[i] + field_offset, &offset_and_size, 8);
         }
     }
@@ -186,15 +197,13 @@ static void writeVariableLengthNullableValue(
     }
     else
     {
-        Field field;
         for (size_t i = 0; i < static_cast<size_t>(num_rows); i++)
         {
             if (null_map[i])
                 bitSet(buffer_address + offsets[i], col_index);
             else
             {
-                field = std::move(nested_column[i]);
-                int64_t offset_and_size = writer.write(i, field, 0);
+                int64_t offset_and_size = writer.write(i, nested_column, i, 0);
                 memcpy(buffer_address + offsets[i] + field_offset, &offset_and_size, 8);
             }
         }
@@ -280,11 +289,9 @@ SparkRowInfo::SparkRowInfo(
             else
             {
                 BackingDataLengthCalculator calculator(col.type);
+                auto column = col.column->convertToFullColumnIfConst();
                 for (auto row_idx = 0; row_idx < num_rows; ++row_idx)
-                {
-                    const auto field = (*col.column)[row_idx];
-                    lengths[row_idx] += calculator.calculate(field);
-                }
+                    lengths[row_idx] += calculator.calculate(*column, row_idx);
             }
         }
     }
@@ -448,9 +455,14 @@ std::unique_ptr<SparkRowInfo> CHColumnToSparkRow::convertCHColumnToSparkRow(cons
         spark_row_info = std::make_unique<SparkRowInfo>(block);
         columns = block.getColumnsWithTypeAndName();
     }
-    spark_row_info->setBufferAddress(reinterpret_cast<char *>(alloc(spark_row_info->getTotalBytes(), 64)));
+    spark_row_info->setBufferAddress(allocBuffer(spark_row_info->getTotalBytes()));
     // spark_row_info->setBufferAddress(alignedAlloc(spark_row_info->getTotalBytes(), 64));
-    memset(spark_row_info->getBufferAddress(), 0, spark_row_info->getTotalBytes());
+
+    /// Only the null bitsets and the field values of the rows are zeroed, the writers zero
+    /// the padding and the null slots of the backing data themselves.
+    const auto fixed_size_per_row = calculatedFixeSizePerRow(spark_row_info->getNumCols());
+    for (int64_t row_idx = 0; row_idx < spark_row_info->getNumRows(); ++row_idx)
+        memset(spark_row_info->getBufferAddress() + spark_row_info->getOffsets()[row_idx], 0, fixed_size_per_row);
     for (auto col_idx = 0; col_idx < spark_row_info->getNumCols(); col_idx++)
     {
         const auto & col = columns[col_idx];
@@ -469,18 +481,119 @@ std::unique_ptr<SparkRowInfo> CHColumnToSparkRow::convertCHColumnToSparkRow(cons
     return spark_row_info;
 }
 
+CHColumnToSparkRow::~CHColumnToSparkRow()
+{
+    /// A buffer still in use is owned by its reader, which must have freed it through this converter
+    if (cached_buffer && !cached_buffer_in_use)
+        free(cached_buffer, cached_buffer_capacity);
+}
+
+char * CHColumnToSparkRow::allocBuffer(size_t size)
+{
+    if (!reuse_buffer || cached_buffer_in_use)
+        return reinterpret_cast<char *>(alloc(size, 64));
+
+    if (cached_buffer_capacity < size)
+    {
+        if (cached_buffer)
+            free(cached_buffer, cached_buffer_capacity);
+        /// Leave some room so that slightly larger batches still fit
+        cached_buffer_capacity = roundNumberOfBytesToNearestWord(size + size / 4);
+        cached_buffer = reinterpret_cast<char *>(alloc(cached_buffer_capacity, 64));
+    }
+    cached_buffer_in_use = true;
+    return cached_buffer;
+}
+
 void CHColumnToSparkRow::freeMem(char * address, size_t size)
 {
+    if (address && address == cached_buffer)
+    {
+        cached_buffer_in_use = false;
+        return;
+    }
     free(address, size);
     // rollback(size);
 }
 
 BackingDataLengthCalculator::BackingDataLengthCalculator(const DataTypePtr & type_)
-    : type_without_nullable(removeNullable(type_)), which(type_without_nullable)
+    : type_without_nullable(removeNullable(type_)), which(type_without_nullable), child_types(getChildTypes(type_without_nullable))
 {
     if (!isFixedLengthDataType(type_without_nullable) && !isVariableLengthDataType(type_without_nullable))
         throw Exception(
             ErrorCodes::UNKNOWN_TYPE, "Doesn't support type {} for BackingDataLengthCalculator", type_without_nullable->getName());
+
+    child_calculators.resize(child_types.size());
+    for (size_t i = 0; i < child_types.size(); ++i)
+        if (isVariableLengthDataType(removeNullable(child_types[i])))
+            child_calculators[i] = std::make_unique<BackingDataLengthCalculator>(child_types[i]);
+}
+
+int64_t BackingDataLengthCalculator::calculate(const IColumn & column, size_t row_idx) const
+{
+    const IColumn * data = &column;
+    if (const auto * nullable_column = checkAndGetColumn<ColumnNullable>(column))
+    {
+        if (nullable_column->isNullAt(row_idx))
+            return 0;
+        data = &nullable_column->getNestedColumn();
+    }
+
+    if (isFixedLengthDataType(type_without_nullable))
+        return 0;
+
+    if (which.isStringOrFixedString())
+        return roundNumberOfBytesToNearestWord(data->getDataAt(row_idx).size);
+
+    if (which.isDecimal128())
+        return 16;
+
+    if (which.isArray())
+    {
+        const auto & array_column = assert_cast<const ColumnArray &>(*data);
+        const auto & array_offsets = array_column.getOffsets();
+        return calculateArrayElements(array_column.getData(), 0, array_offsets[row_idx - 1], array_offsets[row_idx]);
+    }
+
+    if (which.isMap())
+    {
+        /// 内存布局：Length of UnsafeArrayData of key(8B) |  UnsafeArrayData of key | UnsafeArrayData of value
+        const auto & array_column = assert_cast<const ColumnMap &>(*data).getNestedColumn();
+        const auto & array_offsets = array_column.getOffsets();
+        const auto & tuple_column = assert_cast<const ColumnTuple &>(array_column.getData());
+        const size_t begin = array_offsets[row_idx - 1];
+        const size_t end = array_offsets[row_idx];
+        return 8 + calculateArrayElements(tuple_column.getColumn(0), 0, begin, end)
+            + calculateArrayElements(tuple_column.getColumn(1), 1, begin, end);
+    }
+
+    if (which.isTuple())
+    {
+        /// 内存布局：null_bitmap(字节数与字段数成正比) | field1 value(8B) | field2 value(8B) | ... | fieldn value(8B) | backing buffer
+        const auto & tuple_column = assert_cast<const ColumnTuple &>(*data);
+        const auto num_fields = child_types.size();
+        int64_t res = calculateBitSetWidthInBytes(num_fields) + 8 * num_fields;
+        for (size_t i = 0; i < num_fields; ++i)
+            if (child_calculators[i])
+                res += child_calculators[i]->calculate(tuple_column.getColumn(i), row_idx);
+        return res;
+    }
+
+    throw Exception(
+        ErrorCodes::UNKNOWN_TYPE, "Doesn't support type {} for BackingBufferLengthCalculator", type_without_nullable->getName());
+}
+
+int64_t BackingDataLengthCalculator::calculateArrayElements(const IColumn & elems, size_t child, size_t begin, size_t end) const
+{
+    /// 内存布局：numElements(8B) | null_bitmap(与numElements成正比) | values(每个值长度与类型有关) | backing buffer
+    const auto num_elems = end - begin;
+    int64_t res = 8 + calculateBitSetWidthInBytes(num_elems);
+    res += roundNumberOfBytesToNearestWord(getArrayElementSize(child_types[child]) * num_elems);
+
+    if (const auto & calculator = child_calculators[child])
+        for (size_t i = begin; i < end; ++i)
+            res += calculator->calculate(elems, i);
+    return res;
 }
 
 int64_t BackingDataLengthCalculator::calculate(const Field & field) const
@@ -634,6 +747,7 @@ VariableLengthDataWriter::VariableLengthDataWriter(
     const DataTypePtr & type_, char * buffer_address_, const std::vector<int64_t> & offsets_, std::vector<int64_t> & buffer_cursor_)
     : type_without_nullable(removeNullable(type_))
     , which(type_without_nullable)
+    , child_types(getChildTypes(type_without_nullable))
     , buffer_address(buffer_address_)
     , offsets(offsets_)
     , buffer_cursor(buffer_cursor_)
@@ -643,6 +757,16 @@ VariableLengthDataWriter::VariableLengthDataWriter(
 
     if (!BackingDataLengthCalculator::isVariableLengthDataType(type_without_nullable))
         throw Exception(ErrorCodes::UNKNOWN_TYPE, "VariableLengthDataWriter doesn't support type {}", type_without_nullable->getName());
+
+    child_writers.resize(child_types.size());
+    for (size_t i = 0; i < child_types.size(); ++i)
+    {
+        const auto child_type_without_nullable = removeNullable(child_types[i]);
+        if (BackingDataLengthCalculator::isVariableLengthDataType(child_type_without_nullable))
+            child_writers[i] = std::make_unique<VariableLengthDataWriter>(child_types[i], buffer_address, offsets, buffer_cursor);
+        else if (!BackingDataLengthCalculator::isFixedLengthDataType(child_type_without_nullable))
+            throw Exception(ErrorCodes::UNKNOWN_TYPE, "VariableLengthDataWriter doesn't support type {}", child_types[i]->getName());
+    }
 }
 
 int64_t VariableLengthDataWriter::writeArray(size_t row_idx, const DB::Array & array, int64_t parent_offset)
@@ -661,14 +785,12 @@ int64_t VariableLengthDataWriter::writeArray(size_t row_idx, const DB::Array & a
     if (num_elems == 0)
         return BackingDataLengthCalculator::getOffsetAndSize(start - parent_offset, 8);
 
-    /// Skip null_bitmap(already reset to zero)
+    /// Reset null_bitmap and values to zero and skip them
     const auto len_null_bitmap = calculateBitSetWidthInBytes(num_elems);
-    cursor += len_null_bitmap;
-
-    /// Skip values(already reset to zero)
     const auto elem_size = BackingDataLengthCalculator::getArrayElementSize(nested_type);
     const auto len_values = roundNumberOfBytesToNearestWord(elem_size * num_elems);
-    cursor += len_values;
+    memset(buffer_address + offset + cursor, 0, len_null_bitmap + len_values);
+    cursor += len_null_bitmap + len_values;
 
     if (BackingDataLengthCalculator::isFixedLengthDataType(removeNullable(nested_type)))
     {
@@ -764,10 +886,10 @@ int64_t VariableLengthDataWriter::writeStruct(size_t row_idx, const DB::Tuple &
     if (num_fields == 0)
         return BackingDataLengthCalculator::getOffsetAndSize(start - parent_offset, 0);
     const auto len_null_bitmap = calculateBitSetWidthInBytes(num_fields);
-    cursor += len_null_bitmap;
 
-    /// Skip values
-    cursor += num_fields * 8;
+    /// Reset null_bitmap and values to zero and skip them
+    memset(buffer_address + offset + cursor, 0, len_null_bitmap + num_fields * 8);
+    cursor += len_null_bitmap + num_fields * 8;
 
     /// If field type is fixed-length, fill field value in values region
     /// else append it to backing data region, and update offset_and_size in values region
@@ -841,6 +963,180 @@ int64_t VariableLengthDataWriter::write(size_t row_idx, const DB::Field & field,
     throw Exception(ErrorCodes::UNKNOWN_TYPE, "Doesn't support type {} for BackingDataWriter", type_without_nullable->getName());
 }
 
+int64_t VariableLengthDataWriter::writeArrayElements(
+    size_t row_idx, const IColumn & elems, size_t child, size_t begin, size_t end, int64_t parent_offset)
+{
+    /// 内存布局：numElements(8B) | null_bitmap(与numElements成正比) | values(每个值长度与类型有关) | backing data
+    const auto & offset = offsets[row_idx];
+    auto & cursor = buffer_cursor[row_idx];
+    const auto num_elems = end - begin;
+    const auto & nested_type = child_types[child];
+
+    /// Write numElements(8B)
+    const auto start = cursor;
+    memcpy(buffer_address + offset + cursor, &num_elems, 8);
+    cursor += 8;
+    if (num_elems == 0)
+        return BackingDataLengthCalculator::getOffsetAndSize(start - parent_offset, 8);
+
+    /// Skip null_bitmap and values, they are filled in place below
+    char * null_bitmap = buffer_address + offset + start + 8;
+    const auto len_null_bitmap = calculateBitSetWidthInBytes(num_elems);
+    char * values = null_bitmap + len_null_bitmap;
+    const auto elem_size = BackingDataLengthCalculator::getArrayElementSize(nested_type);
+    const auto len_values = roundNumberOfBytesToNearestWord(elem_size * num_elems);
+    cursor += len_null_bitmap + len_values;
+    memset(null_bitmap, 0, len_null_bitmap);
+
+    const IColumn * data = &elems;
+    const NullMap * null_map = nullptr;
+    if (const auto * nullable_column = checkAndGetColumn<ColumnNullable>(elems))
+    {
+        data = &nullable_column->getNestedColumn();
+        null_map = &nullable_column->getNullMapData();
+        for (size_t i = 0; i < num_elems; ++i)
+            if ((*null_map)[begin + i])
+                bitSet(null_bitmap, i);
+    }
+
+    if (const auto & writer = child_writers[child])
+    {
+        /// Append variable-length values in backing data recursively, the slots of null elements stay zero
+        memset(values, 0, len_values);
+        for (size_t i = 0; i < num_elems; ++i)
+        {
+            if (null_map && (*null_map)[begin + i])
+                continue;
+            const auto offset_and_size = writer->write(row_idx, *data, begin + i, start);
+            memcpy(values + i * 8, &offset_and_size, 8);
+        }
+    }
+    else if (!WhichDataType(removeNullable(nested_type)).isNothing())
+    {
+        /// Fixed-length values are laid out as in the CH column, copy them at once
+        const auto value_size = removeNullable(nested_type)->getSizeOfValueInMemory();
+        if (static_cast<int64_t>(value_size) == elem_size)
+            memcpy(values, data->getDataAt(begin).data, value_size * num_elems);
+        else
+        {
+            memset(values, 0, len_values);
+            for (size_t i = 0; i < num_elems; ++i)
+                memcpy(values + i * elem_size, data->getDataAt(begin + i).data, value_size);
+        }
+        memset(values + elem_size * num_elems, 0, len_values - elem_size * num_elems);
+
+        /// Spark zeroes the values of null elements, the nested column may hold anything there
+        if (null_map)
+            for (size_t i = 0; i < num_elems; ++i)
+                if ((*null_map)[begin + i])
+                    memset(values + i * elem_size, 0, elem_size);
+    }
+    else
+        memset(values, 0, len_values);
+    return BackingDataLengthCalculator::getOffsetAndSize(start - parent_offset, cursor - start);
+}
+
+int64_t VariableLengthDataWriter::writeStruct(size_t row_idx, const ColumnTuple & column, size_t column_row_idx, int64_t parent_offset)
+{
+    /// 内存布局：null_bitmap(字节数与字段数成正比) | values(num_fields * 8B) | backing data
+    const auto & offset = offsets[row_idx];
+    auto & cursor = buffer_cursor[row_idx];
+    const auto start = cursor;
+
+    const auto num_fields = child_types.size();
+    if (num_fields == 0)
+        return BackingDataLengthCalculator::getOffsetAndSize(start - parent_offset, 0);
+
+    /// Reset null_bitmap and values to zero and skip them
+    const auto len_null_bitmap = calculateBitSetWidthInBytes(num_fields);
+    memset(buffer_address + offset + cursor, 0, len_null_bitmap + num_fields * 8);
+    cursor += len_null_bitmap + num_fields * 8;
+
+    for (size_t i = 0; i < num_fields; ++i)
+    {
+        const IColumn * field_column = &column.getColumn(i);
+        if (const auto * nullable_column = checkAndGetColumn<ColumnNullable>(*field_column))
+        {
+            if (nullable_column->isNullAt(column_row_idx))
+            {
+                bitSet(buffer_address + offset + start, i);
+                continue;
+            }
+            field_column = &nullable_column->getNestedColumn();
+        }
+
+        char * field_value = buffer_address + offset + start + len_null_bitmap + i * 8;
+        if (const auto & writer = child_writers[i])
+        {
+            const auto offset_and_size = writer->write(row_idx, *field_column, column_row_idx, start);
+            memcpy(field_value, &offset_and_size, 8);
+        }
+        else
+        {
+            const auto value = field_column->getDataAt(column_row_idx);
+            memcpy(field_value, value.data, value.size);
+        }
+    }
+    return BackingDataLengthCalculator::getOffsetAndSize(start - parent_offset, cursor - start);
+}
+
+int64_t VariableLengthDataWriter::write(size_t row_idx, const IColumn & column, size_t column_row_idx, int64_t parent_offset)
+{
+    assert(row_idx < offsets.size());
+
+    if (which.isStringOrFixedString())
+    {
+        const auto str = column.getDataAt(column_row_idx);
+        return writeUnalignedBytes(row_idx, str.data, str.size, parent_offset);
+    }
+
+    if (which.isDecimal128())
+    {
+        const auto value = column.getDataAt(column_row_idx);
+        String buf(value.data, value.size);
+        BackingDataLengthCalculator::swapDecimalEndianBytes(buf);
+        return writeUnalignedBytes(row_idx, buf.data(), buf.size(), parent_offset);
+    }
+
+    if (which.isArray())
+    {
+        const auto & array_column = assert_cast<const ColumnArray &>(column);
+        const auto & array_offsets = array_column.getOffsets();
+        return writeArrayElements(
+            row_idx, array_column.getData(), 0, array_offsets[column_row_idx - 1], array_offsets[column_row_idx], parent_offset);
+    }
+
+    if (which.isMap())
+    {
+        /// 内存布局：Length of UnsafeArrayData of key(8B) |  UnsafeArrayData of key | UnsafeArrayData of value
+        const auto & array_column = assert_cast<const ColumnMap &>(column).getNestedColumn();
+        const auto & array_offsets = array_column.getOffsets();
+        const auto & tuple_column = assert_cast<const ColumnTuple &>(array_column.getData());
+        const size_t begin = array_offsets[column_row_idx - 1];
+        const size_t end = array_offsets[column_row_idx];
+
+        /// Skip length of UnsafeArrayData of key(8B)
+        const auto offset = offsets[row_idx];
+        auto & cursor = buffer_cursor[row_idx];
+        const auto start = cursor;
+        cursor += 8;
+
+        /// Append UnsafeArrayData of key and fill its length
+        const auto key_array_size = BackingDataLengthCalculator::extractSize(
+            writeArrayElements(row_idx, tuple_column.getColumn(0), 0, begin, end, start + 8));
+        memcpy(buffer_address + offset + start, &key_array_size, 8);
+
+        /// Append UnsafeArrayData of value
+        writeArrayElements(row_idx, tuple_column.getColumn(1), 1, begin, end, start + 8 + key_array_size);
+        return BackingDataLengthCalculator::getOffsetAndSize(start - parent_offset, cursor - start);
+    }
+
+    if (which.isTuple())
+        return writeStruct(row_idx, assert_cast<const ColumnTuple &>(column), column_row_idx, parent_offset);
+
+    throw Exception(ErrorCodes::UNKNOWN_TYPE, "Doesn't support type {} for BackingDataWriter", type_without_nullable->getName());
+}
+
 int64_t BackingDataLengthCalculator::getOffsetAndSize(int64_t cursor, int64_t size)
 {
     return (cursor << 32) | size;
@@ -858,9 +1154,12 @@ int64_t BackingDataLengthCalculator::extractSize(int64_t offset_and_size)
 
 int64_t VariableLengthDataWriter::writeUnalignedBytes(size_t row_idx, const char * src, size_t size, int64_t parent_offset)
 {
-    memcpy(buffer_address + offsets[row_idx] + buffer_cursor[row_idx], src, size);
+    char * dst = buffer_address + offsets[row_idx] + buffer_cursor[row_idx];
+    const auto size_with_padding = roundNumberOfBytesToNearestWord(size);
+    memcpy(dst, src, size);
+    memset(dst + size, 0, size_with_padding - size);
     auto res = BackingDataLengthCalculator::getOffsetAndSize(buffer_cursor[row_idx] - parent_offset, size);
-    buffer_cursor[row_idx] += roundNumberOfBytesToNearestWord(size);
+    buffer_cursor[row_idx] += size_with_padding;
     return res;
 }
 
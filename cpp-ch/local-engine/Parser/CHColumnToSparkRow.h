@@ -5,6 +5,11 @@
 #include <Common/Allocator.h>
 #include <Common/Arena.h>
 
+namespace DB
+{
+class ColumnTuple;
+}
+
 
 namespace local_engine
 {
@@ -66,8 +71,21 @@ class CHColumnToSparkRow : private Allocator<false, true>
 // class CHColumnToSparkRow : public DB::Arena
 {
 public:
+    /// With reuse_buffer_, the buffer of a batch is kept when it is freed and serves the following batches that fit in it.
+    /// Then every buffer must be freed with freeMem of this converter before it is destroyed.
+    explicit CHColumnToSparkRow(bool reuse_buffer_ = false) : reuse_buffer(reuse_buffer_) { }
+    ~CHColumnToSparkRow();
+
     std::unique_ptr<SparkRowInfo> convertCHColumnToSparkRow(const DB::Block & block);
     void freeMem(char * address, size_t size);
+
+private:
+    char * allocBuffer(size_t size);
+
+    const bool reuse_buffer;
+    char * cached_buffer = nullptr;
+    size_t cached_buffer_capacity = 0;
+    bool cached_buffer_in_use = false;
 };
 
 /// Return backing data length of values with variable-length type in bytes
@@ -82,6 +100,10 @@ public:
     /// Return length is guranteed to round up to 8
     virtual int64_t calculate(const DB::Field & field) const;
 
+    /// Same as calculate(field) for the value at row_idx of column, which has the type of the calculator.
+    /// Nested values are read from the columns directly, without materializing Fields.
+    int64_t calculate(const DB::IColumn & column, size_t row_idx) const;
+
     static int64_t getArrayElementSize(const DB::DataTypePtr & nested_type);
 
     /// Is CH DataType can be converted to fixed-length data type in Spark?
@@ -106,9 +128,17 @@ public:
     static int64_t extractSize(int64_t offset_and_size);
 
 private:
+    /// Backing data length of the elements [begin, end) of elems as UnsafeArrayData, elems has type child_types[child].
+    int64_t calculateArrayElements(const DB::IColumn & elems, size_t child, size_t begin, size_t end) const;
+
     // const DB::DataTypePtr type;
     const DB::DataTypePtr type_without_nullable;
     const DB::WhichDataType which;
+
+    /// Types of the elements of an array, of the keys and values of a map or of the fields of a tuple.
+    DB::DataTypes child_types;
+    /// Calculators for the variable-length child types, nullptr for the fixed-length ones.
+    std::vector<std::unique_ptr<BackingDataLengthCalculator>> child_calculators;
 };
 
 /// Writing variable-length typed values to backing data region of Spark Row
@@ -130,6 +160,10 @@ public:
     /// parent_offset: the starting offset of current structure in which we are updating it's backing data region
     virtual int64_t write(size_t row_idx, const DB::Field & field, int64_t parent_offset);
 
+    /// Same as write(row_idx, field, parent_offset) for the value at column_row_idx of column.
+    /// column must not be nullable, nested values are read from the columns directly, without materializing Fields.
+    int64_t write(size_t row_idx, const DB::IColumn & column, size_t column_row_idx, int64_t parent_offset);
+
     /// Only support String/FixedString/Decimal128
     int64_t writeUnalignedBytes(size_t row_idx, const char * src, size_t size, int64_t parent_offset);
 
@@ -138,10 +172,19 @@ private:
     int64_t writeMap(size_t row_idx, const DB::Map & map, int64_t parent_offset);
     int64_t writeStruct(size_t row_idx, const DB::Tuple & tuple, int64_t parent_offset);
 
+    /// Write the elements [begin, end) of elems as UnsafeArrayData, elems has type child_types[child].
+    int64_t writeArrayElements(size_t row_idx, const DB::IColumn & elems, size_t child, size_t begin, size_t end, int64_t parent_offset);
+    int64_t writeStruct(size_t row_idx, const DB::ColumnTuple & column, size_t column_row_idx, int64_t parent_offset);
+
     // const DB::DataTypePtr type;
     const DB::DataTypePtr type_without_nullable;
     const DB::WhichDataType which;
 
+    /// Types of the elements of an array, of the keys and values of a map or of the fields of a tuple.
+    DB::DataTypes child_types;
+    /// Writers for the variable-length child types, nullptr for the fixed-length ones.
+    std::vector<std::unique_ptr<VariableLengthDataWriter>> child_writers;
+
     /// Global buffer of spark rows
     char * const buffer_address;
     /// Offsets of each spark row
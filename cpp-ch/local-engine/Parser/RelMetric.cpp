@@ -1,11 +1,52 @@
 #include <Processors/IProcessor.h>
 #include "RelMetric.h"
+#include <Interpreters/IJoin.h>
 #include <Processors/QueryPlan/AggregatingStep.h>
+#include <Processors/QueryPlan/JoinStep.h>
+#include <Common/CurrentThread.h>
+#include <Common/ProfileEvents.h>
 
 using namespace rapidjson;
 
+namespace ProfileEvents
+{
+    extern const Event UserTimeMicroseconds;
+    extern const Event SystemTimeMicroseconds;
+    extern const Event ExternalSortCompressedBytes;
+    extern const Event ExternalAggregationCompressedBytes;
+    extern const Event ExternalJoinCompressedBytes;
+}
+
 namespace local_engine
 {
+TaskResourceUsage TaskResourceUsage::fromThreadGroup(const DB::ThreadGroupPtr & thread_group)
+{
+    TaskResourceUsage usage;
+    if (!thread_group)
+        return usage;
+
+    /// The rusage counters of the current thread are only flushed on detach otherwise.
+    if (DB::CurrentThread::isInitialized() && DB::CurrentThread::getGroup() == thread_group)
+        DB::CurrentThread::updatePerformanceCounters();
+
+    const auto & counters = thread_group->performance_counters;
+    usage.cpu_time_us = counters[ProfileEvents::UserTimeMicroseconds].load(std::memory_order_relaxed)
+        + counters[ProfileEvents::SystemTimeMicroseconds].load(std::memory_order_relaxed);
+    usage.spill_bytes = counters[ProfileEvents::ExternalSortCompressedBytes].load(std::memory_order_relaxed)
+        + counters[ProfileEvents::ExternalAggregationCompressedBytes].load(std::memory_order_relaxed)
+        + counters[ProfileEvents::ExternalJoinCompressedBytes].load(std::memory_order_relaxed);
+    usage.peak_memory_bytes = std::max<Int64>(thread_group->memory_tracker.getPeak(), 0);
+    return usage;
+}
+
+TaskResourceUsage TaskResourceUsage::since(const TaskResourceUsage & start) const
+{
+    TaskResourceUsage usage = *this;
+    usage.cpu_time_us -= std::min(cpu_time_us, start.cpu_time_us);
+    usage.spill_bytes -= std::min(spill_bytes, start.spill_bytes);
+    return usage;
+}
+
 RelMetric::RelMetric(size_t id_, String name_, std::vector<DB::IQueryPlanStep *>& steps_) : id(id_), name(name_), steps(steps_)
 {
 }
@@ -47,7 +88,23 @@ RelMetricTimes RelMetric::getTotalTime() const
     return timeMetrics;
 }
 
-void RelMetric::serialize(Writer<StringBuffer> & writer, bool summary) const
+size_t RelMetric::getStateBytes() const
+{
+    size_t bytes = 0;
+    for (const auto * step : steps)
+    {
+        const DB::JoinPtr * join = nullptr;
+        if (const auto * join_step = typeid_cast<const DB::JoinStep *>(step))
+            join = &join_step->getJoin();
+        else if (const auto * filled_join_step = typeid_cast<const DB::FilledJoinStep *>(step))
+            join = &filled_join_step->getJoin();
+        if (join && *join)
+            bytes += (*join)->getTotalByteCount();
+    }
+    return bytes;
+}
+
+void RelMetric::serialize(Writer<StringBuffer> & writer, bool summary, const TaskResourceUsage * task_usage) const
 {
     writer.StartObject();
     writer.Key("id");
@@ -61,6 +118,17 @@ void RelMetric::serialize(Writer<StringBuffer> & writer, bool summary) const
     writer.Uint(timeMetrics.input_wait_elapsed_us);
     writer.Key("output_wait_time");
     writer.Uint(timeMetrics.output_wait_elapsed_us);
+    writer.Key("memory_bytes");
+    writer.Uint(getStateBytes());
+    if (task_usage)
+    {
+        writer.Key("cpu_time");
+        writer.Uint(task_usage->cpu_time_us);
+        writer.Key("spill_bytes");
+        writer.Uint(task_usage->spill_bytes);
+        writer.Key("peak_memory");
+        writer.Uint(task_usage->peak_memory_bytes);
+    }
     if (!steps.empty())
     {
         writer.Key("steps");
@@ -103,7 +171,7 @@ const String & RelMetric::getName() const
     return name;
 }
 
-std::string RelMetricSerializer::serializeRelMetric(RelMetricPtr rel_metric, bool flatten)
+std::string RelMetricSerializer::serializeRelMetric(RelMetricPtr rel_metric, bool flatten, const TaskResourceUsage * usage)
 {
     StringBuffer result;
     Writer<StringBuffer> writer(result);
@@ -120,7 +188,7 @@ std::string RelMetricSerializer::serializeRelMetric(RelMetricPtr rel_metric, boo
             {
                 metrics.push(item);
             }
-            metric->serialize(writer);
+            metric->serialize(writer, true, metric == rel_metric ? usage : nullptr);
         }
         writer.EndArray();
     }
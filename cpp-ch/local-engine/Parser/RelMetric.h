@@ -1,5 +1,6 @@
 #pragma once
 #include <Processors/QueryPlan/IQueryPlanStep.h>
+#include <Common/ThreadStatus.h>
 #include <rapidjson/prettywriter.h>
 
 namespace local_engine
@@ -18,6 +19,21 @@ struct RelMetricTimes
     size_t output_wait_elapsed_us;
 };
 
+/// Resources used by a task, read from the ProfileEvents and the memory tracker of its thread group.
+/// The thread group also holds the prefetch threads of the task, so these are only meaningful for the whole task,
+/// not for single operators.
+struct TaskResourceUsage
+{
+    size_t cpu_time_us = 0;
+    size_t peak_memory_bytes = 0;
+    /// Compressed bytes written by external sort, aggregation and join.
+    size_t spill_bytes = 0;
+
+    static TaskResourceUsage fromThreadGroup(const DB::ThreadGroupPtr & thread_group);
+    /// The counters used since start, the peak memory is kept.
+    TaskResourceUsage since(const TaskResourceUsage & start) const;
+};
+
 class RelMetric
 {
 public:
@@ -29,7 +45,11 @@ public:
     const std::vector<DB::IQueryPlanStep *> & getSteps() const;
     const std::vector<RelMetricPtr> & getInputs() const;
     RelMetricTimes getTotalTime() const;
-    void serialize(rapidjson::Writer<rapidjson::StringBuffer> & writer, bool summary = true) const;
+    /// Bytes of the state kept in memory by the steps, e.g. the hash tables of joins.
+    size_t getStateBytes() const;
+    /// task_usage is written along with the metrics of the root rel only.
+    void serialize(
+        rapidjson::Writer<rapidjson::StringBuffer> & writer, bool summary = true, const TaskResourceUsage * task_usage = nullptr) const;
 
 private:
     size_t id;
@@ -42,7 +62,8 @@ private:
 class RelMetricSerializer
 {
 public:
-    static std::string serializeRelMetric(RelMetricPtr rel_metric, bool flatten = true);
+    /// With usage, the cpu time, the spilled bytes and the peak memory of the task are reported on the root rel.
+    static std::string serializeRelMetric(RelMetricPtr rel_metric, bool flatten = true, const TaskResourceUsage * usage = nullptr);
 };
 }
 
@@ -249,6 +249,26 @@ QueryPlanStepPtr SerializedPlanParser::parseReadRealWithLocalFile(const substrai
     assert(rel.has_base_schema());
     auto header = parseNameStruct(rel.base_schema());
     auto source = std::make_shared<SubstraitFileSource>(context, header, rel.local_files());
+    if (rel.has_filter())
+    {
+        /// Skip the row groups which can't match the pushed down filter according to their statistics.
+        /// This is only an optimization, a filter that can't be parsed here scans all the row groups.
+        try
+        {
+            auto filter_actions_dag = std::make_shared<ActionsDAG>(blockToNameAndTypeList(header));
+            const auto * filter_node = parseExpression(filter_actions_dag, rel.filter());
+            filter_actions_dag->addOrReplaceInOutputs(*filter_node);
+            filter_actions_dag->removeUnusedActions(Names{filter_node->result_name});
+            source->setKeyCondition(filter_actions_dag);
+        }
+        catch (DB::Exception & e)
+        {
+            LOG_WARNING(
+                &Poco::Logger::get("SerializedPlanParser"),
+                "Read local files without row group pruning, can't parse the filter: {}",
+                e.displayText());
+        }
+    }
     auto source_pipe = Pipe(source);
     auto source_step = std::make_unique<ReadFromStorageStep>(std::move(source_pipe), "substrait local files", nullptr);
     source_step->setStepDescription("read local files");
@@ -264,7 +284,8 @@ QueryPlanStepPtr SerializedPlanParser::parseReadRealWithJavaIter(const substrait
     auto pos = iter.find(':');
     auto iter_index = std::stoi(iter.substr(pos + 1, iter.size()));
 
-    auto source = std::make_shared<SourceFromJavaIter>(parseNameStruct(rel.base_schema()), input_iters[iter_index]);
+    auto prefetch_blocks = context->getConfigRef().getUInt64("java_iter_prefetch.max_blocks", 0);
+    auto source = std::make_shared<SourceFromJavaIter>(parseNameStruct(rel.base_schema()), input_iters[iter_index], prefetch_blocks);
     QueryPlanStepPtr source_step = std::make_unique<ReadFromPreparedSource>(Pipe(source));
     source_step->setStepDescription("Read From Java Iter");
     return source_step;
@@ -2582,6 +2603,8 @@ LocalExecutor::~LocalExecutor()
 void LocalExecutor::execute(QueryPlanPtr query_plan)
 {
     current_query_plan = std::move(query_plan);
+    thread_group = DB::CurrentThread::getGroup();
+    start_usage = TaskResourceUsage::fromThreadGroup(thread_group);
     Stopwatch stopwatch;
     stopwatch.start();
     QueryPlanOptimizationSettings optimization_settings{.optimize_plan = false};
@@ -2614,7 +2637,7 @@ void LocalExecutor::execute(QueryPlanPtr query_plan)
         t_pipeline / 1000.0,
         t_executor / 1000.0);
     header = current_query_plan->getCurrentDataStream().header.cloneEmpty();
-    ch_column_to_spark_row = std::make_unique<CHColumnToSparkRow>();
+    ch_column_to_spark_row = std::make_unique<CHColumnToSparkRow>(true);
 }
 std::unique_ptr<SparkRowInfo> LocalExecutor::writeBlockToSparkRow(Block & block)
 {
@@ -2656,13 +2679,14 @@ bool LocalExecutor::hasNext()
 SparkRowInfoPtr LocalExecutor::next()
 {
     checkNextValid();
-    SparkRowInfoPtr row_info = writeBlockToSparkRow(currentBlock());
-    consume();
+    /// The previous batch has been consumed, free its buffer first so that this batch can reuse it
     if (spark_buffer)
     {
         ch_column_to_spark_row->freeMem(spark_buffer->address, spark_buffer->size);
         spark_buffer.reset();
     }
+    SparkRowInfoPtr row_info = writeBlockToSparkRow(currentBlock());
+    consume();
     spark_buffer = std::make_unique<SparkBuffer>();
     spark_buffer->address = row_info->getBufferAddress();
     spark_buffer->size = row_info->getTotalBytes();
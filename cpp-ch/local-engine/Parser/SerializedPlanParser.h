@@ -407,6 +407,8 @@ public:
     Block & getHeader();
     const RelMetricPtr getMetric() const { return metric; }
     void setMetric(RelMetricPtr metric_) { metric = metric_; }
+    /// Resources used by the task thread group since execute().
+    TaskResourceUsage getResourceUsage() const { return TaskResourceUsage::fromThreadGroup(thread_group).since(start_usage); }
     void setExtraPlanHolder(std::vector<QueryPlanPtr> & extra_plan_holder_)
     {
         extra_plan_holder = std::move(extra_plan_holder_);
@@ -425,6 +427,8 @@ private:
     DB::QueryPlanPtr current_query_plan;
     RelMetricPtr metric;
     std::vector<QueryPlanPtr> extra_plan_holder;
+    DB::ThreadGroupPtr thread_group;
+    TaskResourceUsage start_usage;
 };
 
 
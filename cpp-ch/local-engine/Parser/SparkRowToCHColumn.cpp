@@ -1,5 +1,8 @@
 #include "SparkRowToCHColumn.h"
 #include <memory>
+#include <Columns/ColumnArray.h>
+#include <Columns/ColumnDecimal.h>
+#include <Columns/ColumnMap.h>
 #include <Columns/ColumnNullable.h>
 #include <Columns/ColumnString.h>
 #include <Columns/ColumnVector.h>
@@ -11,7 +14,9 @@
 #include <DataTypes/DataTypesDecimal.h>
 #include <DataTypes/DataTypesNumber.h>
 #include <Functions/FunctionHelpers.h>
+#include <base/unaligned.h>
 #include <Common/CHUtil.h>
+#include <Common/assert_cast.h>
 #include <Common/Exception.h>
 
 namespace DB
@@ -32,24 +37,119 @@ jmethodID SparkRowToCHColumn::spark_row_interator_hasNext = nullptr;
 jmethodID SparkRowToCHColumn::spark_row_interator_next = nullptr;
 jmethodID SparkRowToCHColumn::spark_row_iterator_nextBatch = nullptr;
 
-ALWAYS_INLINE static void writeRowToColumns(std::vector<MutableColumnPtr> & columns, const SparkRowReader & spark_row_reader)
+template <typename Column>
+static void readFixedLengthColumn(IColumn & column, const std::vector<const char *> & row_starts, int64_t field_offset)
 {
-    auto num_fields = columns.size();
-    const auto & field_types = spark_row_reader.getFieldTypes();
-    for (size_t i = 0; i < num_fields; i++)
+    using ValueType = typename Column::ValueType;
+    auto & data = assert_cast<Column &>(column).getData();
+    const size_t old_size = data.size();
+    data.resize(old_size + row_starts.size());
+    /// Spark zeroes the values of null fields, which is the default value of the column
+    for (size_t i = 0; i < row_starts.size(); ++i)
+        memcpy(&data[old_size + i], row_starts[i] + field_offset, sizeof(ValueType));
+}
+
+static void readStringColumn(IColumn & column, const std::vector<const char *> & row_starts, size_t ordinal, int64_t field_offset)
+{
+    auto & column_string = assert_cast<ColumnString &>(column);
+    auto & chars = column_string.getChars();
+    auto & offsets = column_string.getOffsets();
+
+    size_t total_size = 0;
+    for (const auto * row : row_starts)
+        if (!isBitSet(row, ordinal))
+            total_size += static_cast<uint32_t>(unalignedLoad<int64_t>(row + field_offset)) + 1;
+        else
+            ++total_size;
+    chars.reserve(chars.size() + total_size);
+    offsets.reserve(offsets.size() + row_starts.size());
+
+    for (const auto * row : row_starts)
     {
-        if (spark_row_reader.supportRawData(i))
+        if (!isBitSet(row, ordinal))
         {
-            const StringRef str_ref{std::move(spark_row_reader.getStringRef(i))};
-            if (str_ref.data == nullptr)
-                columns[i]->insertData(nullptr, str_ref.size);
-            else if (!spark_row_reader.isBigEndianInSparkRow(i))
-                columns[i]->insertData(str_ref.data, str_ref.size);
-            else
-                columns[i]->insert(spark_row_reader.getField(i)); // read decimal128
+            const int64_t offset_and_size = unalignedLoad<int64_t>(row + field_offset);
+            const char * data = row + BackingDataLengthCalculator::extractOffset(offset_and_size);
+            chars.insert(data, data + BackingDataLengthCalculator::extractSize(offset_and_size));
+        }
+        chars.push_back(0);
+        offsets.push_back(chars.size());
+    }
+}
+
+/// Insert the field ordinal of the rows into column with typed loops over all rows.
+/// Return false if there is no such loop for the type, then the rows must be read one by one.
+static bool readColumn(
+    IColumn & column, const DataTypePtr & type, const std::vector<const char *> & row_starts, size_t ordinal, int64_t field_offset)
+{
+    IColumn * nested_column = &column;
+    NullMap * null_map = nullptr;
+    if (auto * nullable_column = typeid_cast<ColumnNullable *>(&column))
+    {
+        nested_column = &nullable_column->getNestedColumn();
+        null_map = &nullable_column->getNullMapData();
+    }
+
+    const auto nested_type = removeNullable(type);
+    const WhichDataType which(nested_type);
+    if (which.isUInt8())
+        readFixedLengthColumn<ColumnUInt8>(*nested_column, row_starts, field_offset);
+    else if (which.isInt8())
+        readFixedLengthColumn<ColumnInt8>(*nested_column, row_starts, field_offset);
+    else if (which.isInt16())
+        readFixedLengthColumn<ColumnInt16>(*nested_column, row_starts, field_offset);
+    else if (which.isUInt16() || which.isDate())
+        readFixedLengthColumn<ColumnUInt16>(*nested_column, row_starts, field_offset);
+    else if (which.isInt32() || which.isDate32())
+        readFixedLengthColumn<ColumnInt32>(*nested_column, row_starts, field_offset);
+    else if (which.isInt64())
+        readFixedLengthColumn<ColumnInt64>(*nested_column, row_starts, field_offset);
+    else if (which.isFloat32())
+        readFixedLengthColumn<ColumnFloat32>(*nested_column, row_starts, field_offset);
+    else if (which.isFloat64())
+        readFixedLengthColumn<ColumnFloat64>(*nested_column, row_starts, field_offset);
+    else if (which.isDecimal32())
+        readFixedLengthColumn<ColumnDecimal<Decimal32>>(*nested_column, row_starts, field_offset);
+    else if (which.isDecimal64())
+        readFixedLengthColumn<ColumnDecimal<Decimal64>>(*nested_column, row_starts, field_offset);
+    else if (which.isDateTime64())
+        readFixedLengthColumn<ColumnDecimal<DateTime64>>(*nested_column, row_starts, field_offset);
+    else if (which.isString())
+        readStringColumn(*nested_column, row_starts, ordinal, field_offset);
+    else
+        return false;
+
+    if (null_map)
+    {
+        const size_t old_size = null_map->size();
+        null_map->resize(old_size + row_starts.size());
+        for (size_t i = 0; i < row_starts.size(); ++i)
+            (*null_map)[old_size + i] = isBitSet(row_starts[i], ordinal);
+    }
+    return true;
+}
+
+/// Insert the rows into columns column by column
+static void readRowsToColumns(
+    MutableColumns & columns,
+    const DataTypes & types,
+    const std::vector<const char *> & row_starts,
+    const std::vector<int32_t> & row_lengths,
+    SparkRowReader & row_reader)
+{
+    const int64_t bit_set_width_in_bytes = calculateBitSetWidthInBytes(types.size());
+    for (size_t col_i = 0; col_i < columns.size(); ++col_i)
+    {
+        const int64_t field_offset = bit_set_width_in_bytes + col_i * 8L;
+        if (readColumn(*columns[col_i], types[col_i], row_starts, col_i, field_offset))
+            continue;
+
+        /// Decimal128 and nested types
+        for (size_t i = 0; i < row_starts.size(); ++i)
+        {
+            row_reader.pointTo(row_starts[i], row_lengths[i]);
+            row_reader.insertInto(col_i, *columns[col_i]);
         }
-        else
-            columns[i]->insert(spark_row_reader.getField(i));
     }
 }
 
@@ -65,12 +165,15 @@ std::unique_ptr<Block> SparkRowToCHColumn::convertSparkRowInfoToCHColumn(const S
             mutable_columns[col_i]->reserve(num_rows);
 
         DataTypes types{std::move(header.getDataTypes())};
-        SparkRowReader row_reader(types);
+        std::vector<const char *> row_starts(num_rows);
+        std::vector<int32_t> row_lengths(num_rows);
         for (int64_t i = 0; i < num_rows; i++)
         {
-            row_reader.pointTo(spark_row_info.getBufferAddress() + spark_row_info.getOffsets()[i], spark_row_info.getLengths()[i]);
-            writeRowToColumns(mutable_columns, row_reader);
+            row_starts[i] = spark_row_info.getBufferAddress() + spark_row_info.getOffsets()[i];
+            row_lengths[i] = static_cast<int32_t>(spark_row_info.getLengths()[i]);
         }
+        SparkRowReader row_reader(types);
+        readRowsToColumns(mutable_columns, types, row_starts, row_lengths, row_reader);
         block->setColumns(std::move(mutable_columns));
     }
     else
@@ -81,12 +184,59 @@ std::unique_ptr<Block> SparkRowToCHColumn::convertSparkRowInfoToCHColumn(const S
     return std::move(block);
 }
 
-void SparkRowToCHColumn::appendSparkRowToCHColumn(SparkRowToCHColumnHelper & helper, char * buffer, int32_t length)
+Block * SparkRowToCHColumn::convertSparkRowItrToCHColumn(jobject java_iter, vector<string> & names, vector<string> & types)
+{
+    const auto & config = SerializedPlanParser::global_context->getConfigRef();
+    return convertSparkRowItrToCHColumn(
+        java_iter,
+        names,
+        types,
+        config.getUInt64("row_to_columnar.max_block_rows", 8192),
+        config.getUInt64("row_to_columnar.max_block_bytes", 64UL << 20));
+}
+
+Block * SparkRowToCHColumn::convertSparkRowItrToCHColumn(
+    jobject java_iter, vector<string> & names, vector<string> & types, size_t max_block_rows, size_t max_block_bytes)
 {
+    SparkRowToCHColumnHelper helper(names, types);
+    helper.resetMutableColumns(max_block_rows);
+
+    GET_JNIENV(env)
+    while ((!max_block_rows || helper.rows < max_block_rows) && (!max_block_bytes || helper.bytes < max_block_bytes)
+           && safeCallBooleanMethod(env, java_iter, spark_row_interator_hasNext))
+    {
+        jobject rows_buf = safeCallObjectMethod(env, java_iter, spark_row_iterator_nextBatch);
+        appendSparkRowBatchToCHColumn(helper, static_cast<const char *>(env->GetDirectBufferAddress(rows_buf)));
+
+        // Try to release reference.
+        env->DeleteLocalRef(rows_buf);
+    }
+    return getBlock(helper);
+}
+
+void SparkRowToCHColumn::appendSparkRowBatchToCHColumn(SparkRowToCHColumnHelper & helper, const char * rows_buf)
+{
+    /// Locate the rows first, then decode them column by column
+    helper.row_starts.clear();
+    helper.row_lengths.clear();
+    int32_t len = unalignedLoad<int32_t>(rows_buf);
+
+    // len = -1 means reaching the buf's end.
+    // len = 0 indicates no columns in the this row. e.g. count(1)/count(*)
+    while (len >= 0)
+    {
+        rows_buf += 4;
+        helper.row_starts.push_back(rows_buf);
+        helper.row_lengths.push_back(len);
+        helper.bytes += len;
+
+        rows_buf += len;
+        len = unalignedLoad<int32_t>(rows_buf);
+    }
+
     SparkRowReader row_reader(helper.data_types);
-    row_reader.pointTo(buffer, length);
-    writeRowToColumns(helper.mutable_columns, row_reader);
-    ++helper.rows;
+    readRowsToColumns(helper.mutable_columns, helper.data_types, helper.row_starts, helper.row_lengths, row_reader);
+    helper.rows += helper.row_starts.size();
 }
 
 Block * SparkRowToCHColumn::getBlock(SparkRowToCHColumnHelper & helper)
@@ -110,11 +260,168 @@ Block * SparkRowToCHColumn::getBlock(SparkRowToCHColumnHelper & helper)
     return block;
 }
 
+/// Decode the big-endian two's complement bytes of a Spark decimal
+static Decimal128 readDecimal128(const char * buffer, size_t length)
+{
+    assert(sizeof(Decimal128) >= length);
+
+    char decimal128_fix_data[sizeof(Decimal128)];
+    /// Sign extend the value to 16 bytes
+    memset(decimal128_fix_data, length && (buffer[0] & 0x80) ? 0xff : 0, sizeof(Decimal128) - length);
+    memcpy(decimal128_fix_data + sizeof(Decimal128) - length, buffer, length);
+    String buf(decimal128_fix_data, sizeof(Decimal128));
+    BackingDataLengthCalculator::swapDecimalEndianBytes(buf); // Big-endian to Little-endian
+
+    Decimal128 decimal128;
+    memcpy(&decimal128, buf.data(), sizeof(Decimal128));
+    return decimal128;
+}
+
 VariableLengthDataReader::VariableLengthDataReader(const DataTypePtr & type_)
     : type(type_), type_without_nullable(removeNullable(type)), which(type_without_nullable)
 {
     if (!BackingDataLengthCalculator::isVariableLengthDataType(type_without_nullable))
         throw Exception(ErrorCodes::UNKNOWN_TYPE, "VariableLengthDataReader doesn't support type {}", type->getName());
+
+    if (const auto * array_type = typeid_cast<const DataTypeArray *>(type_without_nullable.get()))
+        child_types = {array_type->getNestedType()};
+    else if (const auto * map_type = typeid_cast<const DataTypeMap *>(type_without_nullable.get()))
+        child_types = {map_type->getKeyType(), map_type->getValueType()};
+    else if (const auto * tuple_type = typeid_cast<const DataTypeTuple *>(type_without_nullable.get()))
+        child_types = tuple_type->getElements();
+
+    fixed_child_readers.resize(child_types.size());
+    variable_child_readers.resize(child_types.size());
+    for (size_t i = 0; i < child_types.size(); ++i)
+    {
+        const auto child_type_without_nullable = removeNullable(child_types[i]);
+        if (BackingDataLengthCalculator::isFixedLengthDataType(child_type_without_nullable))
+            fixed_child_readers[i] = std::make_shared<FixedLengthDataReader>(child_types[i]);
+        else if (BackingDataLengthCalculator::isVariableLengthDataType(child_type_without_nullable))
+            variable_child_readers[i] = std::make_shared<VariableLengthDataReader>(child_types[i]);
+        else
+            throw Exception(ErrorCodes::UNKNOWN_TYPE, "VariableLengthDataReader doesn't support type {}", child_types[i]->getName());
+    }
+}
+
+void VariableLengthDataReader::readInto(IColumn & column, const char * buffer, size_t length) const
+{
+    if (auto * nullable_column = typeid_cast<ColumnNullable *>(&column))
+    {
+        readInto(nullable_column->getNestedColumn(), buffer, length);
+        nullable_column->getNullMapData().push_back(0);
+        return;
+    }
+
+    if (which.isStringOrFixedString())
+        column.insertData(buffer, length);
+    else if (which.isDecimal128())
+    {
+        const auto decimal128 = readDecimal128(buffer, length);
+        column.insertData(reinterpret_cast<const char *>(&decimal128), sizeof(decimal128));
+    }
+    else if (which.isArray())
+    {
+        auto & array_column = assert_cast<ColumnArray &>(column);
+        readArrayElementsInto(array_column.getData(), 0, buffer, length);
+        array_column.getOffsets().push_back(array_column.getData().size());
+    }
+    else if (which.isMap())
+    {
+        /// 内存布局：Length of UnsafeArrayData of key(8B) |  UnsafeArrayData of key | UnsafeArrayData of value
+        auto & array_column = assert_cast<ColumnMap &>(column).getNestedColumn();
+        auto & tuple_column = assert_cast<ColumnTuple &>(array_column.getData());
+        int64_t key_array_size = 0;
+        memcpy(&key_array_size, buffer, 8);
+        if (key_array_size != 0 && length != 0)
+        {
+            const auto num_keys = readArrayElementsInto(tuple_column.getColumn(0), 0, buffer + 8, key_array_size);
+            const auto num_values
+                = readArrayElementsInto(tuple_column.getColumn(1), 1, buffer + 8 + key_array_size, length - 8 - key_array_size);
+            if (num_keys != num_values)
+                throw Exception(ErrorCodes::LOGICAL_ERROR, "Key size {} not equal to value size {} in map", num_keys, num_values);
+        }
+        array_column.getOffsets().push_back(tuple_column.size());
+    }
+    else if (which.isTuple())
+        readStructInto(assert_cast<ColumnTuple &>(column), buffer);
+    else
+        throw Exception(ErrorCodes::UNKNOWN_TYPE, "VariableLengthDataReader doesn't support type {}", type->getName());
+}
+
+size_t VariableLengthDataReader::readArrayElementsInto(IColumn & elems, size_t child, const char * buffer, size_t length) const
+{
+    /// 内存布局：numElements(8B) | null_bitmap(与numElements成正比) | values(每个值长度与类型有关) | backing data
+    int64_t num_elems = 0;
+    memcpy(&num_elems, buffer, 8);
+    if (num_elems == 0 || length == 0)
+        return 0;
+
+    const char * null_bitmap = buffer + 8;
+    const char * values = null_bitmap + calculateBitSetWidthInBytes(num_elems);
+    if (const auto & reader = fixed_child_readers[child])
+    {
+        const auto elem_size = BackingDataLengthCalculator::getArrayElementSize(child_types[child]);
+        for (int64_t i = 0; i < num_elems; ++i)
+        {
+            if (isBitSet(null_bitmap, i))
+                elems.insertDefault();
+            else
+            {
+                const auto value = reader->unsafeRead(values + i * elem_size);
+                elems.insertData(value.data, value.size);
+            }
+        }
+    }
+    else
+    {
+        const auto & variable_reader = variable_child_readers[child];
+        for (int64_t i = 0; i < num_elems; ++i)
+        {
+            if (isBitSet(null_bitmap, i))
+                elems.insertDefault();
+            else
+            {
+                int64_t offset_and_size = 0;
+                memcpy(&offset_and_size, values + i * 8, 8);
+                const int64_t offset = BackingDataLengthCalculator::extractOffset(offset_and_size);
+                const int64_t size = BackingDataLengthCalculator::extractSize(offset_and_size);
+                variable_reader->readInto(elems, buffer + offset, size);
+            }
+        }
+    }
+    return num_elems;
+}
+
+void VariableLengthDataReader::readStructInto(ColumnTuple & column, const char * buffer) const
+{
+    /// 内存布局：null_bitmap(字节数与字段数成正比) | values(num_fields * 8B) | backing data
+    const auto num_fields = child_types.size();
+    const auto len_null_bitmap = calculateBitSetWidthInBytes(num_fields);
+    for (size_t i = 0; i < num_fields; ++i)
+    {
+        auto & field_column = column.getColumn(i);
+        if (isBitSet(buffer, i))
+        {
+            field_column.insertDefault();
+            continue;
+        }
+
+        const char * field_value = buffer + len_null_bitmap + i * 8;
+        if (const auto & reader = fixed_child_readers[i])
+        {
+            const auto value = reader->unsafeRead(field_value);
+            field_column.insertData(value.data, value.size);
+        }
+        else
+        {
+            int64_t offset_and_size = 0;
+            memcpy(&offset_and_size, field_value, 8);
+            const int64_t offset = BackingDataLengthCalculator::extractOffset(offset_and_size);
+            const int64_t size = BackingDataLengthCalculator::extractSize(offset_and_size);
+            variable_child_readers[i]->readInto(field_column, buffer + offset, size);
+        }
+    }
 }
 
 Field VariableLengthDataReader::read(const char * buffer, size_t length) const
@@ -144,16 +451,8 @@ StringRef VariableLengthDataReader::readUnalignedBytes(const char * buffer, size
 
 Field VariableLengthDataReader::readDecimal(const char * buffer, size_t length) const
 {
-    assert(sizeof(Decimal128) >= length);
-
-    char decimal128_fix_data[sizeof(Decimal128)] = {};
-    memcpy(decimal128_fix_data + sizeof(Decimal128) - length, buffer, length); // padding
-    String buf(decimal128_fix_data, sizeof(Decimal128));
-    BackingDataLengthCalculator::swapDecimalEndianBytes(buf); // Big-endian to Little-endian
-
-    auto * decimal128 = reinterpret_cast<Decimal128 *>(buf.data());
     const auto * decimal128_type = typeid_cast<const DataTypeDecimal128 *>(type_without_nullable.get());
-    return std::move(DecimalField<Decimal128>(std::move(*decimal128), decimal128_type->getScale()));
+    return std::move(DecimalField<Decimal128>(readDecimal128(buffer, length), decimal128_type->getScale()));
 }
 
 Field VariableLengthDataReader::readString(const char * buffer, size_t length) const
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <jni.h>
+#include <Columns/ColumnTuple.h>
 #include <Core/Block.h>
 #include <DataTypes/DataTypeFactory.h>
 #include <DataTypes/DataTypeNullable.h>
@@ -26,12 +27,20 @@ namespace local_engine
 {
 using namespace DB;
 using namespace std;
+class FixedLengthDataReader;
+
 struct SparkRowToCHColumnHelper
 {
     DataTypes data_types;
     Block header;
     MutableColumns mutable_columns;
     UInt64 rows;
+    /// Total length of the rows in mutable_columns
+    UInt64 bytes;
+
+    /// Starts and lengths of the rows of the batch being decoded
+    std::vector<const char *> row_starts;
+    std::vector<int32_t> row_lengths;
 
     SparkRowToCHColumnHelper(vector<string> & names, vector<string> & types) : data_types(names.size())
     {
@@ -48,12 +57,20 @@ struct SparkRowToCHColumnHelper
         resetMutableColumns();
     }
 
+    explicit SparkRowToCHColumnHelper(const Block & header_) : data_types(header_.getDataTypes()), header(header_.cloneEmpty())
+    {
+        resetMutableColumns();
+    }
+
     ~SparkRowToCHColumnHelper() = default;
 
-    void resetMutableColumns()
+    void resetMutableColumns(size_t reserve_rows = 0)
     {
         rows = 0;
-        mutable_columns = std::move(header.mutateColumns());
+        bytes = 0;
+        mutable_columns = std::move(header.cloneEmpty().mutateColumns());
+        for (auto & column : mutable_columns)
+            column->reserve(reserve_rows);
     }
 
     static DataTypePtr parseType(const string & type)
@@ -77,44 +94,22 @@ public:
     // case 1: rows are batched (this is often directly converted from Block)
     static std::unique_ptr<Block> convertSparkRowInfoToCHColumn(const SparkRowInfo & spark_row_info, const Block & header);
 
-    // case 2: provided with a sequence of spark UnsafeRow, convert them to a Block
-    static Block * convertSparkRowItrToCHColumn(jobject java_iter, vector<string> & names, vector<string> & types)
-    {
-        SparkRowToCHColumnHelper helper(names, types);
+    // case 2: provided with a sequence of spark UnsafeRow, convert them to a Block.
+    // Stops once the block holds row_to_columnar.max_block_rows rows or row_to_columnar.max_block_bytes bytes of rows
+    // (0 means unlimited), so that it should be called until java_iter has no next row.
+    static Block * convertSparkRowItrToCHColumn(jobject java_iter, vector<string> & names, vector<string> & types);
+    static Block * convertSparkRowItrToCHColumn(jobject java_iter, vector<string> & names, vector<string> & types, size_t max_block_rows, size_t max_block_bytes);
 
-        GET_JNIENV(env)
-        while (safeCallBooleanMethod(env, java_iter, spark_row_interator_hasNext))
-        {
-            jobject rows_buf = safeCallObjectMethod(env, java_iter, spark_row_iterator_nextBatch);
-            auto * rows_buf_ptr = static_cast<char *>(env->GetDirectBufferAddress(rows_buf));
-            int len = *(reinterpret_cast<int *>(rows_buf_ptr));
-
-            // len = -1 means reaching the buf's end.
-            // len = 0 indicates no columns in the this row. e.g. count(1)/count(*)
-            while (len >= 0)
-            {
-                rows_buf_ptr += 4;
-                appendSparkRowToCHColumn(helper, rows_buf_ptr, len);
-
-                rows_buf_ptr += len;
-                len = *(reinterpret_cast<int *>(rows_buf_ptr));
-            }
-
-            // Try to release reference.
-            env->DeleteLocalRef(rows_buf);
-        }
-        return getBlock(helper);
-    }
+    /// Decode a buffer returned by SparkRowIterator.nextBatch, i.e. rows prefixed by their 4-byte lengths and ended by -1,
+    /// into the columns of helper.
+    static void appendSparkRowBatchToCHColumn(SparkRowToCHColumnHelper & helper, const char * rows_buf);
+    static Block * getBlock(SparkRowToCHColumnHelper & helper);
 
     static void freeBlock(Block * block)
     {
         delete block;
         block = nullptr;
     }
-
-private:
-    static void appendSparkRowToCHColumn(SparkRowToCHColumnHelper & helper, char * buffer, int32_t length);
-    static Block * getBlock(SparkRowToCHColumnHelper & helper);
 };
 
 class VariableLengthDataReader
@@ -126,6 +121,10 @@ public:
     virtual Field read(const char * buffer, size_t length) const;
     virtual StringRef readUnalignedBytes(const char * buffer, size_t length) const;
 
+    /// Insert the value into column, which has the type of the reader.
+    /// Nested values are inserted into the nested columns directly, without materializing Fields.
+    void readInto(IColumn & column, const char * buffer, size_t length) const;
+
 private:
     virtual Field readDecimal(const char * buffer, size_t length) const;
     virtual Field readString(const char * buffer, size_t length) const;
@@ -133,9 +132,20 @@ private:
     virtual Field readMap(const char * buffer, size_t length) const;
     virtual Field readStruct(const char * buffer, size_t length) const;
 
+    /// Insert the elements of the UnsafeArrayData in buffer into elems, which has type child_types[child].
+    /// Return the number of elements.
+    size_t readArrayElementsInto(IColumn & elems, size_t child, const char * buffer, size_t length) const;
+    void readStructInto(ColumnTuple & column, const char * buffer) const;
+
     const DataTypePtr type;
     const DataTypePtr type_without_nullable;
     const WhichDataType which;
+
+    /// Types of the elements of an array, of the keys and values of a map or of the fields of a tuple,
+    /// with a reader for each of them.
+    DataTypes child_types;
+    std::vector<std::shared_ptr<FixedLengthDataReader>> fixed_child_readers;
+    std::vector<std::shared_ptr<VariableLengthDataReader>> variable_child_readers;
 };
 
 class FixedLengthDataReader
@@ -327,6 +337,36 @@ public:
                 ErrorCodes::UNKNOWN_TYPE, "SparkRowReader::getStringRef doesn't support type {}", field_types[ordinal]->getName());
     }
 
+    /// Insert the field into column, which has the type of the field, without materializing a Field.
+    void insertInto(int ordinal, IColumn & column) const
+    {
+        assertIndexIsValid(ordinal);
+
+        if (isNullAt(ordinal))
+        {
+            column.insertDefault();
+            return;
+        }
+
+        const auto & fixed_length_data_reader = fixed_length_data_readers[ordinal];
+        const auto & variable_length_data_reader = variable_length_data_readers[ordinal];
+        if (fixed_length_data_reader)
+        {
+            const auto value = fixed_length_data_reader->unsafeRead(getFieldOffset(ordinal));
+            column.insertData(value.data, value.size);
+        }
+        else if (variable_length_data_reader)
+        {
+            int64_t offset_and_size = 0;
+            memcpy(&offset_and_size, buffer + bit_set_width_in_bytes + ordinal * 8, 8);
+            const int64_t offset = BackingDataLengthCalculator::extractOffset(offset_and_size);
+            const int64_t size = BackingDataLengthCalculator::extractSize(offset_and_size);
+            variable_length_data_reader->readInto(column, buffer + offset, size);
+        }
+        else
+            throw Exception(ErrorCodes::UNKNOWN_TYPE, "SparkRowReader::insertInto doesn't support type {}", field_types[ordinal]->getName());
+    }
+
     Field getField(int ordinal) const
     {
         assertIndexIsValid(ordinal);
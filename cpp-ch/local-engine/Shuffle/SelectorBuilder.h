@@ -41,6 +41,10 @@ public:
     explicit HashSelectorBuilder(UInt32 parts_num_, const std::vector<size_t> & exprs_index_, const std::string & hash_function_name_);
     PartitionInfo build(DB::Block & block);
 
+    /// partition_ids[i] = hash_column.get64(i) % parts_num, computed over the raw data of the hash column
+    /// when it is a plain integer column.
+    static void computePartitionIds(const DB::IColumn & hash_column, UInt32 parts_num, DB::IColumn::Selector & partition_ids);
+
 private:
     UInt32 parts_num;
     std::vector<size_t> exprs_index;
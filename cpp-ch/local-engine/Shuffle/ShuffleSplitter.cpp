@@ -10,6 +10,7 @@
 #include <IO/BrotliWriteBuffer.h>
 #include <IO/ReadBufferFromFile.h>
 #include <IO/WriteHelpers.h>
+#include <IO/copyData.h>
 #include <Parser/SerializedPlanParser.h>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <Poco/StringTokenizer.h>
@@ -26,7 +27,10 @@ void ShuffleSplitter::split(DB::Block & block)
     Stopwatch watch;
     watch.start();
     computeAndCountPartitionId(block);
-    splitBlockByPartition(block);
+    if (sort_based)
+        appendToSortBuffer(block);
+    else
+        splitBlockByPartition(block);
     split_result.total_write_time += watch.elapsedNanoseconds();
 }
 SplitResult ShuffleSplitter::stop()
@@ -34,21 +38,29 @@ SplitResult ShuffleSplitter::stop()
     // spill all buffers
     Stopwatch watch;
     watch.start();
-    for (size_t i = 0; i < options.partition_nums; i++)
+    if (sort_based)
+    {
+        spillSortBuffer();
+        mergeSpills();
+    }
+    else
     {
-        spillPartition(i);
-        partition_outputs[i]->flush();
-        partition_write_buffers[i].reset();
+        for (size_t i = 0; i < options.partition_nums; i++)
+        {
+            spillPartition(i);
+            partition_outputs[i]->flush();
+            partition_write_buffers[i].reset();
+        }
+        partition_outputs.clear();
+        partition_cached_write_buffers.clear();
+        partition_write_buffers.clear();
+        mergePartitionFiles();
     }
-    partition_outputs.clear();
-    partition_cached_write_buffers.clear();
-    partition_write_buffers.clear();
-    mergePartitionFiles();
     split_result.total_write_time += watch.elapsedNanoseconds();
     stopped = true;
     return split_result;
 }
-void ShuffleSplitter::splitBlockByPartition(DB::Block & block)
+DB::Block ShuffleSplitter::buildOutputBlock(DB::Block & block)
 {
     if (!output_header.columns()) [[unlikely]]
     {
@@ -75,6 +87,12 @@ void ShuffleSplitter::splitBlockByPartition(DB::Block & block)
     {
         out_block.insert(block.getByPosition(output_columns_indicies[col]));
     }
+    return out_block;
+}
+
+void ShuffleSplitter::splitBlockByPartition(DB::Block & block)
+{
+    DB::Block out_block = buildOutputBlock(block);
     for (size_t col = 0; col < output_header.columns(); ++col)
     {
         for (size_t j = 0; j < partition_info.partition_num; ++j)
@@ -98,17 +116,19 @@ void ShuffleSplitter::splitBlockByPartition(DB::Block & block)
 }
 void ShuffleSplitter::init()
 {
+    sort_based = options.partition_nums >= options.sort_based_partition_threshold;
+    split_result.partition_length.resize(options.partition_nums, 0);
+    split_result.raw_partition_length.resize(options.partition_nums, 0);
+    if (sort_based)
+        return;
+
     partition_buffer.reserve(options.partition_nums);
     partition_outputs.reserve(options.partition_nums);
     partition_write_buffers.reserve(options.partition_nums);
     partition_cached_write_buffers.reserve(options.partition_nums);
-    split_result.partition_length.reserve(options.partition_nums);
-    split_result.raw_partition_length.reserve(options.partition_nums);
     for (size_t i = 0; i < options.partition_nums; ++i)
     {
         partition_buffer.emplace_back(ColumnsBuffer());
-        split_result.partition_length.emplace_back(0);
-        split_result.raw_partition_length.emplace_back(0);
         partition_outputs.emplace_back(nullptr);
         partition_write_buffers.emplace_back(nullptr);
         partition_cached_write_buffers.emplace_back(nullptr);
@@ -157,6 +177,113 @@ void ShuffleSplitter::mergePartitionFiles()
     data_write_buffer.close();
 }
 
+void ShuffleSplitter::appendToSortBuffer(DB::Block & block)
+{
+    DB::Block out_block = buildOutputBlock(block);
+    /// Rows of a block are appended grouped by partition.
+    for (size_t col = 0; col < out_block.columns(); ++col)
+        sort_buffer.appendSelective(col, out_block, partition_info.partition_selector, 0, out_block.rows());
+    for (size_t j = 0; j < partition_info.partition_num; ++j)
+    {
+        size_t length = partition_info.partition_start_points[j + 1] - partition_info.partition_start_points[j];
+        if (length)
+            sort_buffer_partition_ids.resize_fill(sort_buffer_partition_ids.size() + length, static_cast<UInt32>(j));
+    }
+
+    if (sort_buffer_partition_ids.size() >= options.sort_buffer_rows || sort_buffer.bytes() >= options.sort_buffer_bytes)
+        spillSortBuffer();
+}
+
+void ShuffleSplitter::spillSortBuffer()
+{
+    size_t rows = sort_buffer_partition_ids.size();
+    if (!rows)
+        return;
+    Stopwatch watch;
+    watch.start();
+    DB::Block block = sort_buffer.releaseColumns();
+
+    /// Counting sort by partition id, which keeps the order of rows inside a partition.
+    std::vector<size_t> partition_row_offsets(options.partition_nums + 1, 0);
+    for (auto partition_id : sort_buffer_partition_ids)
+        ++partition_row_offsets[partition_id + 1];
+    for (size_t i = 1; i <= options.partition_nums; ++i)
+        partition_row_offsets[i] += partition_row_offsets[i - 1];
+    DB::IColumn::Permutation permutation(rows);
+    std::vector<size_t> positions(partition_row_offsets.begin(), partition_row_offsets.end() - 1);
+    for (size_t i = 0; i < rows; ++i)
+        permutation[positions[sort_buffer_partition_ids[i]]++] = i;
+    sort_buffer_partition_ids.clear();
+    for (size_t col = 0; col < block.columns(); ++col)
+    {
+        auto & column = block.getByPosition(col);
+        column.column = column.column->permute(permutation, 0);
+    }
+
+    SpillInfo spill_info{
+        .file = getTempFile(
+            std::to_string(options.shuffle_id) + "_" + std::to_string(options.map_id) + "_spill_" + std::to_string(spill_infos.size())),
+        .partition_offsets = std::vector<UInt64>(options.partition_nums + 1, 0)};
+    auto codec = getCompressionCodec();
+    DB::WriteBufferFromFile file_buffer(spill_info.file, options.io_buffer_size, O_CREAT | O_WRONLY | O_TRUNC);
+    for (size_t partition_id = 0; partition_id < options.partition_nums; ++partition_id)
+    {
+        spill_info.partition_offsets[partition_id] = file_buffer.count();
+        size_t from = partition_row_offsets[partition_id];
+        size_t to = partition_row_offsets[partition_id + 1];
+        if (from == to)
+            continue;
+        /// Every partition is compressed on its own, so that it can be copied into the data file alone.
+        std::unique_ptr<DB::WriteBuffer> compressed_buffer;
+        if (codec)
+            compressed_buffer = std::make_unique<DB::CompressedWriteBuffer>(file_buffer, codec, options.io_buffer_size);
+        DB::WriteBuffer & output = compressed_buffer ? *compressed_buffer : file_buffer;
+        DB::NativeWriter writer(output, 0, output_header);
+        for (size_t start = from; start < to; start += options.split_size)
+            writer.write(block.cloneWithCutColumns(start, std::min(options.split_size, to - start)));
+        if (compressed_buffer)
+            compressed_buffer->finalize();
+    }
+    spill_info.partition_offsets[options.partition_nums] = file_buffer.count();
+    file_buffer.finalize();
+    spill_infos.emplace_back(std::move(spill_info));
+
+    split_result.total_spill_time += watch.elapsedNanoseconds();
+    split_result.total_bytes_spilled += block.bytes();
+}
+
+void ShuffleSplitter::mergeSpills()
+{
+    DB::WriteBufferFromFile data_write_buffer = DB::WriteBufferFromFile(options.data_file, options.io_buffer_size);
+    std::vector<std::unique_ptr<DB::ReadBufferFromFile>> spill_readers;
+    spill_readers.reserve(spill_infos.size());
+    for (const auto & spill_info : spill_infos)
+        spill_readers.emplace_back(std::make_unique<DB::ReadBufferFromFile>(spill_info.file, options.io_buffer_size));
+
+    /// Partitions are in order in every spill file, so all the spill files are read sequentially.
+    for (size_t partition_id = 0; partition_id < options.partition_nums; ++partition_id)
+    {
+        for (size_t i = 0; i < spill_infos.size(); ++i)
+        {
+            const auto & offsets = spill_infos[i].partition_offsets;
+            auto length = offsets[partition_id + 1] - offsets[partition_id];
+            if (!length)
+                continue;
+            DB::copyData(*spill_readers[i], data_write_buffer, length);
+            split_result.partition_length[partition_id] += length;
+            split_result.total_bytes_written += length;
+        }
+    }
+    data_write_buffer.close();
+
+    for (size_t i = 0; i < spill_infos.size(); ++i)
+    {
+        spill_readers[i]->close();
+        std::filesystem::remove(spill_infos[i].file);
+    }
+    spill_infos.clear();
+}
+
 ShuffleSplitter::ShuffleSplitter(SplitOptions && options_) : options(options_)
 {
     init();
@@ -189,7 +316,11 @@ ShuffleSplitter::Ptr ShuffleSplitter::create(const std::string & short_name, Spl
 
 std::string ShuffleSplitter::getPartitionTempFile(size_t partition_id)
 {
-    auto file_name = std::to_string(options.shuffle_id) + "_" + std::to_string(options.map_id) + "_" + std::to_string(partition_id);
+    return getTempFile(std::to_string(options.shuffle_id) + "_" + std::to_string(options.map_id) + "_" + std::to_string(partition_id));
+}
+
+std::string ShuffleSplitter::getTempFile(const std::string & file_name)
+{
     std::hash<std::string> hasher;
     auto hash = hasher(file_name);
     auto dir_id = hash % options.local_dirs_list.size();
@@ -207,10 +338,8 @@ std::unique_ptr<DB::WriteBuffer> ShuffleSplitter::getPartitionWriteBuffer(size_t
     if (partition_cached_write_buffers[partition_id] == nullptr)
         partition_cached_write_buffers[partition_id]
             = std::make_unique<DB::WriteBufferFromFile>(file, options.io_buffer_size, O_CREAT | O_WRONLY | O_APPEND);
-    if (!options.compress_method.empty()
-        && std::find(compress_methods.begin(), compress_methods.end(), options.compress_method) != compress_methods.end())
+    if (auto codec = getCompressionCodec())
     {
-        auto codec = DB::CompressionCodecFactory::instance().get(boost::to_upper_copy(options.compress_method), {});
         return std::make_unique<DB::CompressedWriteBuffer>(*partition_cached_write_buffers[partition_id], codec);
     }
     else
@@ -219,6 +348,14 @@ std::unique_ptr<DB::WriteBuffer> ShuffleSplitter::getPartitionWriteBuffer(size_t
     }
 }
 
+DB::CompressionCodecPtr ShuffleSplitter::getCompressionCodec()
+{
+    if (!options.compress_method.empty()
+        && std::find(compress_methods.begin(), compress_methods.end(), options.compress_method) != compress_methods.end())
+        return DB::CompressionCodecFactory::instance().get(boost::to_upper_copy(options.compress_method), {});
+    return nullptr;
+}
+
 const std::vector<std::string> ShuffleSplitter::compress_methods = {"", "ZSTD", "LZ4"};
 
 void ShuffleSplitter::writeIndexFile()
@@ -293,6 +430,14 @@ size_t ColumnsBuffer::size() const
     return accumulated_columns.at(0)->size();
 }
 
+size_t ColumnsBuffer::bytes() const
+{
+    size_t res = 0;
+    for (const auto & column : accumulated_columns)
+        res += column->allocatedBytes();
+    return res;
+}
+
 DB::Block ColumnsBuffer::releaseColumns()
 {
     DB::Columns res(std::make_move_iterator(accumulated_columns.begin()), std::make_move_iterator(accumulated_columns.end()));
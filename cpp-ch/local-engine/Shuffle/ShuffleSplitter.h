@@ -1,5 +1,6 @@
 #pragma once
 #include <Columns/IColumn.h>
+#include <Compression/ICompressionCodec.h>
 #include <Core/Block.h>
 #include <Formats/NativeWriter.h>
 #include <Functions/IFunction.h>
@@ -26,6 +27,14 @@ struct SplitOptions
     // std::vector<std::string> exprs;
     std::string compress_method = "zstd";
     int compress_level;
+    /// With at least this many partitions, rows of all partitions are buffered together and every spill
+    /// goes to a single file, instead of keeping a temp file and a writer open per partition.
+    size_t sort_based_partition_threshold = 1000;
+    /// Rows buffered before a spill in the sort-based mode.
+    size_t sort_buffer_rows = 1024 * 1024;
+    /// Bytes buffered before a spill in the sort-based mode. The spill permutes the buffered columns into
+    /// partition order, which copies them, so the buffer must stay well below the task memory limit.
+    size_t sort_buffer_bytes = 256 * 1024 * 1024;
 };
 
 class ColumnsBuffer
@@ -35,6 +44,7 @@ public:
     void add(DB::Block & columns, int start, int end);
     void appendSelective(size_t column_idx, const DB::Block & source, const DB::IColumn::Selector & selector, size_t from, size_t length);
     size_t size() const;
+    size_t bytes() const;
     DB::Block releaseColumns();
     DB::Block getHeader();
 
@@ -74,12 +84,27 @@ public:
     SplitResult stop();
 
 private:
+    /// Data of all partitions written by one spill in the sort-based mode. The data of partition i is
+    /// in [partition_offsets[i], partition_offsets[i + 1]) of the file.
+    struct SpillInfo
+    {
+        std::string file;
+        std::vector<UInt64> partition_offsets;
+    };
+
     void init();
+    DB::Block buildOutputBlock(DB::Block & block);
     void splitBlockByPartition(DB::Block & block);
     void spillPartition(size_t partition_id);
+    std::string getTempFile(const std::string & file_name);
     std::string getPartitionTempFile(size_t partition_id);
     void mergePartitionFiles();
     std::unique_ptr<DB::WriteBuffer> getPartitionWriteBuffer(size_t partition_id);
+    DB::CompressionCodecPtr getCompressionCodec();
+
+    void appendToSortBuffer(DB::Block & block);
+    void spillSortBuffer();
+    void mergeSpills();
 
 protected:
     bool stopped = false;
@@ -92,6 +117,12 @@ protected:
     DB::Block output_header;
     SplitOptions options;
     SplitResult split_result;
+
+    bool sort_based = false;
+    ColumnsBuffer sort_buffer;
+    /// Partition id of every row in sort_buffer.
+    DB::PaddedPODArray<UInt32> sort_buffer_partition_ids;
+    std::vector<SpillInfo> spill_infos;
 };
 
 class RoundRobinSplitter : public ShuffleSplitter
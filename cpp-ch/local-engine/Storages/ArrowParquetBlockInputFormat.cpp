@@ -14,9 +14,14 @@ using namespace DB;
 namespace local_engine
 {
 ArrowParquetBlockInputFormat::ArrowParquetBlockInputFormat(
-    DB::ReadBuffer & in_, const DB::Block & header, const DB::FormatSettings & formatSettings, const std::vector<int> & row_group_indices_)
+    DB::ReadBuffer & in_,
+    const DB::Block & header,
+    const DB::FormatSettings & formatSettings,
+    const std::vector<int> & row_group_indices_,
+    std::shared_ptr<parquet::FileMetaData> metadata_)
     : OptimizedParquetBlockInputFormat(in_, header, formatSettings), row_group_indices(row_group_indices_)
 {
+    metadata = std::move(metadata_);
 }
 
 static size_t countIndicesForType(std::shared_ptr<arrow::DataType> type)
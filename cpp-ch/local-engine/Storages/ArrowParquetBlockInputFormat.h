@@ -25,7 +25,8 @@ public:
         DB::ReadBuffer & in,
         const DB::Block & header,
         const DB::FormatSettings & formatSettings,
-        const std::vector<int> & row_group_indices_ = {});
+        const std::vector<int> & row_group_indices_ = {},
+        std::shared_ptr<parquet::FileMetaData> metadata_ = nullptr);
 
 private:
     DB::Chunk generate() override;
@@ -0,0 +1,129 @@
+#include "PartitionedHashJoin.h"
+
+#include <DataTypes/DataTypeLowCardinality.h>
+#include <Interpreters/HashJoin.h>
+#include <Interpreters/TableJoin.h>
+#include <Common/Exception.h>
+#include <Common/HashTable/Hash.h>
+#include <Common/WeakHash.h>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+    extern const int LOGICAL_ERROR;
+    extern const int NOT_IMPLEMENTED;
+}
+}
+
+using namespace DB;
+
+namespace local_engine
+{
+
+PartitionedHashJoin::PartitionedHashJoin(std::shared_ptr<DB::TableJoin> table_join_, std::vector<DB::HashJoinPtr> partitions_)
+    : table_join(std::move(table_join_)), partitions(std::move(partitions_))
+{
+    if (partitions.empty())
+        throw Exception(ErrorCodes::LOGICAL_ERROR, "PartitionedHashJoin needs at least one partition");
+}
+
+DB::Blocks PartitionedHashJoin::scatterBlock(const DB::Names & key_names, const DB::Block & block, size_t num_partitions)
+{
+    size_t num_rows = block.rows();
+    WeakHash32 hash(num_rows);
+    for (const auto & key_name : key_names)
+    {
+        /// Left and right keys may differ in nullability and LowCardinality, which must not change the hash.
+        auto key_column = recursiveRemoveLowCardinality(block.getByName(key_name).column->convertToFullColumnIfConst());
+        key_column->updateWeakHash32(hash);
+    }
+
+    /// HashJoin maps place keys by their CRC32 too, rehash so that a partition doesn't get only a fraction of the buckets.
+    IColumn::Selector selector(num_rows);
+    const auto & hash_data = hash.getData();
+    for (size_t i = 0; i < num_rows; ++i)
+        selector[i] = intHash64(hash_data[i]) % num_partitions;
+
+    Blocks result(num_partitions);
+    for (auto & partition_block : result)
+        partition_block = block.cloneEmpty();
+    for (size_t column_index = 0; column_index < block.columns(); ++column_index)
+    {
+        auto scattered = block.getByPosition(column_index).column->scatter(num_partitions, selector);
+        for (size_t i = 0; i < num_partitions; ++i)
+            result[i].getByPosition(column_index).column = std::move(scattered[i]);
+    }
+    return result;
+}
+
+bool PartitionedHashJoin::addJoinedBlock(const DB::Block & /*block*/, bool /*check_limits*/)
+{
+    throw Exception(ErrorCodes::LOGICAL_ERROR, "PartitionedHashJoin is filled when it is built");
+}
+
+void PartitionedHashJoin::checkTypesOfKeys(const DB::Block & block) const
+{
+    partitions.front()->checkTypesOfKeys(block);
+}
+
+void PartitionedHashJoin::initialize(const DB::Block & sample_block)
+{
+    for (auto & partition : partitions)
+        partition->initialize(sample_block);
+}
+
+void PartitionedHashJoin::joinBlock(DB::Block & block, std::shared_ptr<DB::ExtraBlock> & /*not_processed*/)
+{
+    auto partition_blocks = scatterBlock(table_join->getOnlyClause().key_names_left, block, partitions.size());
+    Blocks results;
+    results.reserve(partitions.size());
+    for (size_t i = 0; i < partitions.size(); ++i)
+    {
+        /// Finish every partition here, the blocks left over by a partition can't be handed back to the caller.
+        std::shared_ptr<ExtraBlock> rest;
+        partitions[i]->joinBlock(partition_blocks[i], rest);
+        results.emplace_back(std::move(partition_blocks[i]));
+        while (rest && !rest->empty())
+        {
+            Block rest_block = std::move(rest->block);
+            rest.reset();
+            partitions[i]->joinBlock(rest_block, rest);
+            results.emplace_back(std::move(rest_block));
+        }
+    }
+    block = concatenateBlocks(results);
+}
+
+size_t PartitionedHashJoin::getTotalRowCount() const
+{
+    size_t rows = 0;
+    for (const auto & partition : partitions)
+        rows += partition->getTotalRowCount();
+    return rows;
+}
+
+size_t PartitionedHashJoin::getTotalByteCount() const
+{
+    size_t bytes = 0;
+    for (const auto & partition : partitions)
+        bytes += partition->getTotalByteCount();
+    return bytes;
+}
+
+bool PartitionedHashJoin::alwaysReturnsEmptySet() const
+{
+    for (const auto & partition : partitions)
+        if (!partition->alwaysReturnsEmptySet())
+            return false;
+    return true;
+}
+
+DB::IBlocksStreamPtr PartitionedHashJoin::getNonJoinedBlocks(
+    const DB::Block & /*left_sample_block*/, const DB::Block & /*result_sample_block*/, UInt64 /*max_block_size*/) const
+{
+    if (isRightOrFull(table_join->kind()))
+        throw Exception(ErrorCodes::NOT_IMPLEMENTED, "PartitionedHashJoin doesn't support {} JOIN", toString(table_join->kind()));
+    return {};
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <Interpreters/IJoin.h>
+
+namespace DB
+{
+class HashJoin;
+using HashJoinPtr = std::shared_ptr<HashJoin>;
+}
+
+namespace local_engine
+{
+
+/// A hash join whose right side is split by key hash into partitions that are built independently, so that the
+/// partitions can be filled by different threads. Left blocks are scattered by the same hash, each part is joined with
+/// its partition, and the results are concatenated.
+/// The partitions are filled before the join is created, it only probes them.
+class PartitionedHashJoin : public DB::IJoin
+{
+public:
+    PartitionedHashJoin(std::shared_ptr<DB::TableJoin> table_join_, std::vector<DB::HashJoinPtr> partitions_);
+
+    /// Split the rows of block by the hash of the key columns, rows with equal keys always go to the same partition.
+    static DB::Blocks scatterBlock(const DB::Names & key_names, const DB::Block & block, size_t num_partitions);
+
+    std::string getName() const override { return "PartitionedHashJoin"; }
+    const DB::TableJoin & getTableJoin() const override { return *table_join; }
+    bool addJoinedBlock(const DB::Block & block, bool check_limits) override;
+    void checkTypesOfKeys(const DB::Block & block) const override;
+    void initialize(const DB::Block & sample_block) override;
+    void joinBlock(DB::Block & block, std::shared_ptr<DB::ExtraBlock> & not_processed) override;
+    size_t getTotalRowCount() const override;
+    size_t getTotalByteCount() const override;
+    bool alwaysReturnsEmptySet() const override;
+    bool supportTotals() const override { return false; }
+    bool isFilled() const override { return true; }
+    DB::IBlocksStreamPtr
+    getNonJoinedBlocks(const DB::Block & left_sample_block, const DB::Block & result_sample_block, UInt64 max_block_size) const override;
+
+private:
+    std::shared_ptr<DB::TableJoin> table_join;
+    std::vector<DB::HashJoinPtr> partitions;
+};
+}
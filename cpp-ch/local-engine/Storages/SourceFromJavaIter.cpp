@@ -5,15 +5,19 @@
 #include <Processors/Transforms/AggregatingTransform.h>
 #include <jni/jni_common.h>
 #include <Common/CHUtil.h>
+#include <Common/CurrentThread.h>
 #include <Common/DebugUtils.h>
 #include <Common/Exception.h>
 #include <Common/JNIUtils.h>
+#include <Common/setThreadName.h>
 
 namespace local_engine
 {
 jclass SourceFromJavaIter::serialized_record_batch_iterator_class = nullptr;
 jmethodID SourceFromJavaIter::serialized_record_batch_iterator_hasNext = nullptr;
 jmethodID SourceFromJavaIter::serialized_record_batch_iterator_next = nullptr;
+jmethodID SourceFromJavaIter::serialized_record_batch_iterator_attachTaskContext = nullptr;
+jmethodID SourceFromJavaIter::serialized_record_batch_iterator_detachTaskContext = nullptr;
 
 
 static DB::Block getRealHeader(const DB::Block & header)
@@ -22,46 +26,178 @@ static DB::Block getRealHeader(const DB::Block & header)
         return header;
     return BlockUtil::buildRowCountHeader();
 }
-SourceFromJavaIter::SourceFromJavaIter(DB::Block header, jobject java_iter_)
-    : DB::ISource(getRealHeader(header)), java_iter(java_iter_), original_header(header)
+SourceFromJavaIter::SourceFromJavaIter(DB::Block header, jobject java_iter_, size_t prefetch_blocks_)
+    : DB::ISource(getRealHeader(header))
+    , java_iter(java_iter_)
+    , original_header(header)
+    , read_block([this](DB::Block & block) { return readFromJavaIter(block); })
+    , prefetch_blocks(prefetch_blocks_)
 {
 }
-DB::Chunk SourceFromJavaIter::generate()
+
+SourceFromJavaIter::SourceFromJavaIter(DB::Block header, BlockReader read_block_, size_t prefetch_blocks_)
+    : DB::ISource(getRealHeader(header)), original_header(header), read_block(std::move(read_block_)), prefetch_blocks(prefetch_blocks_)
+{
+}
+
+bool SourceFromJavaIter::readFromJavaIter(DB::Block & block)
 {
     GET_JNIENV(env)
-    jboolean has_next = safeCallBooleanMethod(env, java_iter, serialized_record_batch_iterator_hasNext);
-    DB::Chunk result;
-    if (has_next)
+    bool has_next = false;
+    while ((has_next = safeCallBooleanMethod(env, java_iter, serialized_record_batch_iterator_hasNext)))
     {
-        jbyteArray block = static_cast<jbyteArray>(safeCallObjectMethod(env, java_iter, serialized_record_batch_iterator_next));
-        DB::Block * data = reinterpret_cast<DB::Block *>(byteArrayToLong(env, block));
+        jbyteArray java_block = static_cast<jbyteArray>(safeCallObjectMethod(env, java_iter, serialized_record_batch_iterator_next));
+        DB::Block * data = reinterpret_cast<DB::Block *>(byteArrayToLong(env, java_block));
+        /// The prefetch thread stays attached, local references are not released until it detaches
+        env->DeleteLocalRef(java_block);
         if (data->rows() > 0)
         {
-            size_t rows = data->rows();
-            if (original_header.columns())
+            /// Take the columns now, the java side may free the block once the iterator moves on
+            block = std::move(*data);
+            break;
+        }
+    }
+    CLEAN_JNIENV
+    return has_next;
+}
+
+DB::Chunk SourceFromJavaIter::toChunk(DB::Block & block)
+{
+    DB::Chunk result;
+    size_t rows = block.rows();
+    if (original_header.columns())
+    {
+        result.setColumns(block.mutateColumns(), rows);
+        convertNullable(result);
+        auto info = std::make_shared<DB::AggregatedChunkInfo>();
+        info->is_overflows = block.info.is_overflows;
+        info->bucket_num = block.info.bucket_num;
+        result.setChunkInfo(info);
+    }
+    else
+    {
+        result = BlockUtil::buildRowCountChunk(rows);
+    }
+    return result;
+}
+
+DB::Chunk SourceFromJavaIter::generate()
+{
+    DB::Block block;
+    if (!prefetch_blocks)
+        return read_block(block) ? toChunk(block) : DB::Chunk{};
+
+    if (!prefetch_started)
+        startPrefetch();
+
+    std::unique_lock lock(prefetch_mutex);
+    prefetch_cv.wait(lock, [this] { return prefetch_cancelled || prefetch_finished || !prefetched_blocks.empty(); });
+    if (!prefetched_blocks.empty())
+    {
+        block = std::move(prefetched_blocks.front());
+        prefetched_blocks.pop_front();
+        lock.unlock();
+        prefetch_cv.notify_all();
+        return toChunk(block);
+    }
+    if (prefetch_exception)
+        std::rethrow_exception(std::exchange(prefetch_exception, nullptr));
+    return {};
+}
+
+void SourceFromJavaIter::startPrefetch()
+{
+    prefetch_started = true;
+    auto thread_group = DB::CurrentThread::getGroup();
+    prefetch_thread = ThreadFromGlobalPool(
+        [this, thread_group]()
+        {
+            if (thread_group)
+                DB::CurrentThread::attachToGroupIfDetached(thread_group);
+            DB::setThreadName("JavaIterFetch");
+            /// Stay attached to the JVM for the whole prefetch rather than attaching for every block
+            int attached;
+            JNIEnv * env = JNIUtils::getENV(&attached);
+            try
             {
-                result.setColumns(data->mutateColumns(), rows);
-                convertNullable(result);
-                auto info = std::make_shared<DB::AggregatedChunkInfo>();
-                info->is_overflows = data->info.is_overflows;
-                info->bucket_num = data->info.bucket_num;
-                result.setChunkInfo(info);
+                if (java_iter)
+                    safeCallVoidMethod(env, java_iter, serialized_record_batch_iterator_attachTaskContext);
+                while (true)
+                {
+                    {
+                        std::unique_lock lock(prefetch_mutex);
+                        prefetch_cv.wait(lock, [this] { return prefetch_cancelled || prefetched_blocks.size() < prefetch_blocks; });
+                        if (prefetch_cancelled)
+                            break;
+                    }
+
+                    DB::Block block;
+                    if (!read_block(block))
+                        break;
+                    {
+                        std::lock_guard lock(prefetch_mutex);
+                        prefetched_blocks.emplace_back(std::move(block));
+                    }
+                    prefetch_cv.notify_all();
+                }
             }
-            else
+            catch (...)
             {
-                result = BlockUtil::buildRowCountChunk(rows);
+                std::lock_guard lock(prefetch_mutex);
+                prefetch_exception = std::current_exception();
             }
-        }
+            {
+                std::lock_guard lock(prefetch_mutex);
+                prefetch_finished = true;
+            }
+            prefetch_cv.notify_all();
+            if (java_iter)
+            {
+                try
+                {
+                    safeCallVoidMethod(env, java_iter, serialized_record_batch_iterator_detachTaskContext);
+                }
+                catch (...)
+                {
+                    tryLogCurrentException(__PRETTY_FUNCTION__);
+                }
+            }
+            if (attached)
+                JNIUtils::detachCurrentThread();
+            if (thread_group)
+                DB::CurrentThread::detachFromGroupIfNotDetached();
+        });
+}
+
+void SourceFromJavaIter::cancelPrefetch()
+{
+    {
+        std::lock_guard lock(prefetch_mutex);
+        prefetch_cancelled = true;
     }
-    CLEAN_JNIENV
-    return result;
+    prefetch_cv.notify_all();
 }
+
+void SourceFromJavaIter::onCancel()
+{
+    cancelPrefetch();
+}
+
 SourceFromJavaIter::~SourceFromJavaIter()
 {
-    GET_JNIENV(env)
-    env->DeleteGlobalRef(java_iter);
-    CLEAN_JNIENV
+    /// The prefetch thread stops before the next block, but a call into the java iterator is waited for
+    cancelPrefetch();
+    if (prefetch_thread.joinable())
+        prefetch_thread.join();
+
+    if (java_iter)
+    {
+        GET_JNIENV(env)
+        env->DeleteGlobalRef(java_iter);
+        CLEAN_JNIENV
+    }
 }
+
 Int64 SourceFromJavaIter::byteArrayToLong(JNIEnv * env, jbyteArray arr)
 {
     jsize len = env->GetArrayLength(arr);
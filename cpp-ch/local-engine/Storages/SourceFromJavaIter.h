@@ -1,6 +1,11 @@
 #pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <jni.h>
 #include <Processors/ISource.h>
+#include <Common/ThreadPool.h>
 
 namespace local_engine
 {
@@ -10,20 +15,48 @@ public:
     static jclass serialized_record_batch_iterator_class;
     static jmethodID serialized_record_batch_iterator_hasNext;
     static jmethodID serialized_record_batch_iterator_next;
+    static jmethodID serialized_record_batch_iterator_attachTaskContext;
+    static jmethodID serialized_record_batch_iterator_detachTaskContext;
 
     static Int64 byteArrayToLong(JNIEnv * env, jbyteArray arr);
 
-    SourceFromJavaIter(DB::Block header, jobject java_iter_);
+    /// Take the next non-empty block, return false once there is none left.
+    using BlockReader = std::function<bool(DB::Block &)>;
+
+    /// With prefetch_blocks_ > 0, a thread attached to the JVM reads up to prefetch_blocks_ blocks from java_iter_ ahead
+    /// of generate(), so that the pipeline doesn't wait for the java side to produce every block. The thread runs with the
+    /// TaskContext of the task which created java_iter_, the iterators of the upstream operators may depend on it.
+    SourceFromJavaIter(DB::Block header, jobject java_iter_, size_t prefetch_blocks_ = 0);
+    /// Read the blocks with read_block_ instead of a java iterator
+    SourceFromJavaIter(DB::Block header, BlockReader read_block_, size_t prefetch_blocks_ = 0);
     ~SourceFromJavaIter() override;
 
     String getName() const override { return "SourceFromJavaIter"; }
 
 private:
     DB::Chunk generate() override;
+    void onCancel() override;
     void convertNullable(DB::Chunk & chunk);
+    DB::Chunk toChunk(DB::Block & block);
+
+    bool readFromJavaIter(DB::Block & block);
+    void startPrefetch();
+    void cancelPrefetch();
 
-    jobject java_iter;
+    jobject java_iter = nullptr;
     DB::Block original_header;
+    BlockReader read_block;
+
+    const size_t prefetch_blocks;
+    ThreadFromGlobalPool prefetch_thread;
+    std::mutex prefetch_mutex;
+    /// Notified when a block is pushed or popped, when the prefetch finishes and when it is cancelled
+    std::condition_variable prefetch_cv;
+    std::deque<DB::Block> prefetched_blocks;
+    std::exception_ptr prefetch_exception;
+    bool prefetch_started = false;
+    bool prefetch_finished = false;
+    bool prefetch_cancelled = false;
 };
 
 }
@@ -4,8 +4,10 @@
 #include <Interpreters/Context.h>
 #include <Interpreters/HashJoin.h>
 #include <Interpreters/TableJoin.h>
-#include <QueryPipeline/ProfileInfo.h>
+#include <Storages/PartitionedHashJoin.h>
 #include <Common/Exception.h>
+#include <Common/ThreadPool.h>
+#include <Common/setThreadName.h>
 
 namespace DB
 {
@@ -31,19 +33,55 @@ void StorageJoinFromReadBuffer::restore()
     {
         throw std::runtime_error("input reader buffer is not available");
     }
-    ContextPtr ctx = nullptr;
     NativeReader block_stream(*in, 0);
 
-    ProfileInfo info;
+    if (joins.size() == 1)
     {
         while (Block block = block_stream.read())
-        {
-            auto final_block = sample_block.cloneWithColumns(block.mutateColumns());
-            info.update(final_block);
-            join->addJoinedBlock(final_block, true);
-        }
+            joins.front()->addJoinedBlock(sample_block.cloneWithColumns(block.mutateColumns()), true);
+        in.reset();
+        return;
+    }
+
+    /// Reading the stream is sequential, so only scatter the blocks while reading and build the partitions in parallel.
+    std::vector<Blocks> partition_blocks(joins.size());
+    while (Block block = block_stream.read())
+    {
+        auto scattered = PartitionedHashJoin::scatterBlock(key_names, sample_block.cloneWithColumns(block.mutateColumns()), joins.size());
+        for (size_t i = 0; i < joins.size(); ++i)
+            if (scattered[i].rows())
+                partition_blocks[i].emplace_back(std::move(scattered[i]));
     }
     in.reset();
+
+    std::vector<std::exception_ptr> exceptions(joins.size());
+    std::vector<ThreadFromGlobalPool> build_threads;
+    build_threads.reserve(joins.size());
+    for (size_t i = 0; i < joins.size(); ++i)
+    {
+        build_threads.emplace_back(
+            [this, i, &partition_blocks, &exceptions]()
+            {
+                setThreadName("BroadcastBuild");
+                try
+                {
+                    for (auto & block : partition_blocks[i])
+                    {
+                        joins[i]->addJoinedBlock(block, true);
+                        block.clear();
+                    }
+                }
+                catch (...)
+                {
+                    exceptions[i] = std::current_exception();
+                }
+            });
+    }
+    for (auto & thread : build_threads)
+        thread.join();
+    for (const auto & exception : exceptions)
+        if (exception)
+            std::rethrow_exception(exception);
 }
 
 StorageJoinFromReadBuffer::StorageJoinFromReadBuffer(
@@ -56,7 +94,8 @@ StorageJoinFromReadBuffer::StorageJoinFromReadBuffer(
     const ColumnsDescription & columns_,
     const ConstraintsDescription & constraints_,
     const String & comment,
-    const bool overwrite_)
+    const bool overwrite_,
+    size_t build_threads_)
     : key_names(key_names_)
     , use_nulls(use_nulls_)
     , limits(limits_)
@@ -75,11 +114,12 @@ StorageJoinFromReadBuffer::StorageJoinFromReadBuffer(
             throw Exception(ErrorCodes::NO_SUCH_COLUMN_IN_TABLE, "Key column ({}) does not exist in table declaration.", key);
 
     table_join = std::make_shared<TableJoin>(limits, use_nulls, kind, strictness, key_names);
-    join = std::make_shared<HashJoin>(table_join, getRightSampleBlock(), overwrite);
+    for (size_t i = 0; i < std::max<size_t>(build_threads_, 1); ++i)
+        joins.emplace_back(std::make_shared<HashJoin>(table_join, getRightSampleBlock(), overwrite));
     restore();
 }
 
-DB::HashJoinPtr StorageJoinFromReadBuffer::getJoinLocked(std::shared_ptr<DB::TableJoin> analyzed_join, DB::ContextPtr /*context*/) const
+DB::JoinPtr StorageJoinFromReadBuffer::getJoinLocked(std::shared_ptr<DB::TableJoin> analyzed_join, DB::ContextPtr /*context*/) const
 {
     if (!analyzed_join->sameStrictnessAndKind(strictness, kind))
         throw Exception(ErrorCodes::INCOMPATIBLE_TYPE_OF_JOIN, "Table {} has incompatible type of JOIN.", storage_metadata_.comment);
@@ -98,9 +138,17 @@ DB::HashJoinPtr StorageJoinFromReadBuffer::getJoinLocked(std::shared_ptr<DB::Tab
     /// Qualifies will be added by join implementation (HashJoin)
     analyzed_join->setRightKeys(key_names);
 
-    HashJoinPtr join_clone = std::make_shared<HashJoin>(analyzed_join, getRightSampleBlock());
-    join_clone->reuseJoinedData(*join);
+    std::vector<HashJoinPtr> join_clones;
+    join_clones.reserve(joins.size());
+    for (const auto & join : joins)
+    {
+        HashJoinPtr join_clone = std::make_shared<HashJoin>(analyzed_join, getRightSampleBlock());
+        join_clone->reuseJoinedData(*join);
+        join_clones.emplace_back(std::move(join_clone));
+    }
 
-    return join_clone;
+    if (join_clones.size() == 1)
+        return join_clones.front();
+    return std::make_shared<PartitionedHashJoin>(analyzed_join, std::move(join_clones));
 }
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <Interpreters/IJoin.h>
 #include <Interpreters/JoinUtils.h>
 #include <Storages/StorageInMemoryMetadata.h>
 
@@ -12,6 +13,9 @@ using HashJoinPtr = std::shared_ptr<HashJoin>;
 namespace local_engine
 {
 
+/// The right side of a broadcast join, restored from native blocks into hash tables that are shared by all the tasks
+/// joining with it. With more than one build thread, the rows are split by key hash into that many partitions that
+/// are built in parallel, and the joins created from it are PartitionedHashJoins.
 class StorageJoinFromReadBuffer
 {
 public:
@@ -25,9 +29,10 @@ public:
         const DB::ColumnsDescription & columns_,
         const DB::ConstraintsDescription & constraints_,
         const String & comment,
-        bool overwrite_);
+        bool overwrite_,
+        size_t build_threads_ = 1);
 
-    DB::HashJoinPtr getJoinLocked(std::shared_ptr<DB::TableJoin> analyzed_join, DB::ContextPtr context) const;
+    DB::JoinPtr getJoinLocked(std::shared_ptr<DB::TableJoin> analyzed_join, DB::ContextPtr context) const;
     DB::Block getRightSampleBlock() const
     {
         DB::Block block = storage_metadata_.getSampleBlock();
@@ -55,7 +60,8 @@ private:
     bool overwrite;
 
     std::shared_ptr<DB::TableJoin> table_join;
-    DB::HashJoinPtr join;
+    /// One hash join per partition of the keys.
+    std::vector<DB::HashJoinPtr> joins;
 
     std::unique_ptr<DB::ReadBuffer> in;
 };
@@ -8,6 +8,7 @@
 #include <IO/ReadBuffer.h>
 #include <Interpreters/Context.h>
 #include <Processors/Formats/IInputFormat.h>
+#include <Storages/MergeTree/KeyCondition.h>
 #include <Storages/SubstraitSource/ReadBufferBuilder.h>
 #include <substrait/plan.pb.h>
 
@@ -48,12 +49,22 @@ public:
     virtual size_t getStartOffset() const { return file_info.start(); }
     virtual size_t getLength() const { return file_info.length(); }
 
+    /// Set the filter used to skip the parts of file which can't match it according to the statistics.
+    /// key_columns_ are the columns referred by the hyperrectangles passed to key_condition_.
+    void setKeyCondition(std::shared_ptr<const DB::KeyCondition> key_condition_, const DB::NamesAndTypesList & key_columns_)
+    {
+        key_condition = key_condition_;
+        key_columns = key_columns_;
+    }
+
 protected:
     DB::ContextPtr context;
     substrait::ReadRel::LocalFiles::FileOrFiles file_info;
     ReadBufferBuilderPtr read_buffer_builder;
     std::vector<String> partition_keys;
     std::map<String, String> partition_values;
+    std::shared_ptr<const DB::KeyCondition> key_condition;
+    DB::NamesAndTypesList key_columns;
 };
 using FormatFilePtr = std::shared_ptr<FormatFile>;
 using FormatFiles = std::vector<FormatFilePtr>;
@@ -2,16 +2,24 @@
 // clang-format off
 #if USE_PARQUET
 
+#include <cmath>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include <parquet/arrow/reader.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
+#include <parquet/statistics.h>
 #include <Common/Config.h>
+#include <Common/logger_useful.h>
+#include <DataTypes/DataTypeNullable.h>
 #include <Formats/FormatFactory.h>
 #include <Formats/FormatSettings.h>
 #include <IO/SeekableReadBuffer.h>
 #include <Storages/ArrowParquetBlockInputFormat.h>
+#include <Storages/ch_parquet/DirectParquetBlockInputFormat.h>
+#include <Storages/SubstraitSource/ParquetMetaDataCache.h>
 #include <Processors/Formats/Impl/ArrowBufferedStreams.h>
 #include <Processors/Formats/Impl/ParquetBlockInputFormat.h>
 #include <Processors/Formats/Impl/ArrowColumnToCHColumn.h>
@@ -27,6 +35,129 @@ namespace ErrorCodes
 
 namespace local_engine
 {
+namespace
+{
+template <typename Statistics>
+const Statistics & typedStatistics(const parquet::Statistics & statistics)
+{
+    return static_cast<const Statistics &>(statistics);
+}
+
+/// Convert the min/max statistics of a column chunk into fields comparable with the values of type.
+/// Return false if the statistics can't be used for the type.
+bool getMinMaxFields(
+    const parquet::Statistics & statistics, const parquet::ColumnDescriptor & column, const DB::DataTypePtr & type, DB::Field & min, DB::Field & max)
+{
+    DB::WhichDataType which(DB::removeNullable(type));
+    const auto & logical_type = column.logical_type();
+    switch (statistics.physical_type())
+    {
+        case parquet::Type::BOOLEAN: {
+            if (!which.isUInt8())
+                return false;
+            const auto & typed = typedStatistics<parquet::BoolStatistics>(statistics);
+            min = static_cast<UInt64>(typed.min());
+            max = static_cast<UInt64>(typed.max());
+            return true;
+        }
+        case parquet::Type::INT32: {
+            /// Unsigned integers are stored as signed ones, and decimals need to be rescaled.
+            bool is_signed_int = !logical_type || logical_type->is_none()
+                || (logical_type->is_int() && static_cast<const parquet::IntLogicalType &>(*logical_type).is_signed());
+            if (!(which.isInt() && is_signed_int) && !(which.isDate32() && logical_type && logical_type->is_date()))
+                return false;
+            const auto & typed = typedStatistics<parquet::Int32Statistics>(statistics);
+            min = static_cast<Int64>(typed.min());
+            max = static_cast<Int64>(typed.max());
+            return true;
+        }
+        case parquet::Type::INT64: {
+            bool is_signed_int = !logical_type || logical_type->is_none()
+                || (logical_type->is_int() && static_cast<const parquet::IntLogicalType &>(*logical_type).is_signed());
+            if (!which.isInt() || !is_signed_int)
+                return false;
+            const auto & typed = typedStatistics<parquet::Int64Statistics>(statistics);
+            min = static_cast<Int64>(typed.min());
+            max = static_cast<Int64>(typed.max());
+            return true;
+        }
+        case parquet::Type::FLOAT: {
+            const auto & typed = typedStatistics<parquet::FloatStatistics>(statistics);
+            if (!which.isFloat32() || std::isnan(typed.min()) || std::isnan(typed.max()))
+                return false;
+            min = static_cast<Float64>(typed.min());
+            max = static_cast<Float64>(typed.max());
+            return true;
+        }
+        case parquet::Type::DOUBLE: {
+            const auto & typed = typedStatistics<parquet::DoubleStatistics>(statistics);
+            if (!which.isFloat64() || std::isnan(typed.min()) || std::isnan(typed.max()))
+                return false;
+            min = static_cast<Float64>(typed.min());
+            max = static_cast<Float64>(typed.max());
+            return true;
+        }
+        case parquet::Type::BYTE_ARRAY: {
+            if (!which.isString())
+                return false;
+            const auto & typed = typedStatistics<parquet::ByteArrayStatistics>(statistics);
+            min = String(reinterpret_cast<const char *>(typed.min().ptr), typed.min().len);
+            max = String(reinterpret_cast<const char *>(typed.max().ptr), typed.max().len);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/// Get the range of values in a column chunk. NULLs are considered as the greatest values, which is the
+/// convention of the min-max indexes checked by KeyCondition.
+DB::Range getColumnChunkRange(
+    const parquet::ColumnChunkMetaData & column_chunk, const parquet::ColumnDescriptor & column, const DB::DataTypePtr & type, Int64 num_rows)
+{
+    auto statistics = column_chunk.statistics();
+    if (!column_chunk.is_stats_set() || !statistics)
+        return DB::Range::createWholeUniverse();
+
+    bool all_null = statistics->HasNullCount() && statistics->null_count() == num_rows;
+    if (all_null)
+        return DB::Range(DB::POSITIVE_INFINITY);
+
+    DB::Field min;
+    DB::Field max;
+    if (!statistics->HasMinMax() || !getMinMaxFields(*statistics, column, type, min, max))
+        return DB::Range::createWholeUniverse();
+
+    bool may_have_null = !statistics->HasNullCount() || statistics->null_count() > 0;
+    if (may_have_null)
+        return DB::Range(min, true, DB::POSITIVE_INFINITY, true);
+    return DB::Range(min, true, max, true);
+}
+
+bool mayMatch(
+    const DB::KeyCondition & key_condition,
+    const DB::NamesAndTypesList & key_columns,
+    const parquet::RowGroupMetaData & row_group_meta,
+    const parquet::SchemaDescriptor & schema)
+{
+    DB::Hyperrectangle hyperrectangle;
+    DB::DataTypes types;
+    hyperrectangle.reserve(key_columns.size());
+    types.reserve(key_columns.size());
+    for (const auto & key_column : key_columns)
+    {
+        auto column_index = schema.ColumnIndex(key_column.name);
+        if (column_index < 0)
+            hyperrectangle.emplace_back(DB::Range::createWholeUniverse());
+        else
+            hyperrectangle.emplace_back(getColumnChunkRange(
+                *row_group_meta.ColumnChunk(column_index), *schema.Column(column_index), key_column.type, row_group_meta.num_rows()));
+        types.emplace_back(key_column.type);
+    }
+    return key_condition.checkInHyperrectangle(hyperrectangle, types).can_be_true;
+}
+}
+
 ParquetFormatFile::ParquetFormatFile(
     DB::ContextPtr context_, const substrait::ReadRel::LocalFiles::FileOrFiles & file_info_, ReadBufferBuilderPtr read_buffer_builder_)
     : FormatFile(context_, file_info_, read_buffer_builder_)
@@ -38,17 +169,19 @@ FormatFile::InputFormatPtr ParquetFormatFile::createInputFormat(const DB::Block
     auto res = std::make_shared<FormatFile::InputFormat>();
     res->read_buffer = std::move(read_buffer_builder->build(file_info));
 
-    std::vector<RowGroupInfomation> required_row_groups;
-    [[maybe_unused]] int total_row_groups = 0;
+    std::shared_ptr<parquet::FileMetaData> metadata;
     if (auto * seekable_in = dynamic_cast<DB::SeekableReadBuffer *>(res->read_buffer.get()))
     {
         // reuse the read_buffer to avoid opening the file twice.
         // especially，the cost of opening a hdfs file is large.
-        required_row_groups = collectRequiredRowGroups(seekable_in, total_row_groups);
+        metadata = readMetaData(seekable_in);
         seekable_in->seek(0, SEEK_SET);
     }
     else
-        required_row_groups = collectRequiredRowGroups(total_row_groups);
+        metadata = readMetaData();
+
+    [[maybe_unused]] int total_row_groups = 0;
+    auto required_row_groups = collectRequiredRowGroups(*metadata, total_row_groups);
 
     auto format_settings = DB::getFormatSettings(context);
 // clang-format off
@@ -61,8 +194,15 @@ FormatFile::InputFormatPtr ParquetFormatFile::createInputFormat(const DB::Block
     for (const auto & row_group : required_row_groups)
         row_group_indices.emplace_back(row_group.index);
 
-    auto input_format
-        = std::make_shared<local_engine::ArrowParquetBlockInputFormat>(*(res->read_buffer), header, format_settings, row_group_indices);
+    /// Flat columns are decoded straight into ClickHouse columns, others go through arrow tables.
+    DB::InputFormatPtr input_format;
+    if (context->getConfigRef().getBool("parquet.direct_read", true)
+        && DB::DirectParquetBlockInputFormat::isSupported(header, *metadata->schema(), format_settings))
+        input_format = std::make_shared<DB::DirectParquetBlockInputFormat>(
+            *(res->read_buffer), header, format_settings, std::move(row_group_indices), metadata);
+    else
+        input_format = std::make_shared<local_engine::ArrowParquetBlockInputFormat>(
+            *(res->read_buffer), header, format_settings, row_group_indices, metadata);
 // clang-format off
 #else
     // clang-format on
@@ -99,7 +239,7 @@ std::optional<size_t> ParquetFormatFile::getTotalRows()
     }
 
     int _;
-    auto rowgroups = collectRequiredRowGroups(_);
+    auto rowgroups = collectRequiredRowGroups(*readMetaData(), _);
     size_t rows = 0;
     for (const auto & rowgroup : rowgroups)
         rows += rowgroup.num_rows;
@@ -111,32 +251,48 @@ std::optional<size_t> ParquetFormatFile::getTotalRows()
     }
 }
 
-std::vector<RowGroupInfomation> ParquetFormatFile::collectRequiredRowGroups(int & total_row_groups)
+std::shared_ptr<parquet::FileMetaData> ParquetFormatFile::readMetaData(DB::ReadBuffer * read_buffer)
 {
-    auto in = read_buffer_builder->build(file_info);
-    return collectRequiredRowGroups(in.get(), total_row_groups);
+    auto load = [&]()
+    {
+        /// Only open the file on a cache miss
+        std::unique_ptr<DB::ReadBuffer> in;
+        if (!read_buffer)
+        {
+            in = read_buffer_builder->build(file_info);
+            read_buffer = in.get();
+        }
+        DB::FormatSettings format_settings{
+            .seekable_read = true,
+        };
+        std::atomic<int> is_stopped{0};
+        try
+        {
+            return parquet::ReadMetaData(asArrowFile(*read_buffer, format_settings, is_stopped, "Parquet", PARQUET_MAGIC_BYTES));
+        }
+        catch (const parquet::ParquetException & e)
+        {
+            throw DB::Exception(DB::ErrorCodes::BAD_ARGUMENTS, "Open file({}) failed. {}", file_info.uri_file(), e.what());
+        }
+    };
+
+    std::call_once(file_version_flag, [&]() { file_version = read_buffer_builder->getFileVersion(file_info); });
+    if (!file_version)
+        return load();
+    return ParquetMetaDataCache::instance().getOrLoad(file_info.uri_file(), file_version->size, file_version->modification_time, load);
 }
 
-std::vector<RowGroupInfomation> ParquetFormatFile::collectRequiredRowGroups(DB::ReadBuffer * read_buffer, int & total_row_groups)
+std::vector<RowGroupInfomation>
+ParquetFormatFile::collectRequiredRowGroups(const parquet::FileMetaData & metadata, int & total_row_groups)
 {
-    DB::FormatSettings format_settings{
-        .seekable_read = true,
-    };
-    std::atomic<int> is_stopped{0};
-    std::unique_ptr<parquet::arrow::FileReader> reader;
-    auto status = parquet::arrow::OpenFile(
-        asArrowFile(*read_buffer, format_settings, is_stopped, "Parquet", PARQUET_MAGIC_BYTES), arrow::default_memory_pool(), &reader);
-    if (!status.ok())
-        throw DB::Exception(DB::ErrorCodes::BAD_ARGUMENTS, "Open file({}) failed. {}", file_info.uri_file(), status.ToString());
-
-    auto file_meta = reader->parquet_reader()->metadata();
-    total_row_groups = file_meta->num_row_groups();
+    total_row_groups = metadata.num_row_groups();
 
     std::vector<RowGroupInfomation> row_group_metadatas;
     row_group_metadatas.reserve(total_row_groups);
+    size_t pruned_row_groups = 0;
     for (int i = 0; i < total_row_groups; ++i)
     {
-        auto row_group_meta = file_meta->RowGroup(i);
+        auto row_group_meta = metadata.RowGroup(i);
 
         auto offset = static_cast<UInt64>(row_group_meta->file_offset());
         if (!offset)
@@ -145,6 +301,12 @@ std::vector<RowGroupInfomation> ParquetFormatFile::collectRequiredRowGroups(DB::
         /// Current row group has intersection with the required range.
         if (file_info.start() <= offset && offset < file_info.start() + file_info.length())
         {
+            if (key_condition && !mayMatch(*key_condition, key_columns, *row_group_meta, *metadata.schema()))
+            {
+                ++pruned_row_groups;
+                continue;
+            }
+
             RowGroupInfomation info;
             info.index = i;
             info.num_rows = row_group_meta->num_rows();
@@ -154,6 +316,12 @@ std::vector<RowGroupInfomation> ParquetFormatFile::collectRequiredRowGroups(DB::
             row_group_metadatas.emplace_back(std::move(info));
         }
     }
+    if (pruned_row_groups)
+        LOG_DEBUG(
+            &Poco::Logger::get("ParquetFormatFile"),
+            "Skipped {} row groups of file {} by statistics",
+            pruned_row_groups,
+            file_info.uri_file());
     return row_group_metadatas;
 }
 }
@@ -5,9 +5,15 @@
 #if USE_PARQUET
 // clang-format off
 #include <memory>
+#include <mutex>
 #include <IO/ReadBuffer.h>
 #include <Storages/SubstraitSource/FormatFile.h>
 // clang-format on
+namespace parquet
+{
+class FileMetaData;
+}
+
 namespace local_engine
 {
 struct RowGroupInfomation
@@ -32,8 +38,12 @@ private:
     std::mutex mutex;
     std::optional<size_t> total_rows;
 
-    std::vector<RowGroupInfomation> collectRequiredRowGroups(int & total_row_groups);
-    std::vector<RowGroupInfomation> collectRequiredRowGroups(DB::ReadBuffer * read_buffer, int & total_row_groups);
+    std::once_flag file_version_flag;
+    std::optional<ReadBufferBuilder::FileVersion> file_version;
+
+    /// Parse the footer of the file from read_buffer, or from a new read buffer if it's null, unless ParquetMetaDataCache has it
+    std::shared_ptr<parquet::FileMetaData> readMetaData(DB::ReadBuffer * read_buffer = nullptr);
+    std::vector<RowGroupInfomation> collectRequiredRowGroups(const parquet::FileMetaData & metadata, int & total_row_groups);
 };
 
 }
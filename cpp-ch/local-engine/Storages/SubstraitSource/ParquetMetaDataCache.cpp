@@ -0,0 +1,72 @@
+#include "ParquetMetaDataCache.h"
+
+#if USE_PARQUET
+#include <Common/SipHash.h>
+#include <Common/logger_useful.h>
+
+namespace local_engine
+{
+ParquetMetaDataCache & ParquetMetaDataCache::instance()
+{
+    static ParquetMetaDataCache cache;
+    return cache;
+}
+
+void ParquetMetaDataCache::init(size_t max_size_in_bytes)
+{
+    if (cache)
+        return;
+    if (max_size_in_bytes)
+        cache = std::make_unique<Cache>(max_size_in_bytes);
+}
+
+ParquetMetaDataCache::MetaDataPtr
+ParquetMetaDataCache::getOrLoad(const String & path, size_t file_size, time_t modification_time, const Loader & load)
+{
+    if (!cache)
+        return load();
+
+    SipHash hash;
+    hash.update(path.data(), path.size());
+    hash.update(file_size);
+    hash.update(modification_time);
+    auto [metadata, loaded] = cache->getOrSet(hash.get128(), load);
+    if (!loaded)
+    {
+        ++hits;
+        return metadata;
+    }
+
+    /// Misses are rare once the footers of the scanned tables are cached, so they carry the running totals
+    ++misses;
+    LOG_DEBUG(
+        &Poco::Logger::get("ParquetMetaDataCache"),
+        "Cached parquet metadata of {}, {} hits, {} misses, {} entries of {} bytes",
+        path,
+        hits.load(),
+        misses.load(),
+        cache->count(),
+        cache->weight());
+    return metadata;
+}
+
+ParquetMetaDataCache::Stats ParquetMetaDataCache::getStats() const
+{
+    Stats stats{.hits = hits, .misses = misses};
+    if (cache)
+    {
+        stats.entries = cache->count();
+        stats.bytes = cache->weight();
+    }
+    return stats;
+}
+
+void ParquetMetaDataCache::reset()
+{
+    if (cache)
+        cache->reset();
+    hits = 0;
+    misses = 0;
+}
+}
+#endif
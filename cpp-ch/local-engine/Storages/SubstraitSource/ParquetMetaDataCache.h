@@ -0,0 +1,60 @@
+#pragma once
+
+#include "config.h"
+
+#if USE_PARQUET
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <parquet/metadata.h>
+#include <Common/CacheBase.h>
+#include <Common/HashTable/Hash.h>
+
+namespace local_engine
+{
+struct ParquetMetaDataWeightFunction
+{
+    /// The serialized size of the footer, the decoded metadata takes a few times more memory.
+    size_t operator()(const parquet::FileMetaData & metadata) const { return metadata.size(); }
+};
+
+/// Process wide LRU cache of parsed Parquet footers, shared by the row group selection and the readers of all tasks.
+/// An entry is keyed by the path, size and modification time of the file, so a rewritten file is never served stale
+/// metadata. Files whose modification time is unknown are not cached.
+class ParquetMetaDataCache : private boost::noncopyable
+{
+public:
+    using MetaDataPtr = std::shared_ptr<parquet::FileMetaData>;
+    using Loader = std::function<MetaDataPtr()>;
+
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    static ParquetMetaDataCache & instance();
+
+    /// The cache stays disabled until initialized with a non zero size.
+    void init(size_t max_size_in_bytes);
+
+    /// Return the cached metadata of the file, or call load and cache its result.
+    MetaDataPtr getOrLoad(const String & path, size_t file_size, time_t modification_time, const Loader & load);
+
+    /// The running totals are also logged with every miss, and once when the backend is finalized.
+    Stats getStats() const;
+
+    void reset();
+
+private:
+    using Cache = DB::CacheBase<UInt128, parquet::FileMetaData, UInt128TrivialHash, ParquetMetaDataWeightFunction>;
+
+    std::unique_ptr<Cache> cache;
+    std::atomic<size_t> hits = 0;
+    std::atomic<size_t> misses = 0;
+};
+}
+#endif
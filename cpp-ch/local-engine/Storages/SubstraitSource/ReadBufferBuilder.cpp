@@ -1,4 +1,6 @@
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <Disks/IO/AsynchronousBoundedReadBuffer.h>
 #include <Disks/IO/ReadBufferFromAzureBlobStorage.h>
 #include <Disks/IO/ReadBufferFromRemoteFSGather.h>
@@ -69,6 +71,14 @@ public:
             read_buffer = std::make_unique<DB::ReadBufferFromFilePRead>(file_path);
         return read_buffer;
     }
+
+    std::optional<FileVersion> getFileVersion(const substrait::ReadRel::LocalFiles::FileOrFiles & file_info) override
+    {
+        struct stat file_stat;
+        if (stat(Poco::URI(file_info.uri_file()).getPath().c_str(), &file_stat))
+            return {};
+        return FileVersion{.size = static_cast<size_t>(file_stat.st_size), .modification_time = file_stat.st_mtime};
+    }
 };
 
 #if USE_HDFS
@@ -110,6 +120,20 @@ public:
         return read_buffer;
     }
 
+    std::optional<FileVersion> getFileVersion(const substrait::ReadRel::LocalFiles::FileOrFiles & file_info) override
+    {
+        Poco::URI file_uri(file_info.uri_file());
+        std::string uri_path = "hdfs://" + file_uri.getHost();
+        if (file_uri.getPort())
+            uri_path += ":" + std::to_string(file_uri.getPort());
+        auto * hdfs_file_info = hdfsGetPathInfo(getConnection(uri_path, file_uri.getPath()), file_uri.getPath().c_str());
+        if (!hdfs_file_info)
+            return {};
+        FileVersion version{.size = static_cast<size_t>(hdfs_file_info->mSize), .modification_time = hdfs_file_info->mLastMod};
+        hdfsFreeFileInfo(hdfs_file_info, 1);
+        return version;
+    }
+
     std::pair<size_t, size_t> adjustFileReadStartAndEndPos(
         size_t read_start_pos,
         size_t read_end_pos,
@@ -189,6 +213,29 @@ public:
         }
         return result;
     }
+
+private:
+    struct HDFSConnection
+    {
+        DB::HDFSBuilderWrapper builder;
+        DB::HDFSFSPtr fs;
+    };
+    std::mutex connections_mutex;
+    /// Connections by namenode for getFileVersion, so that looking up every file doesn't connect again
+    std::unordered_map<std::string, HDFSConnection> connections;
+
+    hdfsFS getConnection(const std::string & uri_path, const std::string & file_path)
+    {
+        std::lock_guard lock(connections_mutex);
+        auto it = connections.find(uri_path);
+        if (it == connections.end())
+        {
+            auto builder = DB::createHDFSBuilder(uri_path + file_path, context->getGlobalContext()->getConfigRef());
+            auto fs = DB::createHDFSFS(builder.get());
+            it = connections.emplace(uri_path, HDFSConnection{std::move(builder), std::move(fs)}).first;
+        }
+        return it->second.fs.get();
+    }
 };
 #endif
 
@@ -224,13 +271,13 @@ public:
         // file uri looks like: s3a://my-dev-bucket/tpch100/part/0001.parquet
         std::string bucket = file_uri.getHost();
         std::string key = file_uri.getPath().substr(1);
-        size_t object_size = DB::S3::getObjectSize(*client, bucket, key, "");
+        size_t object_size = getObjectVersion(bucket, key).size;
 
         auto read_buffer_creator
-            = [bucket, this](const std::string & path, size_t read_until_position) -> std::unique_ptr<DB::ReadBufferFromFileBase>
+            = [bucket, client, this](const std::string & path, size_t read_until_position) -> std::unique_ptr<DB::ReadBufferFromFileBase>
         {
             return std::make_unique<DB::ReadBufferFromS3>(
-                shared_client,
+                client,
                 bucket,
                 path,
                 "",
@@ -257,16 +304,47 @@ public:
         return async_reader;
     }
 
+    std::optional<FileVersion> getFileVersion(const substrait::ReadRel::LocalFiles::FileOrFiles & file_info) override
+    {
+        Poco::URI file_uri(file_info.uri_file());
+        return getObjectVersion(file_uri.getHost(), file_uri.getPath().substr(1));
+    }
+
 private:
+    std::mutex object_versions_mutex;
+    /// Versions of the objects this builder has seen, so that a file is only sent one HEAD request for both
+    /// getFileVersion and build.
+    std::unordered_map<std::string, FileVersion> object_versions;
+
+    FileVersion getObjectVersion(const std::string & bucket, const std::string & key)
+    {
+        const auto path = bucket + "/" + key;
+        {
+            std::lock_guard lock(object_versions_mutex);
+            if (auto it = object_versions.find(path); it != object_versions.end())
+                return it->second;
+        }
+        auto object_info = DB::S3::getObjectInfo(*getClient(), bucket, key, "");
+        FileVersion version{.size = object_info.size, .modification_time = object_info.last_modification_time};
+        std::lock_guard lock(object_versions_mutex);
+        object_versions.emplace(path, version);
+        return version;
+    }
+
+    /// Builders may be used by several prefetch threads at once, the client is created by the first of them.
+    std::once_flag client_created;
     std::shared_ptr<DB::S3::Client> shared_client;
     DB::ReadSettings new_settings;
 
 
     std::shared_ptr<DB::S3::Client> getClient()
     {
-        if (shared_client)
-            return shared_client;
+        std::call_once(client_created, [this] { shared_client = createClient(); });
+        return shared_client;
+    }
 
+    std::shared_ptr<DB::S3::Client> createClient()
+    {
         const auto & config = context->getConfigRef();
         String config_prefix = "s3";
         auto endpoint = config.getString(config_prefix + ".endpoint", "https://s3.us-west-2.amazonaws.com");
@@ -299,7 +377,7 @@ private:
         client_configuration.retryStrategy
             = std::make_shared<Aws::Client::DefaultRetryStrategy>(config.getUInt(config_prefix + ".retry_attempts", 10));
 
-        shared_client = DB::S3::ClientFactory::instance().create(
+        return DB::S3::ClientFactory::instance().create(
             client_configuration,
             false,
             config.getString(config_prefix + ".access_key_id", ""),
@@ -311,7 +389,6 @@ private:
              = config.getBool(config_prefix + ".use_environment_credentials", config.getBool("s3.use_environment_credentials", false)),
              .use_insecure_imds_request
              = config.getBool(config_prefix + ".use_insecure_imds_request", config.getBool("s3.use_insecure_imds_request", false))});
-        return shared_client;
     }
 };
 #endif
@@ -332,13 +409,12 @@ public:
     }
 
 private:
+    std::once_flag client_created;
     std::shared_ptr<Azure::Storage::Blobs::BlobContainerClient> shared_client;
 
     std::shared_ptr<Azure::Storage::Blobs::BlobContainerClient> getClient()
     {
-        if (shared_client)
-            return shared_client;
-        shared_client = DB::getAzureBlobContainerClient(context->getConfigRef(), "blob");
+        std::call_once(client_created, [this] { shared_client = DB::getAzureBlobContainerClient(context->getConfigRef(), "blob"); });
         return shared_client;
     }
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include <functional>
 #include <memory>
+#include <optional>
 #include <IO/ReadBuffer.h>
 #include <Interpreters/Context.h>
 #include <Interpreters/Context_fwd.h>
@@ -15,6 +16,15 @@ public:
     virtual ~ReadBufferBuilder() = default;
     /// build a new read buffer
     virtual std::unique_ptr<DB::ReadBuffer> build(const substrait::ReadRel::LocalFiles::FileOrFiles & file_info, const bool & set_read_util_position=false) = 0;
+
+    struct FileVersion
+    {
+        size_t size = 0;
+        time_t modification_time = 0;
+    };
+    /// Identifies the content of the file for caches, empty if the file system doesn't tell its modification time.
+    virtual std::optional<FileVersion> getFileVersion(const substrait::ReadRel::LocalFiles::FileOrFiles & /*file_info*/) { return {}; }
+
 protected:
     DB::ContextPtr context;
 };
@@ -13,13 +13,16 @@
 #include <DataTypes/DataTypesNumber.h>
 #include <IO/ReadBufferFromString.h>
 #include <IO/ReadHelpers.h>
+#include <Interpreters/ExpressionActions.h>
 #include <Interpreters/castColumn.h>
 #include <QueryPipeline/Pipe.h>
 #include <Storages/SubstraitSource/FormatFile.h>
 #include <Storages/SubstraitSource/SubstraitFileSource.h>
 #include <Common/CHUtil.h>
+#include <Common/CurrentThread.h>
 #include <Common/Exception.h>
 #include <Common/StringUtils.h>
+#include <Common/setThreadName.h>
 #include <Common/typeid_cast.h>
 
 namespace DB
@@ -57,6 +60,8 @@ SubstraitFileSource::SubstraitFileSource(
     flatten_output_header = BlockUtil::flattenBlock(output_header, BlockUtil::FLAT_STRUCT, true);
 
     to_read_header = flatten_output_header;
+    max_prefetch_files = context->getConfigRef().getUInt64("file_prefetch.max_files", 0);
+    max_prefetch_bytes = context->getConfigRef().getUInt64("file_prefetch.max_bytes", 256UL << 20);
     if (file_infos.items_size())
     {
         Poco::URI file_uri(file_infos.items().Get(0).uri_file());
@@ -78,6 +83,30 @@ SubstraitFileSource::SubstraitFileSource(
     }
 }
 
+void SubstraitFileSource::setKeyCondition(const DB::ActionsDAGPtr & filter_actions_dag)
+{
+    if (!filter_actions_dag || files.empty())
+        return;
+
+    /// Only the top level columns read from files have statistics. Struct columns are flattened and
+    /// partition columns are removed in to_read_header.
+    DB::NamesAndTypesList key_columns;
+    for (const auto & column : output_header)
+        if (to_read_header.has(column.name))
+            key_columns.emplace_back(column.name, column.type);
+    if (key_columns.empty())
+        return;
+
+    auto key_expr = std::make_shared<DB::ExpressionActions>(std::make_shared<DB::ActionsDAG>(key_columns));
+    auto key_condition
+        = std::make_shared<const DB::KeyCondition>(filter_actions_dag, context, key_columns.getNames(), key_expr, DB::NameSet{});
+    if (key_condition->alwaysUnknownOrTrue())
+        return;
+
+    for (auto & file : files)
+        file->setKeyCondition(key_condition, key_columns);
+}
+
 DB::Chunk SubstraitFileSource::generate()
 {
     while (true)
@@ -118,39 +147,60 @@ bool SubstraitFileSource::tryPrepareReader()
     if (current_file_index >= files.size())
         return false;
 
-    auto current_file = files[current_file_index];
+    if (!prefetched_readers.empty())
+    {
+        file_reader = std::move(prefetched_readers.front());
+        prefetched_readers.pop_front();
+        prefetched_bytes -= file_reader->getFile()->getLength();
+    }
+    else
+        file_reader = createReader(files[current_file_index]);
     current_file_index += 1;
 
+    prefetchNextFiles();
+    return true;
+}
+
+void SubstraitFileSource::prefetchNextFiles()
+{
+    while (prefetched_readers.size() < max_prefetch_files)
+    {
+        size_t file_index = current_file_index + prefetched_readers.size();
+        if (file_index >= files.size())
+            break;
+
+        const auto & file = files[file_index];
+        if (prefetched_bytes + file->getLength() > max_prefetch_bytes)
+            break;
+
+        prefetched_readers.emplace_back(std::make_unique<PrefetchedFileReader>(file, [this, file]() { return createReader(file); }));
+        prefetched_bytes += file->getLength();
+    }
+}
+
+std::unique_ptr<FileReaderWrapper> SubstraitFileSource::createReader(const FormatFilePtr & current_file) const
+{
     if (!current_file->supportSplit() && current_file->getStartOffset())
     {
         /// For the files do not support split strategy, the task with not 0 offset will generate empty data
-        file_reader = std::make_unique<EmptyFileReader>(current_file);
-        return true;
+        return std::make_unique<EmptyFileReader>(current_file);
     }
 
     if (!to_read_header.columns())
     {
         auto total_rows = current_file->getTotalRows();
         if (total_rows)
-        {
-            file_reader = std::make_unique<ConstColumnsFileReader>(current_file, context, flatten_output_header, *total_rows);
-        }
-        else
-        {
-            /// For text/json format file, we can't get total rows from file metadata.
-            /// So we add a dummy column to indicate the number of rows.
-            auto dummy_header = BlockUtil::buildRowCountHeader();
-            auto flatten_output_header_contains_dummy = flatten_output_header;
-            flatten_output_header_contains_dummy.insertUnique(dummy_header.getByPosition(0));
-            file_reader = std::make_unique<NormalFileReader>(current_file, context, dummy_header, flatten_output_header_contains_dummy);
-        }
-    }
-    else
-    {
-        file_reader = std::make_unique<NormalFileReader>(current_file, context, to_read_header, flatten_output_header);
+            return std::make_unique<ConstColumnsFileReader>(current_file, context, flatten_output_header, *total_rows);
+
+        /// For text/json format file, we can't get total rows from file metadata.
+        /// So we add a dummy column to indicate the number of rows.
+        auto dummy_header = BlockUtil::buildRowCountHeader();
+        auto flatten_output_header_contains_dummy = flatten_output_header;
+        flatten_output_header_contains_dummy.insertUnique(dummy_header.getByPosition(0));
+        return std::make_unique<NormalFileReader>(current_file, context, dummy_header, flatten_output_header_contains_dummy);
     }
 
-    return true;
+    return std::make_unique<NormalFileReader>(current_file, context, to_read_header, flatten_output_header);
 }
 
 DB::Block SubstraitFileSource::foldFlattenColumns(const DB::Columns & cols, const DB::Block & header)
@@ -396,4 +446,53 @@ bool NormalFileReader::pull(DB::Chunk & chunk)
     chunk = DB::Chunk(std::move(res_columns), rows);
     return true;
 }
+
+PrefetchedFileReader::PrefetchedFileReader(FormatFilePtr file_, ReaderCreator create_reader) : FileReaderWrapper(file_)
+{
+    auto thread_group = DB::CurrentThread::getGroup();
+    prefetch_thread = ThreadFromGlobalPool(
+        [this, thread_group, create_reader = std::move(create_reader)]()
+        {
+            if (thread_group)
+                DB::CurrentThread::attachToGroupIfDetached(thread_group);
+            DB::setThreadName("FilePrefetch");
+            try
+            {
+                reader = create_reader();
+                has_first_chunk = reader->pull(first_chunk);
+            }
+            catch (...)
+            {
+                prefetch_exception = std::current_exception();
+            }
+            if (thread_group)
+                DB::CurrentThread::detachFromGroupIfNotDetached();
+        });
+}
+
+PrefetchedFileReader::~PrefetchedFileReader()
+{
+    if (prefetch_thread.joinable())
+        prefetch_thread.join();
+}
+
+void PrefetchedFileReader::waitPrefetched()
+{
+    if (prefetch_thread.joinable())
+        prefetch_thread.join();
+    if (prefetch_exception)
+        std::rethrow_exception(std::exchange(prefetch_exception, nullptr));
+}
+
+bool PrefetchedFileReader::pull(DB::Chunk & chunk)
+{
+    waitPrefetched();
+    if (has_first_chunk)
+    {
+        has_first_chunk = false;
+        chunk = std::move(first_chunk);
+        return true;
+    }
+    return reader && reader->pull(chunk);
+}
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <deque>
+#include <functional>
 #include <Columns/IColumn.h>
 #include <Core/Block.h>
 #include <Core/ColumnsWithTypeAndName.h>
@@ -12,6 +14,7 @@
 #include <Storages/SubstraitSource/FormatFile.h>
 #include <Storages/SubstraitSource/ReadBufferBuilder.h>
 #include <base/types.h>
+#include <Common/ThreadPool.h>
 
 namespace local_engine
 {
@@ -22,6 +25,8 @@ public:
     virtual ~FileReaderWrapper() = default;
     virtual bool pull(DB::Chunk & chunk) = 0;
 
+    const FormatFilePtr & getFile() const { return file; }
+
 protected:
     FormatFilePtr file;
 
@@ -70,6 +75,28 @@ private:
     size_t block_size;
 };
 
+/// Builds the reader of a file and pulls its first chunk on a background thread, which opens the file,
+/// parses its metadata and reads the first row group while the previous files are still being consumed.
+class PrefetchedFileReader : public FileReaderWrapper
+{
+public:
+    using ReaderCreator = std::function<std::unique_ptr<FileReaderWrapper>()>;
+
+    PrefetchedFileReader(FormatFilePtr file_, ReaderCreator create_reader);
+    ~PrefetchedFileReader() override;
+    bool pull(DB::Chunk & chunk) override;
+
+private:
+    std::unique_ptr<FileReaderWrapper> reader;
+    ThreadFromGlobalPool prefetch_thread;
+    std::exception_ptr prefetch_exception;
+    DB::Chunk first_chunk;
+    bool has_first_chunk = false;
+
+    /// Wait for the prefetch to finish and rethrow its exception if any.
+    void waitPrefetched();
+};
+
 class SubstraitFileSource : public DB::ISource
 {
 public:
@@ -78,6 +105,10 @@ public:
 
     String getName() const override { return "SubstraitFileSource"; }
 
+    /// Use the filter to skip the parts of files whose statistics show that no row can match it.
+    /// The filter is not applied on the returned rows.
+    void setKeyCondition(const DB::ActionsDAGPtr & filter_actions_dag);
+
 protected:
     DB::Chunk generate() override;
 
@@ -92,7 +123,16 @@ private:
     std::unique_ptr<FileReaderWrapper> file_reader;
     ReadBufferBuilderPtr read_buffer_builder;
 
+    /// Look-ahead of the files following current_file_index, configured by file_prefetch.max_files
+    /// and file_prefetch.max_bytes. The readers reference this source, so they are declared last to be destroyed first.
+    size_t max_prefetch_files = 0;
+    size_t max_prefetch_bytes = 0;
+    size_t prefetched_bytes = 0;
+    std::deque<std::unique_ptr<FileReaderWrapper>> prefetched_readers;
+
     bool tryPrepareReader();
+    std::unique_ptr<FileReaderWrapper> createReader(const FormatFilePtr & file) const;
+    void prefetchNextFiles();
 
     // E.g we have flatten columns correspond to header {a:int, b.x.i: int, b.x.j: string, b.y: string}
     // but we want to fold all the flatten struct columns into one struct column,
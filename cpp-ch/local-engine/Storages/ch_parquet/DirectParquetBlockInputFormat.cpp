@@ -0,0 +1,556 @@
+#include "DirectParquetBlockInputFormat.h"
+
+#if USE_PARQUET && USE_LOCAL_FORMATS
+// clang-format off
+#include <utility>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <Columns/ColumnLowCardinality.h>
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnString.h>
+#include <Columns/ColumnsNumber.h>
+#include <DataTypes/DataTypeLowCardinality.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <Processors/Formats/Impl/ArrowBufferedStreams.h>
+#include <Storages/ch_parquet/arrow/column_reader.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
+#include <Common/assert_cast.h>
+#include <Common/typeid_cast.h>
+// clang-format on
+namespace DB
+{
+namespace ErrorCodes
+{
+    extern const int CANNOT_READ_ALL_DATA;
+    extern const int THERE_IS_NO_COLUMN;
+}
+
+/// Decodes one column chunk after another into columns of the header type.
+class IParquetColumnDecoder
+{
+public:
+    IParquetColumnDecoder(const parquet::ColumnDescriptor & column_, DataTypePtr type_) : column(column_), type(std::move(type_)) { }
+    virtual ~IParquetColumnDecoder() = default;
+
+    /// Start to read the chunk of the column in the next row group.
+    virtual void startColumnChunk(std::unique_ptr<parquet::PageReader> pager, const parquet::ColumnChunkMetaData & /*chunk*/)
+    {
+        reader = ch_parquet::ColumnReader::Make(&column, std::move(pager));
+    }
+
+    /// Decode the next rows of the current chunk into a new column.
+    virtual ColumnPtr decode(size_t rows) = 0;
+
+protected:
+    /// Buffer for the definition levels of rows, nullptr if the column is required.
+    Int16 * prepareDefLevels(size_t rows)
+    {
+        if (column.max_definition_level() == 0)
+            return nullptr;
+        def_levels.resize(rows);
+        return def_levels.data();
+    }
+
+    bool isDefined(size_t i) const { return def_levels[i] == column.max_definition_level(); }
+
+    void fillNullMap(NullMap & null_map, size_t pos, size_t levels_read) const
+    {
+        const Int16 max_def_level = column.max_definition_level();
+        for (size_t i = 0; i < levels_read; ++i)
+            null_map[pos + i] = def_levels[i] != max_def_level;
+    }
+
+    [[noreturn]] void throwUnexpectedEnd() const
+    {
+        throw Exception(ErrorCodes::CANNOT_READ_ALL_DATA, "Column chunk of {} ended before its row group", column.name());
+    }
+
+    const parquet::ColumnDescriptor & column;
+    const DataTypePtr type;
+    std::shared_ptr<ch_parquet::ColumnReader> reader;
+    PaddedPODArray<Int16> def_levels;
+};
+
+namespace
+{
+template <typename DType, typename ValueType>
+class NumericColumnDecoder : public IParquetColumnDecoder
+{
+    using ParquetType = typename DType::c_type;
+    /// Values with the same representation are decoded into the column in place, others through a buffer.
+    static constexpr bool in_place
+        = sizeof(ParquetType) == sizeof(ValueType) && std::is_floating_point_v<ParquetType> == std::is_floating_point_v<ValueType>;
+
+public:
+    using IParquetColumnDecoder::IParquetColumnDecoder;
+
+    ColumnPtr decode(size_t rows) override
+    {
+        auto data_column = ColumnVector<ValueType>::create(rows);
+        auto & data = data_column->getData();
+        MutableColumnPtr null_map_column;
+        if (type->isNullable())
+            null_map_column = ColumnUInt8::create(rows, 0);
+
+        auto & typed_reader = static_cast<ch_parquet::TypedColumnReader<DType> &>(*reader);
+        Int16 * def_levels_data = prepareDefLevels(rows);
+        if constexpr (!in_place)
+            buffer.resize(rows);
+
+        size_t pos = 0;
+        while (pos < rows)
+        {
+            ParquetType * values;
+            if constexpr (in_place)
+                values = reinterpret_cast<ParquetType *>(&data[pos]);
+            else
+                values = buffer.data();
+
+            /// ReadBatch stops at the end of a page, so a batch may take several calls.
+            int64_t values_read = 0;
+            auto levels_read = static_cast<size_t>(typed_reader.ReadBatch(rows - pos, def_levels_data, nullptr, values, &values_read));
+            if (!levels_read)
+                throwUnexpectedEnd();
+
+            if constexpr (!in_place)
+                for (int64_t i = 0; i < values_read; ++i)
+                    data[pos + i] = static_cast<ValueType>(buffer[i]);
+
+            if (def_levels_data)
+            {
+                if (static_cast<size_t>(values_read) < levels_read)
+                    spaceValues(&data[pos], levels_read, values_read);
+                if (null_map_column)
+                    fillNullMap(assert_cast<ColumnUInt8 &>(*null_map_column).getData(), pos, levels_read);
+            }
+            pos += levels_read;
+        }
+
+        if (null_map_column)
+            return ColumnNullable::create(std::move(data_column), std::move(null_map_column));
+        return data_column;
+    }
+
+private:
+    /// Move the dense non-null values to their rows, backwards so that no value is overwritten before it is moved.
+    void spaceValues(ValueType * values, size_t levels_read, size_t values_read) const
+    {
+        size_t j = values_read;
+        for (size_t i = levels_read; i-- > 0;)
+            values[i] = isDefined(i) ? values[--j] : ValueType{};
+    }
+
+    PaddedPODArray<ParquetType> buffer;
+};
+
+class StringColumnDecoder : public IParquetColumnDecoder
+{
+public:
+    using IParquetColumnDecoder::IParquetColumnDecoder;
+
+    ColumnPtr decode(size_t rows) override
+    {
+        auto data_column = ColumnString::create();
+        data_column->reserve(rows);
+        MutableColumnPtr null_map_column;
+        if (type->isNullable())
+            null_map_column = ColumnUInt8::create(rows, 0);
+
+        auto & typed_reader = static_cast<ch_parquet::ByteArrayReader &>(*reader);
+        Int16 * def_levels_data = prepareDefLevels(rows);
+        values.resize(rows);
+
+        size_t pos = 0;
+        while (pos < rows)
+        {
+            int64_t values_read = 0;
+            auto levels_read = static_cast<size_t>(typed_reader.ReadBatch(rows - pos, def_levels_data, nullptr, values.data(), &values_read));
+            if (!levels_read)
+                throwUnexpectedEnd();
+
+            if (!def_levels_data)
+            {
+                for (size_t i = 0; i < levels_read; ++i)
+                    data_column->insertData(reinterpret_cast<const char *>(values[i].ptr), values[i].len);
+            }
+            else
+            {
+                for (size_t i = 0, j = 0; i < levels_read; ++i)
+                {
+                    if (isDefined(i))
+                    {
+                        data_column->insertData(reinterpret_cast<const char *>(values[j].ptr), values[j].len);
+                        ++j;
+                    }
+                    else
+                        data_column->insertDefault();
+                }
+                if (null_map_column)
+                    fillNullMap(assert_cast<ColumnUInt8 &>(*null_map_column).getData(), pos, levels_read);
+            }
+            pos += levels_read;
+        }
+
+        if (null_map_column)
+            return ColumnNullable::create(std::move(data_column), std::move(null_map_column));
+        return data_column;
+    }
+
+private:
+    PODArray<parquet::ByteArray> values;
+};
+
+/// Whether all the data pages of the chunk are dictionary encoded, so that it can be read with ReadBatchWithDictionary.
+bool isFullyDictionaryEncoded(const parquet::ColumnChunkMetaData & chunk)
+{
+    if (!chunk.has_dictionary_page())
+        return false;
+    const auto & encoding_stats = chunk.encoding_stats();
+    if (encoding_stats.empty())
+        return false;
+    for (const auto & stats : encoding_stats)
+    {
+        bool is_data_page = stats.page_type == parquet::PageType::DATA_PAGE || stats.page_type == parquet::PageType::DATA_PAGE_V2;
+        bool is_dictionary = stats.encoding == parquet::Encoding::PLAIN_DICTIONARY || stats.encoding == parquet::Encoding::RLE_DICTIONARY;
+        if (is_data_page && !is_dictionary && stats.count > 0)
+            return false;
+    }
+    return true;
+}
+
+/// Reads the dictionary indices of dictionary encoded chunks and maps them to a ColumnUnique built once per chunk, so that
+/// the strings are neither copied nor hashed per row. Chunks with plain encoded pages are decoded as strings and then
+/// converted.
+class LowCardinalityColumnDecoder : public IParquetColumnDecoder
+{
+public:
+    LowCardinalityColumnDecoder(const parquet::ColumnDescriptor & column_, DataTypePtr type_)
+        : IParquetColumnDecoder(column_, std::move(type_))
+        , dictionary_type(assert_cast<const DataTypeLowCardinality &>(*type).getDictionaryType())
+        , string_decoder(column_, dictionary_type)
+    {
+    }
+
+    void startColumnChunk(std::unique_ptr<parquet::PageReader> pager, const parquet::ColumnChunkMetaData & chunk) override
+    {
+        dictionary_encoded = isFullyDictionaryEncoded(chunk);
+        current_dictionary = nullptr;
+        if (dictionary_encoded)
+            reader = ch_parquet::ColumnReader::MakeWithExposedDictionary(&column, std::move(pager));
+        else
+            string_decoder.startColumnChunk(std::move(pager), chunk);
+    }
+
+    ColumnPtr decode(size_t rows) override
+    {
+        if (!dictionary_encoded)
+        {
+            auto full_column = string_decoder.decode(rows);
+            auto res = type->createColumn();
+            assert_cast<ColumnLowCardinality &>(*res).insertRangeFromFullColumn(*full_column, 0, rows);
+            return res;
+        }
+
+        auto indexes_column = ColumnUInt32::create(rows);
+        auto & indexes = indexes_column->getData();
+        auto & typed_reader = static_cast<ch_parquet::ByteArrayReader &>(*reader);
+        Int16 * def_levels_data = prepareDefLevels(rows);
+        dictionary_indices.resize(rows);
+
+        size_t pos = 0;
+        while (pos < rows)
+        {
+            int64_t indices_read = 0;
+            const parquet::ByteArray * dictionary = nullptr;
+            int32_t dictionary_size = 0;
+            auto levels_read = static_cast<size_t>(typed_reader.ReadBatchWithDictionary(
+                rows - pos, def_levels_data, nullptr, dictionary_indices.data(), &indices_read, &dictionary, &dictionary_size));
+            if (!levels_read)
+                throwUnexpectedEnd();
+            if (dictionary != current_dictionary)
+                setDictionary(dictionary, dictionary_size);
+
+            if (!def_levels_data)
+            {
+                for (size_t i = 0; i < levels_read; ++i)
+                    indexes[pos + i] = dictionary_positions[dictionary_indices[i]];
+            }
+            else
+            {
+                for (size_t i = 0, j = 0; i < levels_read; ++i)
+                    indexes[pos + i] = isDefined(i) ? dictionary_positions[dictionary_indices[j++]] : null_position;
+            }
+            pos += levels_read;
+        }
+
+        ColumnPtr indexes_ptr = std::move(indexes_column);
+        return ColumnLowCardinality::create(std::as_const(unique_column), std::as_const(indexes_ptr), /*is_shared*/ true);
+    }
+
+private:
+    void setDictionary(const parquet::ByteArray * dictionary, int32_t dictionary_size)
+    {
+        auto keys = ColumnString::create();
+        keys->reserve(dictionary_size);
+        for (int32_t i = 0; i < dictionary_size; ++i)
+            keys->insertData(reinterpret_cast<const char *>(dictionary[i].ptr), dictionary[i].len);
+
+        auto unique = DataTypeLowCardinality::createColumnUnique(*dictionary_type);
+        auto positions = unique->uniqueInsertRangeFrom(*keys, 0, dictionary_size);
+        dictionary_positions.resize(dictionary_size);
+        for (int32_t i = 0; i < dictionary_size; ++i)
+            dictionary_positions[i] = static_cast<UInt32>(positions->getUInt(i));
+        null_position = static_cast<UInt32>(dictionary_type->isNullable() ? unique->getNullValueIndex() : unique->getNestedTypeDefaultValueIndex());
+
+        unique_column = std::move(unique);
+        current_dictionary = dictionary;
+    }
+
+    const DataTypePtr dictionary_type;
+    StringColumnDecoder string_decoder;
+    bool dictionary_encoded = false;
+
+    const parquet::ByteArray * current_dictionary = nullptr;
+    /// Shared by all the columns decoded from the current chunk.
+    ColumnPtr unique_column;
+    PaddedPODArray<UInt32> dictionary_positions;
+    UInt32 null_position = 0;
+    PaddedPODArray<Int32> dictionary_indices;
+};
+
+bool isStringColumn(const parquet::ColumnDescriptor & column)
+{
+    const auto & logical_type = column.logical_type();
+    return !logical_type || logical_type->is_none() || logical_type->is_string() || logical_type->is_JSON() || logical_type->is_BSON()
+        || logical_type->is_enum();
+}
+
+std::unique_ptr<IParquetColumnDecoder> createDecoder(const parquet::ColumnDescriptor & column, const DataTypePtr & type)
+{
+    if (column.max_repetition_level() > 0 || column.max_definition_level() > 1)
+        return nullptr;
+
+    if (const auto * low_cardinality_type = typeid_cast<const DataTypeLowCardinality *>(type.get()))
+    {
+        if (column.physical_type() == parquet::Type::BYTE_ARRAY && isStringColumn(column)
+            && isString(removeNullable(low_cardinality_type->getDictionaryType())))
+            return std::make_unique<LowCardinalityColumnDecoder>(column, type);
+        return nullptr;
+    }
+
+    WhichDataType which(removeNullable(type));
+    const auto & logical_type = column.logical_type();
+    /// Unsigned integers are stored as signed ones, and decimals need to be rescaled.
+    bool is_signed_int = !logical_type || logical_type->is_none()
+        || (logical_type->is_int() && static_cast<const parquet::IntLogicalType &>(*logical_type).is_signed());
+    switch (column.physical_type())
+    {
+        case parquet::Type::BOOLEAN:
+            if (which.isUInt8())
+                return std::make_unique<NumericColumnDecoder<parquet::BooleanType, UInt8>>(column, type);
+            break;
+        case parquet::Type::INT32:
+            if (which.isDate32() && logical_type && logical_type->is_date())
+                return std::make_unique<NumericColumnDecoder<parquet::Int32Type, Int32>>(column, type);
+            if (!is_signed_int)
+                break;
+            if (which.isInt8())
+                return std::make_unique<NumericColumnDecoder<parquet::Int32Type, Int8>>(column, type);
+            if (which.isInt16())
+                return std::make_unique<NumericColumnDecoder<parquet::Int32Type, Int16>>(column, type);
+            if (which.isInt32())
+                return std::make_unique<NumericColumnDecoder<parquet::Int32Type, Int32>>(column, type);
+            break;
+        case parquet::Type::INT64:
+            if (is_signed_int && which.isInt64())
+                return std::make_unique<NumericColumnDecoder<parquet::Int64Type, Int64>>(column, type);
+            break;
+        case parquet::Type::FLOAT:
+            if (which.isFloat32())
+                return std::make_unique<NumericColumnDecoder<parquet::FloatType, Float32>>(column, type);
+            break;
+        case parquet::Type::DOUBLE:
+            if (which.isFloat64())
+                return std::make_unique<NumericColumnDecoder<parquet::DoubleType, Float64>>(column, type);
+            break;
+        case parquet::Type::BYTE_ARRAY:
+            if (which.isString() && isStringColumn(column))
+                return std::make_unique<StringColumnDecoder>(column, type);
+            break;
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+/// Index of the top-level field of the file named name, -1 if there is none.
+int findField(const parquet::SchemaDescriptor & schema, const String & name, const FormatSettings & format_settings)
+{
+    const auto & root = *schema.group_node();
+    bool case_insensitive = format_settings.use_lowercase_column_name || format_settings.parquet.case_insensitive_column_matching;
+    if (!case_insensitive)
+        return root.FieldIndex(name);
+
+    auto lower_name = boost::to_lower_copy(name);
+    for (int i = 0; i < root.field_count(); ++i)
+        if (boost::to_lower_copy(root.field(i)->name()) == lower_name)
+            return i;
+    return -1;
+}
+
+/// Index of the leaf column for a top-level field, -1 if the field is missing or is not primitive.
+int findColumn(const parquet::SchemaDescriptor & schema, const String & name, const FormatSettings & format_settings, bool & missing)
+{
+    int field_index = findField(schema, name, format_settings);
+    missing = field_index < 0;
+    if (missing)
+        return -1;
+    const auto & field = *schema.group_node()->field(field_index);
+    if (!field.is_primitive())
+        return -1;
+    return schema.ColumnIndex(field);
+}
+}
+
+DirectParquetBlockInputFormat::DirectParquetBlockInputFormat(
+    ReadBuffer & in_,
+    Block header_,
+    const FormatSettings & format_settings_,
+    std::vector<int> row_group_indices_,
+    std::shared_ptr<parquet::FileMetaData> metadata_)
+    : IInputFormat(std::move(header_), in_)
+    , format_settings(format_settings_)
+    , row_group_indices(std::move(row_group_indices_))
+    , metadata(std::move(metadata_))
+{
+}
+
+DirectParquetBlockInputFormat::~DirectParquetBlockInputFormat() = default;
+
+bool DirectParquetBlockInputFormat::isSupported(const Block & header, const parquet::SchemaDescriptor & schema, const FormatSettings & format_settings)
+{
+    for (const auto & column : header)
+    {
+        bool missing;
+        int column_index = findColumn(schema, column.name, format_settings, missing);
+        if (missing)
+            continue;
+        if (column_index < 0 || !createDecoder(*schema.Column(column_index), column.type))
+            return false;
+    }
+    return true;
+}
+
+void DirectParquetBlockInputFormat::prepareReader()
+{
+    auto arrow_file = asArrowFile(*in, format_settings, is_stopped, "Parquet", PARQUET_MAGIC_BYTES);
+    if (is_stopped)
+        return;
+    file_reader = parquet::ParquetFileReader::Open(std::move(arrow_file), parquet::default_reader_properties(), metadata);
+
+    const auto & header = getPort().getHeader();
+    const auto & schema = *file_reader->metadata()->schema();
+    decoders.clear();
+    column_indices.clear();
+    missing_columns.clear();
+    for (size_t i = 0; i < header.columns(); ++i)
+    {
+        const auto & column = header.getByPosition(i);
+        bool missing;
+        int column_index = findColumn(schema, column.name, format_settings, missing);
+        if (missing)
+        {
+            if (!format_settings.parquet.allow_missing_columns)
+                throw Exception(ErrorCodes::THERE_IS_NO_COLUMN, "Column '{}' is not presented in input data.", column.name);
+            missing_columns.push_back(i);
+            decoders.emplace_back();
+            column_indices.push_back(-1);
+            continue;
+        }
+
+        auto decoder = column_index < 0 ? nullptr : createDecoder(*schema.Column(column_index), column.type);
+        if (!decoder)
+            throw Exception(
+                ErrorCodes::CANNOT_READ_ALL_DATA, "Can't decode Parquet column {} into {} directly", column.name, column.type->getName());
+        decoders.emplace_back(std::move(decoder));
+        column_indices.push_back(column_index);
+    }
+}
+
+bool DirectParquetBlockInputFormat::nextRowGroup()
+{
+    if (next_row_group >= row_group_indices.size())
+        return false;
+
+    auto row_group_reader = file_reader->RowGroup(row_group_indices[next_row_group]);
+    auto row_group_meta = file_reader->metadata()->RowGroup(row_group_indices[next_row_group]);
+    for (size_t i = 0; i < decoders.size(); ++i)
+        if (decoders[i])
+            decoders[i]->startColumnChunk(
+                row_group_reader->GetColumnPageReader(column_indices[i]), *row_group_meta->ColumnChunk(column_indices[i]));
+
+    row_group_rows_left = row_group_meta->num_rows();
+    ++next_row_group;
+    return true;
+}
+
+Chunk DirectParquetBlockInputFormat::generate()
+{
+    block_missing_values.clear();
+
+    try
+    {
+        if (!file_reader)
+            prepareReader();
+
+        if (is_stopped)
+            return {};
+
+        while (!row_group_rows_left)
+            if (!nextRowGroup())
+                return {};
+
+        /// Chunks don't cross row groups, so that dictionaries of the chunks can be shared by the columns.
+        size_t rows = std::min<size_t>(row_group_rows_left, 8192);
+        const auto & header = getPort().getHeader();
+        Columns columns;
+        columns.reserve(header.columns());
+        for (size_t i = 0; i < header.columns(); ++i)
+        {
+            if (decoders[i])
+                columns.emplace_back(decoders[i]->decode(rows));
+            else
+                columns.emplace_back(header.getByPosition(i).type->createColumnConstWithDefaultValue(rows)->convertToFullColumnIfConst());
+        }
+        row_group_rows_left -= rows;
+
+        /// If defaults_for_omitted_fields is true, calculate the default values from default expression for omitted fields.
+        /// Otherwise fill the missing columns with zero values of its type.
+        if (format_settings.defaults_for_omitted_fields)
+            for (size_t row_idx = 0; row_idx < rows; ++row_idx)
+                for (const auto & column_idx : missing_columns)
+                    block_missing_values.setBit(column_idx, row_idx);
+        return Chunk(std::move(columns), rows);
+    }
+    catch (const parquet::ParquetException & e)
+    {
+        throw ParsingException(ErrorCodes::CANNOT_READ_ALL_DATA, "Error while reading Parquet data: {}", e.what());
+    }
+}
+
+void DirectParquetBlockInputFormat::resetParser()
+{
+    IInputFormat::resetParser();
+
+    file_reader.reset();
+    decoders.clear();
+    column_indices.clear();
+    missing_columns.clear();
+    block_missing_values.clear();
+    next_row_group = 0;
+    row_group_rows_left = 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+#include <config.h>
+#include <Common/Config.h>
+
+#if USE_PARQUET && USE_LOCAL_FORMATS
+// clang-format off
+#include <Formats/FormatSettings.h>
+#include <Processors/Formats/IInputFormat.h>
+// clang-format on
+namespace parquet
+{
+class FileMetaData;
+class ParquetFileReader;
+class SchemaDescriptor;
+}
+
+namespace DB
+{
+class IParquetColumnDecoder;
+
+/// Reads flat Parquet columns with the column readers of ch_parquet and decodes the pages straight into
+/// ColumnVector, ColumnString, ColumnNullable and ColumnLowCardinality, without building arrow arrays first.
+/// Only the row groups in row_group_indices are read.
+class DirectParquetBlockInputFormat : public IInputFormat
+{
+public:
+    DirectParquetBlockInputFormat(
+        ReadBuffer & in_,
+        Block header_,
+        const FormatSettings & format_settings_,
+        std::vector<int> row_group_indices_,
+        std::shared_ptr<parquet::FileMetaData> metadata_ = nullptr);
+    ~DirectParquetBlockInputFormat() override;
+
+    /// Whether all the columns of header can be decoded directly, i.e. they are missing in the file or
+    /// are top-level primitive columns of types that map to the header types without conversion.
+    /// Otherwise the arrow based formats must be used.
+    static bool isSupported(const Block & header, const parquet::SchemaDescriptor & schema, const FormatSettings & format_settings);
+
+    void resetParser() override;
+
+    String getName() const override { return "DirectParquetBlockInputFormat"; }
+
+    const BlockMissingValues & getMissingValues() const override { return block_missing_values; }
+
+private:
+    Chunk generate() override;
+
+    void onCancel() override { is_stopped = 1; }
+
+    void prepareReader();
+    bool nextRowGroup();
+
+    const FormatSettings format_settings;
+    const std::vector<int> row_group_indices;
+    std::shared_ptr<parquet::FileMetaData> metadata;
+
+    std::unique_ptr<parquet::ParquetFileReader> file_reader;
+    /// One decoder per column of the header, nullptr for the columns missing in the file.
+    std::vector<std::unique_ptr<IParquetColumnDecoder>> decoders;
+    std::vector<int> column_indices;
+    std::vector<size_t> missing_columns;
+    BlockMissingValues block_missing_values;
+
+    size_t next_row_group = 0;
+    size_t row_group_rows_left = 0;
+
+    std::atomic<int> is_stopped{0};
+};
+
+}
+
+#endif
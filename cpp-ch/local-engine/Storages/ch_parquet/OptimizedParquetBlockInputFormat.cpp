@@ -108,12 +108,15 @@ static void getFileReaderAndSchema(
     std::unique_ptr<ch_parquet::arrow::FileReader> & file_reader,
     std::shared_ptr<arrow::Schema> & schema,
     const FormatSettings & format_settings,
-    std::atomic<int> & is_stopped)
+    std::atomic<int> & is_stopped,
+    std::shared_ptr<parquet::FileMetaData> metadata = nullptr)
 {
     auto arrow_file = asArrowFile(in, format_settings, is_stopped, "Parquet", PARQUET_MAGIC_BYTES);
     if (is_stopped)
         return;
-    THROW_ARROW_NOT_OK(ch_parquet::arrow::OpenFile(std::move(arrow_file), arrow::default_memory_pool(), &file_reader));
+    ch_parquet::arrow::FileReaderBuilder builder;
+    THROW_ARROW_NOT_OK(builder.Open(std::move(arrow_file), parquet::default_reader_properties(), std::move(metadata)));
+    THROW_ARROW_NOT_OK(builder.memory_pool(arrow::default_memory_pool())->Build(&file_reader));
     THROW_ARROW_NOT_OK(file_reader->GetSchema(&schema));
 
     if (format_settings.use_lowercase_column_name)
@@ -134,7 +137,7 @@ static void getFileReaderAndSchema(
 void OptimizedParquetBlockInputFormat::prepareReader()
 {
     std::shared_ptr<arrow::Schema> schema;
-    getFileReaderAndSchema(*in, file_reader, schema, format_settings, is_stopped);
+    getFileReaderAndSchema(*in, file_reader, schema, format_settings, is_stopped, metadata);
     if (is_stopped)
         return;
 
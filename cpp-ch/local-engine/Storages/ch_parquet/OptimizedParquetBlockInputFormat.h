@@ -18,6 +18,11 @@ namespace arrow
 class Buffer;
 }
 
+namespace parquet
+{
+class FileMetaData;
+}
+
 namespace DB
 {
 class OptimizedArrowColumnToCHColumn;
@@ -53,6 +58,9 @@ protected:
     const FormatSettings format_settings;
 
     std::atomic<int> is_stopped{0};
+
+    /// The parsed footer if the caller already has it, saves parsing it again.
+    std::shared_ptr<parquet::FileMetaData> metadata;
 };
 
 class OptimizedParquetSchemaReader : public ISchemaReader
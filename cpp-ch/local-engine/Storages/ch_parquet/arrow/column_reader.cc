@@ -1199,6 +1199,14 @@ std::shared_ptr<ColumnReader> ColumnReader::Make(const ColumnDescriptor* descr,
     return std::shared_ptr<ColumnReader>(nullptr);
 }
 
+std::shared_ptr<ColumnReader> ColumnReader::MakeWithExposedDictionary(const ColumnDescriptor* descr,
+                                                                      std::unique_ptr<PageReader> pager,
+                                                                      MemoryPool* pool) {
+    auto reader = Make(descr, std::move(pager), pool);
+    reader->SetExposedEncoding(ExposedEncoding::DICTIONARY);
+    return reader;
+}
+
 // ----------------------------------------------------------------------
 // RecordReader
 
@@ -151,6 +151,11 @@ public:
     static std::shared_ptr<ColumnReader>
     Make(const ColumnDescriptor * descr, std::unique_ptr<PageReader> pager, ::arrow::MemoryPool * pool = ::arrow::default_memory_pool());
 
+    // Same as Make, but exposes the dictionary encoding so that ReadBatchWithDictionary can be used.
+    // Only valid for column chunks whose data pages are all dictionary encoded.
+    static std::shared_ptr<ColumnReader> MakeWithExposedDictionary(
+        const ColumnDescriptor * descr, std::unique_ptr<PageReader> pager, ::arrow::MemoryPool * pool = ::arrow::default_memory_pool());
+
     // Returns true if there are still values in this column.
     virtual bool HasNext() = 0;
 
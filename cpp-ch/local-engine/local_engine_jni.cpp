@@ -6,6 +6,7 @@
 #include <Builder/SerializedPlanBuilder.h>
 #include <DataTypes/DataTypeNullable.h>
 #include <Operator/BlockCoalesceOperator.h>
+#include <Parser/CHColumnExporter.h>
 #include <Parser/CHColumnToSparkRow.h>
 #include <Parser/RelParser.h>
 #include <Parser/SerializedPlanParser.h>
@@ -29,6 +30,14 @@
 #include <Common/JNIUtils.h>
 #include <Common/QueryContext.h>
 
+namespace DB
+{
+namespace ErrorCodes
+{
+    extern const int BAD_ARGUMENTS;
+}
+}
+
 #ifdef __cplusplus
 
 static DB::ColumnWithTypeAndName getColumnFromColumnVector(JNIEnv * /*env*/, jobject /*obj*/, jlong block_address, jint column_position)
@@ -127,6 +136,10 @@ JNIEXPORT jint JNI_OnLoad(JavaVM * vm, void * /*reserved*/)
         = local_engine::GetMethodID(env, local_engine::SourceFromJavaIter::serialized_record_batch_iterator_class, "hasNext", "()Z");
     local_engine::SourceFromJavaIter::serialized_record_batch_iterator_next
         = local_engine::GetMethodID(env, local_engine::SourceFromJavaIter::serialized_record_batch_iterator_class, "next", "()[B");
+    local_engine::SourceFromJavaIter::serialized_record_batch_iterator_attachTaskContext = local_engine::GetMethodID(
+        env, local_engine::SourceFromJavaIter::serialized_record_batch_iterator_class, "attachTaskContext", "()V");
+    local_engine::SourceFromJavaIter::serialized_record_batch_iterator_detachTaskContext = local_engine::GetMethodID(
+        env, local_engine::SourceFromJavaIter::serialized_record_batch_iterator_class, "detachTaskContext", "()V");
 
     local_engine::ShuffleReader::input_stream_read = env->GetMethodID(local_engine::ShuffleReader::input_stream_class, "read", "(JJ)J");
 
@@ -318,7 +331,8 @@ JNIEXPORT jobject Java_io_glutenproject_vectorized_BatchIterator_nativeFetchMetr
 {
     LOCAL_ENGINE_JNI_METHOD_START
     local_engine::LocalExecutor * executor = reinterpret_cast<local_engine::LocalExecutor *>(executor_address);
-    String metrics_json = local_engine::RelMetricSerializer::serializeRelMetric(executor->getMetric());
+    auto usage = executor->getResourceUsage();
+    String metrics_json = local_engine::RelMetricSerializer::serializeRelMetric(executor->getMetric(), true, &usage);
     LOG_DEBUG(&Poco::Logger::get("jni"), "{}", metrics_json);
     jobject native_metrics = env->NewObject(native_metrics_class, native_metrics_constructor, stringTojstring(env, metrics_json.c_str()));
     return native_metrics;
@@ -506,6 +520,39 @@ JNIEXPORT jstring Java_io_glutenproject_vectorized_CHColumnVector_nativeGetStrin
     LOCAL_ENGINE_JNI_METHOD_END(env, local_engine::charTojstring(env, ""))
 }
 
+JNIEXPORT jlong Java_io_glutenproject_vectorized_CHColumnVector_nativeCopyRange(
+    JNIEnv * env,
+    jobject obj,
+    jlong block_address,
+    jint column_position,
+    jint row_id,
+    jint num_rows,
+    jlong nulls_address,
+    jlong values_address,
+    jlong values_capacity,
+    jlong offsets_address)
+{
+    LOCAL_ENGINE_JNI_METHOD_START
+    if (row_id < 0 || num_rows < 0 || values_capacity < 0)
+        throw DB::Exception(
+            DB::ErrorCodes::BAD_ARGUMENTS,
+            "Invalid arguments to copy a column range: row_id {}, num_rows {}, values_capacity {}",
+            row_id,
+            num_rows,
+            values_capacity);
+    auto col = getColumnFromColumnVector(env, obj, block_address, column_position);
+    local_engine::CHColumnExporter exporter(col, row_id, num_rows);
+    auto values_bytes = exporter.valuesBytes();
+    /// Tell the caller how much memory is needed instead of writing past its buffer
+    if (values_bytes > static_cast<size_t>(values_capacity))
+        return -static_cast<jlong>(values_bytes);
+    if (nulls_address)
+        exporter.exportNulls(reinterpret_cast<UInt8 *>(nulls_address));
+    exporter.exportValues(reinterpret_cast<char *>(values_address), reinterpret_cast<Int32 *>(offsets_address));
+    return values_bytes;
+    LOCAL_ENGINE_JNI_METHOD_END(env, -1)
+}
+
 // native block
 JNIEXPORT void Java_io_glutenproject_vectorized_CHNativeBlock_nativeClose(JNIEnv * /*env*/, jobject /*obj*/, jlong /*block_address*/)
 {
@@ -676,6 +723,11 @@ JNIEXPORT jlong Java_io_glutenproject_vectorized_CHShuffleSplitterJniWrapper_nat
         .hash_exprs = hash_exprs,
         .out_exprs = out_exprs,
         .compress_method = jstring2string(env, codec)};
+    /// Keep the sort buffer of the sort-based mode to a quarter of the task memory, the spill copies it once more
+    /// and the rest of the task needs memory too.
+    auto task_memory = local_engine::SerializedPlanParser::global_context->getConfigRef().getUInt64("task_offheap_size_in_bytes", 0);
+    if (task_memory)
+        options.sort_buffer_bytes = task_memory / 4;
     local_engine::SplitterHolder * splitter
         = new local_engine::SplitterHolder{.splitter = local_engine::ShuffleSplitter::create(jstring2string(env, short_name), options)};
     return reinterpret_cast<jlong>(splitter);
@@ -923,6 +975,15 @@ Java_io_glutenproject_vectorized_StorageJoinBuilder_nativeCleanBuildHashTable(JN
     LOCAL_ENGINE_JNI_METHOD_END(env, )
 }
 
+JNIEXPORT void
+Java_io_glutenproject_vectorized_StorageJoinBuilder_nativeDropBuildSideCache(JNIEnv * env, jclass, jstring hash_table_id_)
+{
+    LOCAL_ENGINE_JNI_METHOD_START
+    auto hash_table_id = jstring2string(env, hash_table_id_);
+    local_engine::BroadCastJoinBuilder::dropBuildSideCache(hash_table_id);
+    LOCAL_ENGINE_JNI_METHOD_END(env, )
+}
+
 // BlockSplitIterator
 JNIEXPORT jlong Java_io_glutenproject_vectorized_BlockSplitIterator_nativeCreate(
     JNIEnv * env, jobject, jobject in, jstring name, jstring expr, jstring schema, jint partition_num, jint buffer_size)
@@ -1,7 +1,12 @@
 #include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <Builder/SerializedPlanBuilder.h>
+#include <Columns/ColumnString.h>
+#include <Columns/ColumnsNumber.h>
+#include <DataTypes/DataTypeString.h>
+#include <DataTypes/DataTypesNumber.h>
 #include <Functions/FunctionFactory.h>
 #include <Interpreters/Context.h>
 #include <Interpreters/HashJoin.h>
@@ -17,6 +22,7 @@
 #include <Processors/QueryPlan/JoinStep.h>
 #include <Processors/QueryPlan/Optimizations/QueryPlanOptimizationSettings.h>
 #include <QueryPipeline/QueryPipelineBuilder.h>
+#include <Shuffle/SelectorBuilder.h>
 #include <Shuffle/ShuffleReader.h>
 #include <Shuffle/ShuffleSplitter.h>
 #include <Storages/CustomMergeTreeSink.h>
@@ -30,6 +36,7 @@
 #include <Poco/Util/MapConfiguration.h>
 #include <Common/CHUtil.h>
 #include <Common/DebugUtils.h>
+#include <Common/HashTable/Hash.h>
 #include <Common/Logger.h>
 #include <Common/MergeTreeTool.h>
 #include <Common/PODArray_fwd.h>
@@ -372,6 +379,85 @@ DB::ContextMutablePtr global_context;
     }
 }
 
+[[maybe_unused]] static void BM_ShuffleSplitterPartitionNum(benchmark::State & state)
+{
+    /// 1M rows of (Int64, String), hash partitioned by the first column into state.range(0) partitions.
+    /// state.range(1) selects the sort-based mode (1) or the file per partition mode (0).
+    const size_t block_rows = 8192;
+    const size_t num_blocks = 128;
+    auto int64_type = std::make_shared<DB::DataTypeInt64>();
+    auto string_type = std::make_shared<DB::DataTypeString>();
+    std::vector<Block> blocks;
+    blocks.reserve(num_blocks);
+    for (size_t i = 0; i < num_blocks; ++i)
+    {
+        auto key_column = DB::ColumnInt64::create();
+        auto value_column = DB::ColumnString::create();
+        for (size_t row = 0; row < block_rows; ++row)
+        {
+            Int64 key = i * block_rows + row;
+            key_column->insertValue(key);
+            auto value = "value_" + std::to_string(key);
+            value_column->insertData(value.data(), value.size());
+        }
+        blocks.emplace_back(
+            Block({{std::move(key_column), int64_type, "key"}, {std::move(value_column), string_type, "value"}}));
+    }
+
+    const auto root = (std::filesystem::temp_directory_path() / "test_shuffle_partition_num").string();
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::filesystem::create_directories(root);
+        state.ResumeTiming();
+        local_engine::SplitOptions options{
+            .split_size = block_rows,
+            .io_buffer_size = DBMS_DEFAULT_BUFFER_SIZE,
+            .data_file = root + "/data.dat",
+            .local_dirs_list = {root},
+            .num_sub_dirs = 16,
+            .map_id = 1,
+            .partition_nums = static_cast<size_t>(state.range(0)),
+            .hash_exprs = "0",
+            .out_exprs = "0,1",
+            .compress_method = "ZSTD",
+            .sort_based_partition_threshold = state.range(1) ? 0 : std::numeric_limits<size_t>::max()};
+        auto splitter = local_engine::ShuffleSplitter::create("hash", options);
+        for (auto & block : blocks)
+            splitter->split(block);
+        splitter->stop();
+        state.PauseTiming();
+        std::filesystem::remove_all(root);
+        state.ResumeTiming();
+    }
+}
+
+[[maybe_unused]] static void BM_HashPartitionIds(benchmark::State & state)
+{
+    /// hash % state.range(0) of 1M UInt64 hashes, state.range(1) selects the per row get64 loop (0) or the raw data loop (1)
+    const size_t rows = 1024 * 1024;
+    const auto parts_num = static_cast<UInt32>(state.range(0));
+    auto hash_column = DB::ColumnUInt64::create();
+    for (size_t i = 0; i < rows; ++i)
+        hash_column->insertValue(intHash64(i));
+    const DB::IColumn & column = *hash_column;
+
+    DB::IColumn::Selector partition_ids;
+    for (auto _ : state)
+    {
+        if (state.range(1))
+            local_engine::HashSelectorBuilder::computePartitionIds(column, parts_num, partition_ids);
+        else
+        {
+            partition_ids.clear();
+            partition_ids.reserve(rows);
+            for (size_t i = 0; i < rows; ++i)
+                partition_ids.emplace_back(static_cast<UInt64>(column.get64(i) % parts_num));
+        }
+        benchmark::DoNotOptimize(partition_ids.data());
+    }
+}
+
 [[maybe_unused]] static void BM_ShuffleReader(benchmark::State & state)
 {
     for (auto _ : state)
@@ -1488,6 +1574,12 @@ BENCHMARK(BM_ParquetRead)->Unit(benchmark::kMillisecond)->Iterations(10);
 //BENCHMARK(BM_ShuffleSplitter)->Args({2, 0})->Args({2, 1})->Args({2, 2})->Unit(benchmark::kMillisecond)->Iterations(1);
 //BENCHMARK(BM_HashShuffleSplitter)->Args({2, 0})->Args({2, 1})->Args({2, 2})->Unit(benchmark::kMillisecond)->Iterations(1);
 //BENCHMARK(BM_ShuffleReader)->Unit(benchmark::kMillisecond)->Iterations(10);
+// The file per partition mode keeps a file open for every partition, raise `ulimit -n` above 10000 to run it.
+BENCHMARK(BM_ShuffleSplitterPartitionNum)
+    ->ArgsProduct({{200, 2000, 10000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(1);
+BENCHMARK(BM_HashPartitionIds)->ArgsProduct({{200, 256, 2000}, {0, 1}})->Unit(benchmark::kMicrosecond);
 //BENCHMARK(BM_SimpleAggregate)->Arg(150)->Unit(benchmark::kMillisecond)->Iterations(40);
 //BENCHMARK(BM_SIMDFilter)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->Iterations(40);
 //BENCHMARK(BM_NormalFilter)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->Iterations(40);
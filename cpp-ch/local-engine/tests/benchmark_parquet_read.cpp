@@ -1,6 +1,10 @@
+#include <numeric>
 #include <Core/Block.h>
 #include <DataTypes/DataTypeDate32.h>
+#include <DataTypes/DataTypeLowCardinality.h>
+#include <DataTypes/DataTypeNullable.h>
 #include <DataTypes/DataTypeString.h>
+#include <DataTypes/DataTypesNumber.h>
 #include <IO/ReadBufferFromFile.h>
 #include <Parser/SerializedPlanParser.h>
 #include <Processors/Executors/PullingPipelineExecutor.h>
@@ -8,12 +12,16 @@
 #include <Processors/Formats/Impl/ParquetBlockInputFormat.h>
 #include <QueryPipeline/QueryPipeline.h>
 #include <QueryPipeline/QueryPipelineBuilder.h>
+#include <Storages/ArrowParquetBlockInputFormat.h>
 #include <Storages/SubstraitSource/SubstraitFileSource.h>
 #include <Storages/ch_parquet/OptimizedArrowColumnToCHColumn.h>
+#include <Storages/ch_parquet/DirectParquetBlockInputFormat.h>
 #include <Storages/ch_parquet/OptimizedParquetBlockInputFormat.h>
 #include <Storages/ch_parquet/arrow/reader.h>
 #include <benchmark/benchmark.h>
 #include <parquet/arrow/reader.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
 #include <substrait/plan.pb.h>
 #include <Common/DebugUtils.h>
 
@@ -127,7 +135,78 @@ static void BM_OptimizedParquetReadDate32(benchmark::State & state)
     }
 }
 
+/// Decode columns of lineitem through arrow tables (arg 0) or straight into ClickHouse columns (arg 1).
+static void decodeLineitem(benchmark::State & state, const DB::Block & header)
+{
+    using namespace DB;
+    std::string file = "/data1/liyang/cppproject/gluten/jvm/src/test/resources/tpch-data/lineitem/"
+                       "part-00000-d08071cb-0dfa-42dc-9198-83cb334ccda3-c000.snappy.parquet";
+    /// Both paths get the parsed footer, only decoding is measured.
+    std::shared_ptr<parquet::FileMetaData> metadata = parquet::ParquetFileReader::OpenFile(file)->metadata();
+    std::vector<int> row_group_indices(metadata->num_row_groups());
+    std::iota(row_group_indices.begin(), row_group_indices.end(), 0);
+
+    FormatSettings format_settings;
+    format_settings.parquet.allow_missing_columns = true;
+    const bool direct = state.range(0);
+    Block res;
+    for (auto _ : state)
+    {
+        auto in = std::make_unique<ReadBufferFromFile>(file);
+        InputFormatPtr format;
+        if (direct)
+            format = std::make_shared<DirectParquetBlockInputFormat>(*in, header, format_settings, row_group_indices, metadata);
+        else
+            format = std::make_shared<local_engine::ArrowParquetBlockInputFormat>(*in, header, format_settings, row_group_indices, metadata);
+        auto pipeline = QueryPipeline(std::move(format));
+        auto reader = std::make_unique<PullingPipelineExecutor>(pipeline);
+        while (reader->pull(res))
+        {
+        }
+    }
+}
+
+static void BM_ParquetDecodeInt64(benchmark::State & state)
+{
+    using namespace DB;
+    auto type = makeNullable(std::make_shared<DataTypeInt64>());
+    decodeLineitem(state, Block{ColumnWithTypeAndName(type, "l_orderkey"), ColumnWithTypeAndName(type, "l_partkey")});
+}
+
+static void BM_ParquetDecodeFloat64(benchmark::State & state)
+{
+    using namespace DB;
+    auto type = makeNullable(std::make_shared<DataTypeFloat64>());
+    decodeLineitem(state, Block{ColumnWithTypeAndName(type, "l_extendedprice"), ColumnWithTypeAndName(type, "l_discount")});
+}
+
+static void BM_ParquetDecodeDate32(benchmark::State & state)
+{
+    using namespace DB;
+    auto type = makeNullable(std::make_shared<DataTypeDate32>());
+    decodeLineitem(state, Block{ColumnWithTypeAndName(type, "l_shipdate"), ColumnWithTypeAndName(type, "l_commitdate")});
+}
+
+static void BM_ParquetDecodeString(benchmark::State & state)
+{
+    using namespace DB;
+    auto type = makeNullable(std::make_shared<DataTypeString>());
+    decodeLineitem(state, Block{ColumnWithTypeAndName(type, "l_comment"), ColumnWithTypeAndName(type, "l_shipinstruct")});
+}
+
+static void BM_ParquetDecodeLowCardinalityString(benchmark::State & state)
+{
+    using namespace DB;
+    auto type = std::make_shared<DataTypeLowCardinality>(makeNullable(std::make_shared<DataTypeString>()));
+    decodeLineitem(state, Block{ColumnWithTypeAndName(type, "l_returnflag"), ColumnWithTypeAndName(type, "l_shipmode")});
+}
+
 BENCHMARK(BM_ParquetReadString)->Unit(benchmark::kMillisecond)->Iterations(10);
 BENCHMARK(BM_ParquetReadDate32)->Unit(benchmark::kMillisecond)->Iterations(10);
 BENCHMARK(BM_OptimizedParquetReadString)->Unit(benchmark::kMillisecond)->Iterations(10);
 BENCHMARK(BM_OptimizedParquetReadDate32)->Unit(benchmark::kMillisecond)->Iterations(200);
+BENCHMARK(BM_ParquetDecodeInt64)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(10);
+BENCHMARK(BM_ParquetDecodeFloat64)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(10);
+BENCHMARK(BM_ParquetDecodeDate32)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(10);
+BENCHMARK(BM_ParquetDecodeString)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(10);
+BENCHMARK(BM_ParquetDecodeLowCardinalityString)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(10);
@@ -1,6 +1,13 @@
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnsNumber.h>
 #include <Core/Block.h>
+#include <DataTypes/DataTypeArray.h>
 #include <DataTypes/DataTypeFactory.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <DataTypes/DataTypeString.h>
+#include <DataTypes/DataTypesNumber.h>
 #include <IO/ReadBufferFromFile.h>
+#include <Parser/CHColumnExporter.h>
 #include <Parser/CHColumnToSparkRow.h>
 #include <Parser/SparkRowToCHColumn.h>
 #include <Processors/Executors/PullingPipelineExecutor.h>
@@ -8,8 +15,10 @@
 #include <Processors/Formats/Impl/ParquetBlockInputFormat.h>
 #include <QueryPipeline/QueryPipeline.h>
 #include <base/types.h>
+#include <base/unaligned.h>
 #include <benchmark/benchmark.h>
 #include <parquet/arrow/reader.h>
+#include <Common/assert_cast.h>
 
 #include <string>
 #include <vector>
@@ -25,6 +34,8 @@ struct NameType
 
 using NameTypes = std::vector<NameType>;
 
+static constexpr int32_t END_OF_BATCH = -1;
+
 static Block getLineitemHeader(const NameTypes & name_types)
 {
     auto & factory = DataTypeFactory::instance();
@@ -117,5 +128,241 @@ static void BM_SparkRowToCHColumn_Lineitem(benchmark::State & state)
         auto out_block = SparkRowToCHColumn::convertSparkRowInfoToCHColumn(*spark_row_info, header);
 }
 
+/// Native side of reading a block column-wise from Spark, without the JNI crossings themselves:
+/// range(0) == 0 looks up the column and reads one value per call like the CHColumnVector getters,
+/// range(0) == 1 copies every column in one CHColumnExporter call.
+static void BM_CHColumnExport_Lineitem(benchmark::State & state)
+{
+    const NameTypes name_types = {
+        {"l_orderkey", "Nullable(Int64)"},
+        {"l_partkey", "Nullable(Int64)"},
+        {"l_suppkey", "Nullable(Int64)"},
+        {"l_linenumber", "Nullable(Int64)"},
+        {"l_quantity", "Nullable(Float64)"},
+        {"l_extendedprice", "Nullable(Float64)"},
+        {"l_discount", "Nullable(Float64)"},
+        {"l_tax", "Nullable(Float64)"},
+        {"l_returnflag", "Nullable(String)"},
+        {"l_linestatus", "Nullable(String)"},
+        {"l_shipdate", "Nullable(Date32)"},
+        {"l_commitdate", "Nullable(Date32)"},
+        {"l_receiptdate", "Nullable(Date32)"},
+        {"l_shipinstruct", "Nullable(String)"},
+        {"l_shipmode", "Nullable(String)"},
+        {"l_comment", "Nullable(String)"},
+    };
+
+    const Block header = std::move(getLineitemHeader(name_types));
+    const String file = "/data1/liyang/cppproject/gluten/gluten-core/src/test/resources/tpch-data/lineitem/"
+                        "part-00000-d08071cb-0dfa-42dc-9198-83cb334ccda3-c000.snappy.parquet";
+    Block block;
+    readParquetFile(header, file, block);
+
+    const bool bulk = state.range(0);
+    const size_t rows = block.rows();
+    std::vector<UInt8> nulls(rows);
+    std::vector<Int32> offsets(rows + 1);
+    std::vector<char> values;
+    for (auto _ : state)
+    {
+        for (size_t pos = 0; pos < block.columns(); ++pos)
+        {
+            if (bulk)
+            {
+                CHColumnExporter exporter(block.getByPosition(pos), 0, rows);
+                values.resize(exporter.valuesBytes());
+                exporter.exportNulls(nulls.data());
+                exporter.exportValues(values.data(), offsets.data());
+                benchmark::DoNotOptimize(values.data());
+                continue;
+            }
+
+            for (size_t row = 0; row < rows; ++row)
+            {
+                auto col = block.getByPosition(pos);
+                if (col.column->isNullAt(row))
+                    continue;
+                const auto & nested = assert_cast<const ColumnNullable &>(*col.column).getNestedColumn();
+                auto value = nested.getDataAt(row);
+                if (isString(removeNullable(col.type)))
+                {
+                    std::string str = value.toString();
+                    benchmark::DoNotOptimize(str);
+                }
+                else
+                    benchmark::DoNotOptimize(value.data[0]);
+            }
+        }
+    }
+}
+
+/// A block of 8192 rows with a single nested column of the given type, every array or map has 0 to 15 elements.
+static Block getNestedBlock(const String & type_name)
+{
+    auto type = DataTypeFactory::instance().get(type_name);
+    auto column = type->createColumn();
+    const size_t rows = 8192;
+    for (size_t row = 0; row < rows; ++row)
+    {
+        const size_t num_elems = row % 16;
+        if (isMap(type))
+        {
+            Map map(num_elems);
+            for (size_t i = 0; i < num_elems; ++i)
+                map[i] = Tuple{Field("key_" + std::to_string(i)), Field(static_cast<Int64>(row * i))};
+            column->insert(map);
+        }
+        else
+        {
+            const bool is_string = isString(assert_cast<const DataTypeArray &>(*type).getNestedType());
+            Array array(num_elems);
+            for (size_t i = 0; i < num_elems; ++i)
+                array[i] = is_string ? Field("value_" + std::to_string(row + i)) : Field(static_cast<Int32>(row + i));
+            column->insert(array);
+        }
+    }
+    return Block({ColumnWithTypeAndName(std::move(column), type, "c")});
+}
+
+/// A block of 8192 rows with 32 Nullable(String) columns of 16 to 79 bytes, every 10th value is null.
+static Block getWideStringBlock()
+{
+    auto type = makeNullable(std::make_shared<DataTypeString>());
+    const size_t rows = 8192;
+    const size_t columns = 32;
+    ColumnsWithTypeAndName result;
+    for (size_t col = 0; col < columns; ++col)
+    {
+        auto column = type->createColumn();
+        for (size_t row = 0; row < rows; ++row)
+        {
+            if ((row + col) % 10 == 0)
+                column->insertDefault();
+            else
+                column->insert(Field(String(16 + (row * 31 + col) % 64, 'a' + col % 26)));
+        }
+        result.emplace_back(std::move(column), type, "c" + std::to_string(col));
+    }
+    return Block(std::move(result));
+}
+
+/// range(0) == 0 allocates a new buffer for every batch, range(0) == 1 reuses the buffer of the previous batch.
+static void BM_CHColumnToSparkRow_WideStrings(benchmark::State & state)
+{
+    const Block block = getWideStringBlock();
+    CHColumnToSparkRow converter(state.range(0) == 1);
+    for (auto _ : state)
+    {
+        auto spark_row_info = converter.convertCHColumnToSparkRow(block);
+        benchmark::DoNotOptimize(spark_row_info->getBufferAddress());
+        converter.freeMem(spark_row_info->getBufferAddress(), spark_row_info->getTotalBytes());
+    }
+}
+
+/// Lay out the rows like SparkRowIterator.nextBatch does: buffers of about 4KB, each row prefixed by its length
+/// and each buffer ended by -1.
+static std::vector<String> getSparkRowBatches(const SparkRowInfo & spark_row_info)
+{
+    std::vector<String> batches(1);
+    for (int64_t i = 0; i < spark_row_info.getNumRows(); ++i)
+    {
+        const auto length = static_cast<int32_t>(spark_row_info.getLengths()[i]);
+        if (!batches.back().empty() && batches.back().size() + length + 8 > 4096)
+        {
+            batches.back().append(reinterpret_cast<const char *>(&END_OF_BATCH), 4);
+            batches.emplace_back();
+        }
+        batches.back().append(reinterpret_cast<const char *>(&length), 4);
+        batches.back().append(spark_row_info.getBufferAddress() + spark_row_info.getOffsets()[i], length);
+    }
+    batches.back().append(reinterpret_cast<const char *>(&END_OF_BATCH), 4);
+    return batches;
+}
+
+/// Native side of RowToCHNativeColumnarExec over the wide string block plus some fixed-width columns, emitting blocks of 8192 rows:
+/// range(0) == 0 inserts the rows field by field, range(0) == 1 decodes every batch column by column.
+static void BM_SparkRowItrToCHColumn(benchmark::State & state)
+{
+    Block block = getWideStringBlock();
+    const size_t rows = block.rows();
+    auto int_column = ColumnInt64::create(rows);
+    auto float_column = ColumnFloat64::create(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        int_column->getData()[i] = i;
+        float_column->getData()[i] = i * 0.5;
+    }
+    block.insert(ColumnWithTypeAndName(std::move(int_column), std::make_shared<DataTypeInt64>(), "i"));
+    block.insert(ColumnWithTypeAndName(std::move(float_column), std::make_shared<DataTypeFloat64>(), "f"));
+    const Block header = block.cloneEmpty();
+
+    CHColumnToSparkRow converter;
+    auto spark_row_info = converter.convertCHColumnToSparkRow(block);
+    const auto batches = getSparkRowBatches(*spark_row_info);
+    const size_t max_block_rows = 8192;
+
+    for (auto _ : state)
+    {
+        SparkRowToCHColumnHelper helper(header);
+        helper.resetMutableColumns(max_block_rows);
+        SparkRowReader row_reader(helper.data_types);
+        for (const auto & batch : batches)
+        {
+            if (state.range(0) == 0)
+            {
+                const char * pos = batch.data();
+                for (int32_t len = unalignedLoad<int32_t>(pos); len >= 0; len = unalignedLoad<int32_t>(pos))
+                {
+                    row_reader.pointTo(pos + 4, len);
+                    for (size_t i = 0; i < helper.mutable_columns.size(); ++i)
+                        row_reader.insertInto(i, *helper.mutable_columns[i]);
+                    ++helper.rows;
+                    pos += 4 + len;
+                }
+            }
+            else
+                SparkRowToCHColumn::appendSparkRowBatchToCHColumn(helper, batch.data());
+
+            if (helper.rows >= max_block_rows)
+            {
+                std::unique_ptr<Block> out_block(SparkRowToCHColumn::getBlock(helper));
+                benchmark::DoNotOptimize(out_block->rows());
+                helper.resetMutableColumns(max_block_rows);
+            }
+        }
+    }
+    converter.freeMem(spark_row_info->getBufferAddress(), spark_row_info->getTotalBytes());
+}
+
+static const std::vector<String> nested_type_names = {"Array(Int32)", "Array(String)", "Map(String, Int64)"};
+
+/// range(0) picks the type from nested_type_names
+static void BM_CHColumnToSparkRow_Nested(benchmark::State & state)
+{
+    const Block block = getNestedBlock(nested_type_names[state.range(0)]);
+    CHColumnToSparkRow converter;
+    for (auto _ : state)
+    {
+        auto spark_row_info = converter.convertCHColumnToSparkRow(block);
+        converter.freeMem(spark_row_info->getBufferAddress(), spark_row_info->getTotalBytes());
+    }
+}
+
+static void BM_SparkRowToCHColumn_Nested(benchmark::State & state)
+{
+    const Block block = getNestedBlock(nested_type_names[state.range(0)]);
+    CHColumnToSparkRow converter;
+    auto spark_row_info = converter.convertCHColumnToSparkRow(block);
+    const Block header = block.cloneEmpty();
+    for (auto _ : state) [[maybe_unused]]
+        auto out_block = SparkRowToCHColumn::convertSparkRowInfoToCHColumn(*spark_row_info, header);
+    converter.freeMem(spark_row_info->getBufferAddress(), spark_row_info->getTotalBytes());
+}
+
 BENCHMARK(BM_CHColumnToSparkRow_Lineitem)->Unit(benchmark::kMillisecond)->Iterations(10);
 BENCHMARK(BM_SparkRowToCHColumn_Lineitem)->Unit(benchmark::kMillisecond)->Iterations(10);
+BENCHMARK(BM_CHColumnExport_Lineitem)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(10);
+BENCHMARK(BM_CHColumnToSparkRow_WideStrings)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(20);
+BENCHMARK(BM_SparkRowItrToCHColumn)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(20);
+BENCHMARK(BM_CHColumnToSparkRow_Nested)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond)->Iterations(10);
+BENCHMARK(BM_SparkRowToCHColumn_Nested)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond)->Iterations(10);
@@ -0,0 +1,121 @@
+#include <Columns/ColumnConst.h>
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnString.h>
+#include <Columns/ColumnsNumber.h>
+#include <DataTypes/DataTypeDate.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <DataTypes/DataTypeString.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <Parser/CHColumnExporter.h>
+#include <gtest/gtest.h>
+
+using namespace local_engine;
+using namespace DB;
+
+TEST(TestCHColumnExporter, NullableInt64)
+{
+    auto nested = ColumnInt64::create();
+    auto null_map = ColumnUInt8::create();
+    for (Int64 i = 0; i < 10; ++i)
+    {
+        nested->insertValue(i * 100);
+        null_map->insertValue(i % 3 == 0);
+    }
+    ColumnWithTypeAndName column(
+        ColumnNullable::create(std::move(nested), std::move(null_map)), makeNullable(std::make_shared<DataTypeInt64>()), "a");
+
+    CHColumnExporter exporter(column, 2, 5);
+    ASSERT_FALSE(exporter.isString());
+    ASSERT_EQ(exporter.valuesBytes(), 5 * sizeof(Int64));
+
+    std::vector<UInt8> nulls(5);
+    std::vector<Int64> values(5);
+    exporter.exportNulls(nulls.data());
+    exporter.exportValues(reinterpret_cast<char *>(values.data()), nullptr);
+    for (size_t i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(nulls[i], (i + 2) % 3 == 0);
+        ASSERT_EQ(values[i], static_cast<Int64>((i + 2) * 100));
+    }
+}
+
+TEST(TestCHColumnExporter, DateIsWidened)
+{
+    auto data = ColumnUInt16::create();
+    data->insertValue(0);
+    data->insertValue(19000);
+    data->insertValue(65535);
+    ColumnWithTypeAndName column(std::move(data), std::make_shared<DataTypeDate>(), "a");
+
+    CHColumnExporter exporter(column, 0, 3);
+    ASSERT_EQ(exporter.valuesBytes(), 3 * sizeof(Int32));
+
+    std::vector<UInt8> nulls(3, 1);
+    std::vector<Int32> values(3);
+    exporter.exportNulls(nulls.data());
+    exporter.exportValues(reinterpret_cast<char *>(values.data()), nullptr);
+    ASSERT_EQ(nulls, std::vector<UInt8>(3, 0));
+    ASSERT_EQ(values, std::vector<Int32>({0, 19000, 65535}));
+}
+
+TEST(TestCHColumnExporter, String)
+{
+    auto data = ColumnString::create();
+    for (const auto * str : {"spark", "", "clickhouse", "gluten"})
+        data->insertData(str, strlen(str));
+    ColumnWithTypeAndName column(std::move(data), std::make_shared<DataTypeString>(), "a");
+
+    CHColumnExporter exporter(column, 1, 3);
+    ASSERT_TRUE(exporter.isString());
+    ASSERT_EQ(exporter.valuesBytes(), strlen("clickhousegluten"));
+
+    std::string values(exporter.valuesBytes(), '\0');
+    std::vector<Int32> offsets(4);
+    exporter.exportValues(values.data(), offsets.data());
+    ASSERT_EQ(values, "clickhousegluten");
+    ASSERT_EQ(offsets, std::vector<Int32>({0, 0, 10, 16}));
+}
+
+TEST(TestCHColumnExporter, OutOfRange)
+{
+    auto data = ColumnInt32::create();
+    data->insertValue(1);
+    ColumnWithTypeAndName column(std::move(data), std::make_shared<DataTypeInt32>(), "a");
+    ASSERT_THROW(CHColumnExporter(column, 1, 1), DB::Exception);
+    /// A negative row id from java wraps around, and from + length must not overflow past the check
+    ASSERT_THROW(CHColumnExporter(column, static_cast<size_t>(-1), 2), DB::Exception);
+}
+
+TEST(TestCHColumnExporter, ConstNullable)
+{
+    auto int64_type = makeNullable(std::make_shared<DataTypeInt64>());
+    auto string_type = makeNullable(std::make_shared<DataTypeString>());
+
+    /// The materialized columns are only owned by the exporters
+    CHColumnExporter int64_exporter(ColumnWithTypeAndName(int64_type->createColumnConst(4, Field(Int64(42))), int64_type, "a"), 1, 3);
+    CHColumnExporter null_exporter(ColumnWithTypeAndName(int64_type->createColumnConst(4, Field()), int64_type, "b"), 0, 4);
+    CHColumnExporter string_exporter(
+        ColumnWithTypeAndName(string_type->createColumnConst(3, Field(String("gluten"))), string_type, "c"), 0, 3);
+
+    std::vector<UInt8> nulls(3, 1);
+    std::vector<Int64> values(3);
+    int64_exporter.exportNulls(nulls.data());
+    int64_exporter.exportValues(reinterpret_cast<char *>(values.data()), nullptr);
+    ASSERT_EQ(nulls, std::vector<UInt8>(3, 0));
+    ASSERT_EQ(values, std::vector<Int64>(3, 42));
+
+    std::vector<UInt8> all_nulls(4, 0);
+    null_exporter.exportNulls(all_nulls.data());
+    ASSERT_EQ(all_nulls, std::vector<UInt8>(4, 1));
+
+    ASSERT_TRUE(string_exporter.isString());
+    ASSERT_EQ(string_exporter.valuesBytes(), strlen("glutenglutengluten"));
+    std::vector<UInt8> string_nulls(3, 1);
+    std::string string_values(string_exporter.valuesBytes(), '\0');
+    std::vector<Int32> offsets(4);
+    string_exporter.exportNulls(string_nulls.data());
+    string_exporter.exportValues(string_values.data(), offsets.data());
+    ASSERT_EQ(string_nulls, std::vector<UInt8>(3, 0));
+    ASSERT_EQ(string_values, "glutenglutengluten");
+    ASSERT_EQ(offsets, std::vector<Int32>({0, 6, 12, 18}));
+}
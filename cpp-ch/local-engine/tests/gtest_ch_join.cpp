@@ -15,6 +15,11 @@
 #include <Common/DebugUtils.h>
 #include <Common/MergeTreeTool.h>
 
+#include <set>
+#include <DataTypes/DataTypesNumber.h>
+#include <Formats/NativeWriter.h>
+#include <IO/ReadBufferFromString.h>
+#include <IO/WriteBufferFromString.h>
 #include <Interpreters/HashJoin.h>
 #include <Interpreters/TableJoin.h>
 #include <substrait/plan.pb.h>
@@ -228,3 +233,65 @@ TEST(TestJoin, StorageJoinFromReadBufferTest)
     executor.pull(res);
     debug::headBlock(res);
 }
+
+TEST(TestJoin, PartitionedBroadcastJoin)
+{
+    auto global_context = SerializedPlanParser::global_context;
+    auto int_type = std::make_shared<DataTypeInt64>();
+
+    /// Every key of the right side appears twice
+    auto right_key = int_type->createColumn();
+    auto right_value = int_type->createColumn();
+    for (Int64 i = 0; i < 2000; ++i)
+    {
+        right_key->insert(i % 1000);
+        right_value->insert(i);
+    }
+    Block right({ColumnWithTypeAndName(std::move(right_key), int_type, "colD"), ColumnWithTypeAndName(std::move(right_value), int_type, "colC")});
+    std::string buf;
+    WriteBufferFromString write_buf(buf);
+    NativeWriter writer(write_buf, 0, right.cloneEmpty());
+    writer.write(right);
+    write_buf.finalize();
+
+    auto join_rows = [&](size_t build_threads)
+    {
+        StorageJoinFromReadBuffer join_storage(
+            std::make_unique<ReadBufferFromString>(buf),
+            {"colD"},
+            false,
+            {},
+            JoinKind::Inner,
+            JoinStrictness::All,
+            ColumnsDescription(right.getNamesAndTypesList()),
+            {},
+            "test",
+            true,
+            build_threads);
+
+        auto table_join = std::make_shared<TableJoin>(SizeLimits(), false, JoinKind::Inner, JoinStrictness::All, right.getNames());
+        table_join->addJoinedColumn(NameAndTypePair("colD", int_type));
+        table_join->addJoinedColumn(NameAndTypePair("colC", int_type));
+        table_join->addOnKeys(std::make_shared<ASTIdentifier>("colA"), std::make_shared<ASTIdentifier>("colD"));
+        auto join = join_storage.getJoinLocked(table_join, global_context);
+
+        auto left_key = int_type->createColumn();
+        for (Int64 i = 0; i < 1500; ++i)
+            left_key->insert(i);
+        Block block({ColumnWithTypeAndName(std::move(left_key), int_type, "colA")});
+        std::shared_ptr<ExtraBlock> not_processed;
+        join->joinBlock(block, not_processed);
+
+        std::multiset<std::pair<Int64, Int64>> rows;
+        const auto & col_a = *block.getByName("colA").column;
+        const auto & col_c = *block.getByName("colC").column;
+        for (size_t i = 0; i < block.rows(); ++i)
+            rows.emplace(col_a.getInt(i), col_c.getInt(i));
+        return rows;
+    };
+
+    auto expected = join_rows(1);
+    ASSERT_EQ(expected.size(), 2000);
+    ASSERT_EQ(join_rows(4), expected);
+    ASSERT_EQ(join_rows(3), expected);
+}
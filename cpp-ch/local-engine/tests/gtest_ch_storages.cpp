@@ -1,12 +1,29 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <arrow/builder.h>
+#include <arrow/io/file.h>
+#include <arrow/table.h>
+#include <parquet/arrow/writer.h>
+#include <Columns/ColumnsNumber.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <DataTypes/DataTypesNumber.h>
 #include <Functions/FunctionFactory.h>
+#include <IO/ReadBufferFromFile.h>
 #include <Parser/SerializedPlanParser.h>
 #include <Parsers/ASTFunction.h>
 #include <Processors/Executors/PipelineExecutor.h>
 #include <QueryPipeline/QueryPipelineBuilder.h>
 #include <Storages/CustomMergeTreeSink.h>
+#include <Storages/SourceFromJavaIter.h>
+#include <Storages/SubstraitSource/ParquetMetaDataCache.h>
 #include <Storages/SubstraitSource/SubstraitFileSource.h>
 #include <gtest/gtest.h>
 #include <substrait/plan.pb.h>
+#include <Poco/URI.h>
+#include <base/scope_guard.h>
 #include <Common/DebugUtils.h>
 #include <Common/MergeTreeTool.h>
 
@@ -208,6 +225,294 @@ TEST(TestBatchParquetFileSource, local_file)
     ASSERT_TRUE(total_rows == 59986052);
 }
 
+TEST(TestBatchParquetFileSource, PruneRowGroupsByStatistics)
+{
+    /// 4 row groups of 100 rows, holding x in [0, 100), [100, 200), [200, 300) and [300, 400).
+    const String file_path = std::filesystem::temp_directory_path() / "prune_row_groups_by_statistics.parquet";
+    arrow::Int64Builder array_builder;
+    for (Int64 i = 0; i < 400; ++i)
+        ASSERT_TRUE(array_builder.Append(i).ok());
+    std::shared_ptr<arrow::Array> array;
+    ASSERT_TRUE(array_builder.Finish(&array).ok());
+    auto table = arrow::Table::Make(arrow::schema({arrow::field("x", arrow::int64())}), {array});
+    auto out = arrow::io::FileOutputStream::Open(file_path).ValueOrDie();
+    ASSERT_TRUE(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), out, 100).ok());
+    ASSERT_TRUE(out->Close().ok());
+
+    substrait::ReadRel::LocalFiles files;
+    substrait::ReadRel::LocalFiles::FileOrFiles * file = files.add_items();
+    file->set_uri_file("file://" + file_path);
+    file->set_start(0);
+    file->set_length(std::filesystem::file_size(file_path));
+    substrait::ReadRel::LocalFiles::FileOrFiles::ParquetReadOptions parquet_format;
+    file->mutable_parquet()->CopyFrom(parquet_format);
+
+    auto type = std::make_shared<DataTypeNullable>(std::make_shared<DataTypeInt64>());
+    Block header({ColumnWithTypeAndName(type->createColumn(), type, "x")});
+
+    /// x >= 250
+    auto filter_actions_dag = std::make_shared<ActionsDAG>(header.getNamesAndTypesList());
+    const auto & x = filter_actions_dag->findInOutputs("x");
+    auto literal_type = std::make_shared<DataTypeInt64>();
+    const auto & literal = filter_actions_dag->addColumn(
+        ColumnWithTypeAndName(literal_type->createColumnConst(1, static_cast<Int64>(250)), literal_type, "250"));
+    auto greater_or_equals = FunctionFactory::instance().get("greaterOrEquals", SerializedPlanParser::global_context);
+    const auto & filter = filter_actions_dag->addFunction(greater_or_equals, {&x, &literal}, "");
+    filter_actions_dag->addOrReplaceInOutputs(filter);
+    filter_actions_dag->removeUnusedActions(Names{filter.result_name});
+
+    auto source = std::make_shared<SubstraitFileSource>(SerializedPlanParser::global_context, header, files);
+    source->setKeyCondition(filter_actions_dag);
+    auto builder = std::make_unique<QueryPipelineBuilder>();
+    builder->init(Pipe(source));
+    auto pipeline = QueryPipelineBuilder::getPipeline(std::move(*builder));
+    auto executor = PullingPipelineExecutor(pipeline);
+    auto result = header.cloneEmpty();
+    size_t total_rows = 0;
+    while (executor.pull(result))
+        total_rows += result.rows();
+
+    /// The filter itself is not applied, only the first two row groups are skipped.
+    ASSERT_EQ(total_rows, 200);
+    std::filesystem::remove(file_path);
+}
+
+namespace
+{
+/// A local file whose every read takes 2ms, standing in for a remote file system. Counts how many reads overlap.
+class SlowReadBufferFromFile : public ReadBufferFromFilePRead
+{
+public:
+    using ReadBufferFromFilePRead::ReadBufferFromFilePRead;
+
+    static inline std::atomic<size_t> reads_in_flight = 0;
+    static inline std::atomic<size_t> max_reads_in_flight = 0;
+
+protected:
+    bool nextImpl() override
+    {
+        auto in_flight = ++reads_in_flight;
+        SCOPE_EXIT({ --reads_in_flight; });
+        for (auto max = max_reads_in_flight.load(); in_flight > max && !max_reads_in_flight.compare_exchange_weak(max, in_flight);)
+            ;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return ReadBufferFromFilePRead::nextImpl();
+    }
+};
+
+class SlowFileReadBufferBuilder : public ReadBufferBuilder
+{
+public:
+    explicit SlowFileReadBufferBuilder(ContextPtr context_) : ReadBufferBuilder(context_) { }
+
+    std::unique_ptr<ReadBuffer> build(const substrait::ReadRel::LocalFiles::FileOrFiles & file_info, const bool &) override
+    {
+        return std::make_unique<SlowReadBufferFromFile>(Poco::URI(file_info.uri_file()).getPath());
+    }
+};
+
+size_t readAllRows(const Block & header, const substrait::ReadRel::LocalFiles & files)
+{
+    auto builder = std::make_unique<QueryPipelineBuilder>();
+    builder->init(Pipe(std::make_shared<SubstraitFileSource>(SerializedPlanParser::global_context, header, files)));
+    auto pipeline = QueryPipelineBuilder::getPipeline(std::move(*builder));
+    auto executor = PullingPipelineExecutor(pipeline);
+    auto result = header.cloneEmpty();
+    size_t total_rows = 0;
+    while (executor.pull(result))
+        total_rows += result.rows();
+    return total_rows;
+}
+}
+
+TEST(TestBatchParquetFileSource, PrefetchManySmallFiles)
+{
+    /// 64 files of 10 rows, read through a slow read buffer with and without prefetching the next files.
+    const size_t num_files = 64;
+    const auto dir = std::filesystem::temp_directory_path() / "prefetch_many_small_files";
+    std::filesystem::create_directories(dir);
+    auto config = SerializedPlanParser::config;
+    SCOPE_EXIT({
+        config->remove("file_prefetch.max_files");
+        config->remove("file_prefetch.max_bytes");
+        std::filesystem::remove_all(dir);
+    });
+    substrait::ReadRel::LocalFiles files;
+    for (size_t i = 0; i < num_files; ++i)
+    {
+        arrow::Int64Builder array_builder;
+        for (Int64 row = 0; row < 10; ++row)
+            ASSERT_TRUE(array_builder.Append(i * 10 + row).ok());
+        std::shared_ptr<arrow::Array> array;
+        ASSERT_TRUE(array_builder.Finish(&array).ok());
+        auto table = arrow::Table::Make(arrow::schema({arrow::field("x", arrow::int64())}), {array});
+        const String file_path = dir / ("part-" + std::to_string(i) + ".parquet");
+        auto out = arrow::io::FileOutputStream::Open(file_path).ValueOrDie();
+        ASSERT_TRUE(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), out, 10).ok());
+        ASSERT_TRUE(out->Close().ok());
+
+        auto * file = files.add_items();
+        file->set_uri_file("slowfile://" + file_path);
+        file->set_start(0);
+        file->set_length(std::filesystem::file_size(file_path));
+        file->mutable_parquet();
+    }
+    ReadBufferBuilderFactory::instance().registerBuilder(
+        "slowfile", [](ContextPtr context_) { return std::make_shared<SlowFileReadBufferBuilder>(context_); });
+
+    auto type = std::make_shared<DataTypeNullable>(std::make_shared<DataTypeInt64>());
+    Block header({ColumnWithTypeAndName(type->createColumn(), type, "x")});
+
+    config->setUInt64("file_prefetch.max_files", 0);
+    SlowReadBufferFromFile::max_reads_in_flight = 0;
+    ASSERT_EQ(readAllRows(header, files), num_files * 10);
+    ASSERT_EQ(SlowReadBufferFromFile::max_reads_in_flight, 1);
+
+    /// The next files are opened while the current one is read.
+    config->setUInt64("file_prefetch.max_files", 8);
+    SlowReadBufferFromFile::max_reads_in_flight = 0;
+    ASSERT_EQ(readAllRows(header, files), num_files * 10);
+    ASSERT_GT(SlowReadBufferFromFile::max_reads_in_flight, 1);
+
+    /// The byte cap leaves room for about 2 prefetched files at a time.
+    config->setUInt64("file_prefetch.max_bytes", 2 * files.items(0).length());
+    SlowReadBufferFromFile::max_reads_in_flight = 0;
+    ASSERT_EQ(readAllRows(header, files), num_files * 10);
+    ASSERT_LE(SlowReadBufferFromFile::max_reads_in_flight, 3);
+}
+
+TEST(TestBatchParquetFileSource, CacheParquetMetaData)
+{
+    const String file_path = std::filesystem::temp_directory_path() / "cache_parquet_metadata.parquet";
+    auto write_file = [&](Int64 rows)
+    {
+        arrow::Int64Builder array_builder;
+        for (Int64 i = 0; i < rows; ++i)
+            ASSERT_TRUE(array_builder.Append(i).ok());
+        std::shared_ptr<arrow::Array> array;
+        ASSERT_TRUE(array_builder.Finish(&array).ok());
+        auto table = arrow::Table::Make(arrow::schema({arrow::field("x", arrow::int64())}), {array});
+        auto out = arrow::io::FileOutputStream::Open(file_path).ValueOrDie();
+        ASSERT_TRUE(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), out, 100).ok());
+        ASSERT_TRUE(out->Close().ok());
+    };
+
+    substrait::ReadRel::LocalFiles files;
+    auto * file = files.add_items();
+    file->set_uri_file("file://" + file_path);
+    file->set_start(0);
+    file->mutable_parquet();
+    auto type = std::make_shared<DataTypeNullable>(std::make_shared<DataTypeInt64>());
+    Block header({ColumnWithTypeAndName(type->createColumn(), type, "x")});
+
+    auto & cache = ParquetMetaDataCache::instance();
+    cache.init(1 << 20);
+    cache.reset();
+
+    write_file(300);
+    file->set_length(std::filesystem::file_size(file_path));
+    ASSERT_EQ(readAllRows(header, files), 300);
+    ASSERT_EQ(cache.getStats().misses, 1);
+    ASSERT_EQ(readAllRows(header, files), 300);
+    ASSERT_EQ(cache.getStats().hits, 1);
+    ASSERT_EQ(cache.getStats().entries, 1);
+
+    /// A rewritten file doesn't hit the footer of the old one
+    write_file(400);
+    file->set_length(std::filesystem::file_size(file_path));
+    ASSERT_EQ(readAllRows(header, files), 400);
+    ASSERT_EQ(cache.getStats().misses, 2);
+
+    cache.reset();
+    std::filesystem::remove(file_path);
+}
+
+namespace
+{
+/// Stands in for a java iterator over slow shuffle reads: every block of 10 rows takes 10ms to produce.
+SourceFromJavaIter::BlockReader slowBlockReader(const Block & header, std::atomic<size_t> & produced, size_t num_blocks)
+{
+    return [&header, &produced, num_blocks](Block & block)
+    {
+        if (produced >= num_blocks)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        auto column = ColumnInt64::create(10, static_cast<Int64>(produced++));
+        block = header.cloneWithColumns({std::move(column)});
+        return true;
+    };
+}
+
+/// Pull the rows of source, calling process_block for each block, which takes 10ms by default. Stop after max_blocks blocks.
+size_t pullSlowly(
+    std::shared_ptr<SourceFromJavaIter> source,
+    size_t max_blocks = std::numeric_limits<size_t>::max(),
+    std::function<void()> process_block = [] { std::this_thread::sleep_for(std::chrono::milliseconds(10)); })
+{
+    auto builder = std::make_unique<QueryPipelineBuilder>();
+    builder->init(Pipe(std::move(source)));
+    auto pipeline = QueryPipelineBuilder::getPipeline(std::move(*builder));
+    auto executor = PullingPipelineExecutor(pipeline);
+    Block result;
+    size_t total_rows = 0;
+    for (size_t blocks = 0; blocks < max_blocks && executor.pull(result);)
+    {
+        if (!result.rows())
+            continue;
+        total_rows += result.rows();
+        ++blocks;
+        process_block();
+    }
+    return total_rows;
+}
+}
+
+TEST(SourceFromJavaIter, PrefetchSlowProducer)
+{
+    auto type = std::make_shared<DataTypeInt64>();
+    Block header({ColumnWithTypeAndName(type->createColumn(), type, "x")});
+    const size_t num_blocks = 30;
+
+    /// Count the blocks produced while the pulled blocks are being processed
+    std::atomic<size_t> produced = 0;
+    size_t produced_while_processing = 0;
+    auto process_block = [&produced, &produced_while_processing]
+    {
+        size_t before = produced;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        produced_while_processing += produced - before;
+    };
+
+    /// Without prefetch, the producer only runs inside pull()
+    ASSERT_EQ(
+        pullSlowly(std::make_shared<SourceFromJavaIter>(header, slowBlockReader(header, produced, num_blocks)), num_blocks, process_block),
+        num_blocks * 10);
+    ASSERT_EQ(produced_while_processing, 0);
+
+    /// With prefetch, it keeps producing while the consumer processes the blocks
+    produced = 0;
+    ASSERT_EQ(
+        pullSlowly(std::make_shared<SourceFromJavaIter>(header, slowBlockReader(header, produced, num_blocks), 4), num_blocks, process_block),
+        num_blocks * 10);
+    ASSERT_GT(produced_while_processing, 0);
+
+    /// Stopping early cancels the prefetch, which only reads a few blocks beyond the pulled ones
+    produced = 0;
+    ASSERT_EQ(pullSlowly(std::make_shared<SourceFromJavaIter>(header, slowBlockReader(header, produced, 1000), 4), 2), 20);
+    ASSERT_LT(produced, 20);
+
+    /// Errors of the producer are thrown by the source after the blocks read before them
+    size_t calls = 0;
+    auto failing_reader = [&header, &calls](Block & block)
+    {
+        if (++calls > 3)
+            throw std::runtime_error("java iterator failed");
+        block = header.cloneWithColumns({ColumnInt64::create(10, 0)});
+        return true;
+    };
+    ASSERT_ANY_THROW(pullSlowly(std::make_shared<SourceFromJavaIter>(header, failing_reader, 4)));
+}
+
 TEST(TestWrite, MergeTreeWriteTest)
 {
     auto config = local_engine::SerializedPlanParser::config;
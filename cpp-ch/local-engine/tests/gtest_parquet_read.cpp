@@ -2,12 +2,21 @@
 
 #if USE_PARQUET
 
+#include <filesystem>
+#include <numeric>
+#include <arrow/builder.h>
+#include <arrow/io/file.h>
+#include <arrow/table.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
 #include <DataTypes/DataTypeArray.h>
 #include <DataTypes/DataTypeDate.h>
 #include <DataTypes/DataTypeDate32.h>
 #include <DataTypes/DataTypeDateTime.h>
 #include <DataTypes/DataTypeDateTime64.h>
 #include <DataTypes/DataTypeFactory.h>
+#include <DataTypes/DataTypeLowCardinality.h>
 #include <DataTypes/DataTypeMap.h>
 #include <DataTypes/DataTypeNullable.h>
 #include <DataTypes/DataTypeString.h>
@@ -19,6 +28,8 @@
 #include <Processors/Formats/Impl/ArrowColumnToCHColumn.h>
 #include <Processors/Formats/Impl/ParquetBlockInputFormat.h>
 #include <QueryPipeline/QueryPipeline.h>
+#include <Storages/ArrowParquetBlockInputFormat.h>
+#include <Storages/ch_parquet/DirectParquetBlockInputFormat.h>
 #include <Storages/ch_parquet/OptimizedArrowColumnToCHColumn.h>
 #include <Storages/ch_parquet/OptimizedParquetBlockInputFormat.h>
 #include <Storages/ch_parquet/arrow/reader.h>
@@ -297,4 +308,103 @@ TEST(ParquetRead, ReadDataNull)
 #endif
 }
 
+#if USE_LOCAL_FORMATS
+static Block readAll(const String & path, const Block & header, bool direct)
+{
+    auto in = std::make_shared<ReadBufferFromFile>(path);
+    FormatSettings settings;
+    settings.parquet.allow_missing_columns = true;
+    auto metadata = parquet::ParquetFileReader::OpenFile(path)->metadata();
+    std::vector<int> row_group_indices(metadata->num_row_groups());
+    std::iota(row_group_indices.begin(), row_group_indices.end(), 0);
+
+    InputFormatPtr format;
+    if (direct)
+        format = std::make_shared<DirectParquetBlockInputFormat>(*in, header, settings, row_group_indices, metadata);
+    else
+        format = std::make_shared<local_engine::ArrowParquetBlockInputFormat>(*in, header, settings, row_group_indices, metadata);
+    auto pipeline = QueryPipeline(std::move(format));
+    auto reader = std::make_unique<PullingPipelineExecutor>(pipeline);
+
+    auto columns = header.cloneEmptyColumns();
+    Block block;
+    while (reader->pull(block))
+        for (size_t i = 0; i < columns.size(); ++i)
+            columns[i]->insertRangeFrom(*block.getByPosition(i).column, 0, block.rows());
+    return header.cloneWithColumns(std::move(columns));
+}
+
+TEST(ParquetRead, DirectDecodeMatchesArrow)
+{
+    /// Several row groups, nulls in every column, and strings from a small set so that they are dictionary encoded.
+    const String path = std::filesystem::temp_directory_path() / "direct_decode_matches_arrow.parquet";
+    const Int64 rows = 20000;
+    arrow::Int64Builder long_builder;
+    arrow::Int32Builder int_builder;
+    arrow::DoubleBuilder double_builder;
+    arrow::BooleanBuilder bool_builder;
+    arrow::StringBuilder string_builder;
+    for (Int64 i = 0; i < rows; ++i)
+    {
+        bool is_null = i % 7 == 3;
+        ASSERT_TRUE((is_null ? long_builder.AppendNull() : long_builder.Append(i * 1000003)).ok());
+        ASSERT_TRUE((is_null ? int_builder.AppendNull() : int_builder.Append(static_cast<Int32>(i % 100 - 50))).ok());
+        ASSERT_TRUE((is_null ? double_builder.AppendNull() : double_builder.Append(i / 3.0)).ok());
+        ASSERT_TRUE((i % 5 == 1 ? bool_builder.AppendNull() : bool_builder.Append(i % 2)).ok());
+        ASSERT_TRUE((i % 11 == 4 ? string_builder.AppendNull() : string_builder.Append("value_" + std::to_string(i % 13))).ok());
+    }
+    std::vector<std::shared_ptr<arrow::Array>> arrays(5);
+    ASSERT_TRUE(long_builder.Finish(&arrays[0]).ok());
+    ASSERT_TRUE(int_builder.Finish(&arrays[1]).ok());
+    ASSERT_TRUE(double_builder.Finish(&arrays[2]).ok());
+    ASSERT_TRUE(bool_builder.Finish(&arrays[3]).ok());
+    ASSERT_TRUE(string_builder.Finish(&arrays[4]).ok());
+    auto table = arrow::Table::Make(
+        arrow::schema(
+            {arrow::field("f_long", arrow::int64()),
+             arrow::field("f_int", arrow::int32()),
+             arrow::field("f_double", arrow::float64()),
+             arrow::field("f_bool", arrow::boolean()),
+             arrow::field("f_string", arrow::utf8())}),
+        arrays);
+    auto out = arrow::io::FileOutputStream::Open(path).ValueOrDie();
+    ASSERT_TRUE(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), out, 7000).ok());
+    ASSERT_TRUE(out->Close().ok());
+
+    Block header{
+        ColumnWithTypeAndName(makeNullable(std::make_shared<DataTypeInt64>()), "f_long"),
+        ColumnWithTypeAndName(makeNullable(std::make_shared<DataTypeInt32>()), "f_int"),
+        ColumnWithTypeAndName(makeNullable(std::make_shared<DataTypeFloat64>()), "f_double"),
+        ColumnWithTypeAndName(makeNullable(std::make_shared<DataTypeUInt8>()), "f_bool"),
+        ColumnWithTypeAndName(makeNullable(std::make_shared<DataTypeString>()), "f_string"),
+        ColumnWithTypeAndName(makeNullable(std::make_shared<DataTypeInt64>()), "f_missing")};
+    auto file_schema = parquet::ParquetFileReader::OpenFile(path)->metadata()->schema();
+    ASSERT_TRUE(DirectParquetBlockInputFormat::isSupported(header, *file_schema, FormatSettings{}));
+
+    auto expected = readAll(path, header, false);
+    auto direct = readAll(path, header, true);
+    ASSERT_EQ(expected.rows(), rows);
+    ASSERT_EQ(direct.rows(), rows);
+    for (size_t i = 0; i < header.columns(); ++i)
+        for (Int64 row = 0; row < rows; ++row)
+            ASSERT_EQ((*direct.getByPosition(i).column)[row], (*expected.getByPosition(i).column)[row])
+                << header.getByPosition(i).name << " at row " << row;
+
+    /// Dictionary pages are decoded into LowCardinality without materializing the strings per row.
+    auto low_cardinality_type = std::make_shared<DataTypeLowCardinality>(makeNullable(std::make_shared<DataTypeString>()));
+    Block low_cardinality_header{ColumnWithTypeAndName(low_cardinality_type, "f_string")};
+    auto low_cardinality = readAll(path, low_cardinality_header, true);
+    ASSERT_EQ(low_cardinality.rows(), rows);
+    const auto & expected_strings = *expected.getByName("f_string").column;
+    for (Int64 row = 0; row < rows; ++row)
+        ASSERT_EQ((*low_cardinality.getByPosition(0).column)[row], expected_strings[row]) << "at row " << row;
+
+    /// Nested and decimal columns are left to the arrow based formats.
+    Block decimal_header{ColumnWithTypeAndName(std::make_shared<DataTypeDecimal64>(10, 2), "f_long")};
+    ASSERT_FALSE(DirectParquetBlockInputFormat::isSupported(decimal_header, *file_schema, FormatSettings{}));
+
+    std::filesystem::remove(path);
+}
+#endif
+
 #endif
@@ -0,0 +1,50 @@
+#include <random>
+#include <Columns/ColumnsNumber.h>
+#include <Shuffle/SelectorBuilder.h>
+#include <gtest/gtest.h>
+
+using namespace local_engine;
+using namespace DB;
+
+template <typename ColumnType>
+static void checkPartitionIds(const ColumnType & column)
+{
+    for (UInt32 parts_num : {1u, 2u, 7u, 64u, 200u, 1000u, 65537u, 4294967291u})
+    {
+        IColumn::Selector partition_ids;
+        HashSelectorBuilder::computePartitionIds(column, parts_num, partition_ids);
+        ASSERT_EQ(partition_ids.size(), column.size());
+        for (size_t i = 0; i < column.size(); ++i)
+            ASSERT_EQ(partition_ids[i], column.get64(i) % parts_num) << "row " << i << " parts_num " << parts_num;
+    }
+}
+
+TEST(TestHashSelectorBuilder, UInt64PartitionIds)
+{
+    std::mt19937_64 rng(42);
+    auto column = ColumnUInt64::create();
+    for (UInt64 i = 0; i < 16; ++i)
+        column->insertValue(std::numeric_limits<UInt64>::max() - i);
+    for (size_t i = 0; i < 4096; ++i)
+        column->insertValue(rng());
+    checkPartitionIds(*column);
+}
+
+TEST(TestHashSelectorBuilder, Int32PartitionIds)
+{
+    std::mt19937_64 rng(42);
+    auto column = ColumnInt32::create();
+    column->insertValue(std::numeric_limits<Int32>::min());
+    column->insertValue(-1);
+    for (size_t i = 0; i < 4096; ++i)
+        column->insertValue(static_cast<Int32>(rng()));
+    checkPartitionIds(*column);
+}
+
+TEST(TestHashSelectorBuilder, FallbackPartitionIds)
+{
+    auto column = ColumnUInt16::create();
+    for (UInt16 i = 0; i < 1000; ++i)
+        column->insertValue(i * 67);
+    checkPartitionIds(*column);
+}
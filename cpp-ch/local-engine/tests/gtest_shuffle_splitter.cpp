@@ -0,0 +1,116 @@
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <Columns/ColumnString.h>
+#include <Columns/ColumnsNumber.h>
+#include <DataTypes/DataTypeString.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <IO/ReadBufferFromString.h>
+#include <Shuffle/ShuffleReader.h>
+#include <Shuffle/ShuffleSplitter.h>
+#include <gtest/gtest.h>
+#include <base/scope_guard.h>
+
+using namespace local_engine;
+using namespace DB;
+
+using PartitionRows = std::vector<std::pair<Int64, String>>;
+
+static std::vector<Block> buildBlocks(size_t blocks_num, size_t block_rows)
+{
+    auto int64_type = std::make_shared<DataTypeInt64>();
+    auto string_type = std::make_shared<DataTypeString>();
+    std::vector<Block> blocks;
+    for (size_t i = 0; i < blocks_num; ++i)
+    {
+        auto key_column = ColumnInt64::create();
+        auto value_column = ColumnString::create();
+        for (size_t row = 0; row < block_rows; ++row)
+        {
+            Int64 key = i * block_rows + row;
+            key_column->insertValue(key);
+            auto value = "value_" + std::to_string(key);
+            value_column->insertData(value.data(), value.size());
+        }
+        blocks.emplace_back(Block({{std::move(key_column), int64_type, "key"}, {std::move(value_column), string_type, "value"}}));
+    }
+    return blocks;
+}
+
+/// Split the blocks, then read every partition of the data file back through the index file.
+static std::vector<PartitionRows> splitAndReadBack(const std::string & root, SplitOptions options, std::vector<Block> & blocks)
+{
+    std::filesystem::create_directories(root);
+    SCOPE_EXIT({ std::filesystem::remove_all(root); });
+    options.data_file = root + "/data.dat";
+    options.local_dirs_list = {root};
+
+    auto splitter = ShuffleSplitter::create("hash", options);
+    for (auto & block : blocks)
+        splitter->split(block);
+    splitter->stop();
+    splitter->writeIndexFile();
+
+    std::vector<Int64> partition_lengths;
+    std::ifstream index(options.data_file + ".index");
+    for (Int64 length; index >> length;)
+        partition_lengths.push_back(length);
+    EXPECT_EQ(partition_lengths, splitter->getPartitionLength());
+
+    std::ifstream data_file(options.data_file, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(data_file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(std::accumulate(partition_lengths.begin(), partition_lengths.end(), Int64(0)), static_cast<Int64>(data.size()));
+
+    std::vector<PartitionRows> result(partition_lengths.size());
+    size_t offset = 0;
+    for (size_t partition_id = 0; partition_id < partition_lengths.size(); ++partition_id)
+    {
+        auto length = partition_lengths[partition_id];
+        if (!length)
+            continue;
+        ShuffleReader reader(std::make_unique<ReadBufferFromOwnString>(data.substr(offset, length)), true);
+        offset += length;
+        while (true)
+        {
+            const auto * block = reader.read();
+            if (!block->rows())
+                break;
+            const auto & keys = block->getByPosition(0).column;
+            const auto & values = block->getByPosition(1).column;
+            for (size_t row = 0; row < block->rows(); ++row)
+                result[partition_id].emplace_back(keys->getInt(row), values->getDataAt(row).toString());
+        }
+    }
+    return result;
+}
+
+TEST(ShuffleSplitter, SortBasedMatchesPerPartition)
+{
+    auto blocks = buildBlocks(20, 1000);
+    const auto root = (std::filesystem::temp_directory_path() / "test_shuffle_sort_based").string();
+    SplitOptions options{
+        .split_size = 100,
+        .io_buffer_size = DBMS_DEFAULT_BUFFER_SIZE,
+        .num_sub_dirs = 4,
+        .map_id = 1,
+        .partition_nums = 37,
+        .hash_exprs = "0",
+        .out_exprs = "0,1",
+        .compress_method = "ZSTD"};
+
+    options.sort_based_partition_threshold = std::numeric_limits<size_t>::max();
+    auto per_partition = splitAndReadBack(root, options, blocks);
+    size_t rows = 0;
+    for (const auto & partition : per_partition)
+        rows += partition.size();
+    ASSERT_EQ(rows, 20 * 1000);
+
+    /// Spill by rows, then by bytes, so that every partition is merged from several spill files.
+    options.sort_based_partition_threshold = 0;
+    options.sort_buffer_rows = 3000;
+    ASSERT_EQ(splitAndReadBack(root, options, blocks), per_partition);
+
+    options.sort_buffer_rows = std::numeric_limits<size_t>::max();
+    options.sort_buffer_bytes = 1;
+    ASSERT_EQ(splitAndReadBack(root, options, blocks), per_partition);
+}
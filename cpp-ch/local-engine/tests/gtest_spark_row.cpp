@@ -452,3 +452,167 @@ TEST(SparkRow, NullableComplexTypes)
     assertReadConsistentWithWritten(*spark_row_info, *block, type_and_fields);
     EXPECT_TRUE(spark_row_info->getTotalBytes() == 8 + 3 * 8);
 }
+
+TEST(SparkRow, NestedTypesMultipleRows)
+{
+    const auto array_type = std::make_shared<DataTypeArray>(makeNullable(std::make_shared<DataTypeString>()));
+    const auto map_type = std::make_shared<DataTypeMap>(std::make_shared<DataTypeString>(), makeNullable(std::make_shared<DataTypeInt64>()));
+    const auto tuple_type = std::make_shared<DataTypeTuple>(
+        DataTypes{std::make_shared<DataTypeArray>(makeNullable(std::make_shared<DataTypeInt32>())), makeNullable(std::make_shared<DataTypeString>())});
+    const std::vector<std::vector<Field>> rows = {
+        {Array{Field("a long string value"), Null{}, Field("b")}, Map{Tuple{Field("k1"), Int64(1)}, Tuple{Field("k2"), Null{}}},
+         Tuple{Array{Int32(1), Null{}, Int32(3)}, Field("c")}},
+        {Array{}, Map{}, Tuple{Array{}, Null{}}},
+        {Array{Null{}}, Map{Tuple{Field("k3"), Int64(3)}}, Tuple{Array{Null{}, Int32(5)}, Field("d")}},
+    };
+
+    Block block({{array_type, "a"}, {map_type, "b"}, {tuple_type, "c"}});
+    auto columns = block.mutateColumns();
+    for (const auto & row : rows)
+        for (size_t i = 0; i < columns.size(); ++i)
+            columns[i]->insert(row[i]);
+    block.setColumns(std::move(columns));
+
+    /// Lengths calculated from columns must match the ones calculated from fields
+    for (size_t col_idx = 0; col_idx < block.columns(); ++col_idx)
+    {
+        const auto & col = block.getByPosition(col_idx);
+        BackingDataLengthCalculator calculator(col.type);
+        for (size_t row_idx = 0; row_idx < rows.size(); ++row_idx)
+            EXPECT_EQ(calculator.calculate(*col.column, row_idx), calculator.calculate(rows[row_idx][col_idx]));
+    }
+
+    auto converter = CHColumnToSparkRow();
+    auto spark_row_info = converter.convertCHColumnToSparkRow(block);
+    auto out = SparkRowToCHColumn::convertSparkRowInfoToCHColumn(*spark_row_info, block.cloneEmpty());
+    ASSERT_EQ(out->rows(), rows.size());
+
+    SparkRowReader reader(spark_row_info->getDataTypes());
+    for (size_t row_idx = 0; row_idx < rows.size(); ++row_idx)
+    {
+        reader.pointTo(spark_row_info->getBufferAddress() + spark_row_info->getOffsets()[row_idx], spark_row_info->getLengths()[row_idx]);
+        for (size_t col_idx = 0; col_idx < block.columns(); ++col_idx)
+        {
+            EXPECT_TRUE(reader.getField(col_idx) == rows[row_idx][col_idx]);
+            EXPECT_TRUE((*out->getByPosition(col_idx).column)[row_idx] == rows[row_idx][col_idx]);
+        }
+    }
+}
+
+TEST(SparkRow, AppendSparkRowBatches)
+{
+    const DataTypes types = {
+        makeNullable(std::make_shared<DataTypeString>()),
+        std::make_shared<DataTypeInt64>(),
+        makeNullable(std::make_shared<DataTypeDate32>()),
+        makeNullable(std::make_shared<DataTypeDecimal64>(10, 2)),
+        makeNullable(std::make_shared<DataTypeDecimal128>(30, 2)),
+    };
+    const std::vector<std::vector<Field>> rows = {
+        {Field("a long string value"), Int64(-1), getDayNum("2015-06-22"), DecimalField<Decimal64>(-12345, 2), DecimalField<Decimal128>(Decimal128(Int128(67890)), 2)},
+        {Null{}, Int64(2), Null{}, Null{}, Null{}},
+        {Field(""), Int64(3), getDayNum("1970-01-01"), DecimalField<Decimal64>(1, 2), DecimalField<Decimal128>(Decimal128(Int128(-1)), 2)},
+    };
+
+    Block block({{types[0], "a"}, {types[1], "b"}, {types[2], "c"}, {types[3], "d"}, {types[4], "e"}});
+    auto columns = block.mutateColumns();
+    for (const auto & row : rows)
+        for (size_t i = 0; i < columns.size(); ++i)
+            columns[i]->insert(row[i]);
+    block.setColumns(std::move(columns));
+
+    auto converter = CHColumnToSparkRow();
+    auto spark_row_info = converter.convertCHColumnToSparkRow(block);
+
+    /// The first batch holds the first row, the second one the rest, as returned by SparkRowIterator.nextBatch
+    SparkRowToCHColumnHelper helper(block);
+    const int32_t end = -1;
+    for (const auto & [begin, count] : std::vector<std::pair<size_t, size_t>>{{0, 1}, {1, 2}})
+    {
+        String batch;
+        for (size_t i = begin; i < begin + count; ++i)
+        {
+            const auto length = static_cast<int32_t>(spark_row_info->getLengths()[i]);
+            batch.append(reinterpret_cast<const char *>(&length), 4);
+            batch.append(spark_row_info->getBufferAddress() + spark_row_info->getOffsets()[i], length);
+        }
+        batch.append(reinterpret_cast<const char *>(&end), 4);
+        SparkRowToCHColumn::appendSparkRowBatchToCHColumn(helper, batch.data());
+    }
+    EXPECT_EQ(helper.rows, rows.size());
+
+    std::unique_ptr<Block> out(SparkRowToCHColumn::getBlock(helper));
+    ASSERT_EQ(out->rows(), rows.size());
+    for (size_t row_idx = 0; row_idx < rows.size(); ++row_idx)
+        for (size_t col_idx = 0; col_idx < block.columns(); ++col_idx)
+            EXPECT_TRUE((*out->getByPosition(col_idx).column)[row_idx] == rows[row_idx][col_idx]);
+    converter.freeMem(spark_row_info->getBufferAddress(), spark_row_info->getTotalBytes());
+}
+
+TEST(SparkRow, ReusedBufferIsFullyOverwritten)
+{
+    /// Only the fixed-size part of the rows is zeroed up front, the writers must clear the padding, the null bitmaps and
+    /// the null slots of the backing data themselves, whatever a reused buffer held before.
+    const DataTypes types = {
+        makeNullable(std::make_shared<DataTypeString>()),
+        makeNullable(std::make_shared<DataTypeInt8>()),
+        makeNullable(std::make_shared<DataTypeDecimal128>(30, 2)),
+        std::make_shared<DataTypeArray>(makeNullable(std::make_shared<DataTypeInt32>())),
+        std::make_shared<DataTypeArray>(makeNullable(std::make_shared<DataTypeString>())),
+        std::make_shared<DataTypeMap>(std::make_shared<DataTypeString>(), makeNullable(std::make_shared<DataTypeInt64>())),
+        std::make_shared<DataTypeTuple>(DataTypes{
+            makeNullable(std::make_shared<DataTypeInt8>()),
+            makeNullable(std::make_shared<DataTypeString>()),
+            std::make_shared<DataTypeArray>(makeNullable(std::make_shared<DataTypeInt16>()))}),
+    };
+    const std::vector<std::vector<Field>> rows = {
+        {Field("abc"), Int8(-1), DecimalField<Decimal128>(Decimal128(Int128(-12345)), 2), Array{Int32(1), Null{}, Int32(3)},
+         Array{Field("a long string value"), Null{}, Field("b")}, Map{Tuple{Field("k1"), Int64(1)}, Tuple{Field("k2"), Null{}}},
+         Tuple{Int8(7), Field("c"), Array{Int16(1), Null{}, Int16(3)}}},
+        {Null{}, Null{}, Null{}, Array{Null{}}, Array{}, Map{}, Tuple{Null{}, Null{}, Array{}}},
+        {Field("sixteen bytes!!!"), Int8(5), DecimalField<Decimal128>(Decimal128(Int128(1)), 2), Array{Int32(4), Int32(5)},
+         Array{Null{}, Field("seven c")}, Map{Tuple{Field("k3"), Null{}}}, Tuple{Null{}, Field("d"), Array{Null{}}}},
+    };
+
+    Block block;
+    for (size_t i = 0; i < types.size(); ++i)
+        block.insert({types[i], String(1, 'a' + i)});
+    auto columns = block.mutateColumns();
+    for (const auto & row : rows)
+        for (size_t i = 0; i < columns.size(); ++i)
+            columns[i]->insert(row[i]);
+    block.setColumns(std::move(columns));
+
+    /// Convert once into a buffer pre-filled with the given byte, kept from a previous batch of the same size
+    auto convert_into_dirty_buffer = [&block](CHColumnToSparkRow & converter, char fill)
+    {
+        auto first = converter.convertCHColumnToSparkRow(block);
+        memset(first->getBufferAddress(), fill, first->getTotalBytes());
+        char * buffer = first->getBufferAddress();
+        converter.freeMem(first->getBufferAddress(), first->getTotalBytes());
+
+        auto second = converter.convertCHColumnToSparkRow(block);
+        EXPECT_EQ(second->getBufferAddress(), buffer);
+        return second;
+    };
+
+    CHColumnToSparkRow zeroed_converter(true);
+    CHColumnToSparkRow dirty_converter(true);
+    auto zeroed = convert_into_dirty_buffer(zeroed_converter, 0);
+    auto dirty = convert_into_dirty_buffer(dirty_converter, static_cast<char>(0xFF));
+
+    ASSERT_EQ(zeroed->getTotalBytes(), dirty->getTotalBytes());
+    EXPECT_EQ(
+        String(zeroed->getBufferAddress(), zeroed->getTotalBytes()), String(dirty->getBufferAddress(), dirty->getTotalBytes()));
+
+    SparkRowReader reader(dirty->getDataTypes());
+    for (size_t row_idx = 0; row_idx < rows.size(); ++row_idx)
+    {
+        reader.pointTo(dirty->getBufferAddress() + dirty->getOffsets()[row_idx], dirty->getLengths()[row_idx]);
+        for (size_t col_idx = 0; col_idx < block.columns(); ++col_idx)
+            EXPECT_TRUE(reader.getField(col_idx) == rows[row_idx][col_idx]);
+    }
+
+    zeroed_converter.freeMem(zeroed->getBufferAddress(), zeroed->getTotalBytes());
+    dirty_converter.freeMem(dirty->getBufferAddress(), dirty->getTotalBytes());
+}
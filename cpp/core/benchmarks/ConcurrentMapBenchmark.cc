@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "jni/ConcurrentMap.h"
+
+namespace gluten {
+
+// The former handle table, one unordered_map behind one mutex.
+template <typename Holder>
+class GlobalMutexMap {
+ public:
+  jlong insert(Holder holder) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    jlong result = moduleId_++;
+    map_.insert(std::pair<jlong, Holder>(result, holder));
+    return result;
+  }
+
+  void erase(jlong moduleId) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    map_.erase(moduleId);
+  }
+
+  Holder lookup(jlong moduleId) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = map_.find(moduleId);
+    if (it != map_.end()) {
+      return it->second;
+    }
+    return nullptr;
+  }
+
+ private:
+  int64_t moduleId_ = 4;
+  std::mutex mtx_;
+  std::unordered_map<jlong, Holder> map_;
+};
+
+// What every ColumnarBatchOutIterator#next does: publish a batch, Java looks it up a few times, then releases it.
+template <typename Map>
+void BM_HandleInsertLookupErase(benchmark::State& state) {
+  static Map map;
+  auto batch = std::make_shared<int64_t>(state.thread_index());
+  for (auto _ : state) {
+    auto handle = map.insert(batch);
+    for (int i = 0; i < 3; ++i) {
+      benchmark::DoNotOptimize(map.lookup(handle));
+    }
+    map.erase(handle);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_HandleInsertLookupErase, GlobalMutexMap<std::shared_ptr<int64_t>>)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_HandleInsertLookupErase, ConcurrentMap<std::shared_ptr<int64_t>>)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+} // namespace gluten
+
+BENCHMARK_MAIN();
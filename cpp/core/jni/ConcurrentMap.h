@@ -18,63 +18,171 @@
 #pragma once
 
 #include <jni.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace gluten {
 
+namespace internal {
+
+// Shards are handed out to threads round robin, so a task thread inserting and erasing its own
+// handles does not contend with other task threads.
+inline uint32_t currentThreadShard() {
+  static std::atomic<uint32_t> nextShard{0};
+  thread_local uint32_t shard = nextShard.fetch_add(1, std::memory_order_relaxed);
+  return shard;
+}
+
+} // namespace internal
+
 /**
  * An utility class that map module id to module pointers.
+ *
+ * Module ids are 64-bit handles made of a slot index, a shard index and the generation of the slot.
+ * Slots are spread over shards with one mutex each, and a slot's generation is bumped when the slot
+ * is erased. A stale or forged id therefore misses in lookup instead of aliasing a newer object.
  * @tparam Holder class of the object to hold.
  */
 template <typename Holder>
 class ConcurrentMap {
  public:
-  ConcurrentMap() : moduleId_(kInitModuleId) {}
-
   jlong insert(Holder holder) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    jlong result = moduleId_++;
-    map_.insert(std::pair<jlong, Holder>(result, holder));
-    return result;
+    uint32_t shardIdx = internal::currentThreadShard() & (kNumShards - 1);
+    auto& shard = shards_[shardIdx];
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    uint32_t slotIdx;
+    if (!shard.freeSlots.empty()) {
+      slotIdx = shard.freeSlots.back();
+      shard.freeSlots.pop_back();
+    } else {
+      slotIdx = shard.slots.size();
+      shard.slots.emplace_back();
+    }
+    auto& slot = shard.slots[slotIdx];
+    slot.holder = std::move(holder);
+    slot.used = true;
+    shard.size++;
+    return makeModuleId(slot.generation, shardIdx, slotIdx);
   }
 
   void erase(jlong moduleId) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    map_.erase(moduleId);
+    Holder removed;
+    {
+      auto* shard = shardOf(moduleId);
+      if (shard == nullptr) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(shard->mtx);
+      auto* slot = slotOf(*shard, moduleId);
+      if (slot == nullptr) {
+        return;
+      }
+      // destruct the object outside of the lock
+      removed = std::move(slot->holder);
+      release(*shard, *slot, slotIndex(moduleId));
+    }
   }
 
   Holder lookup(jlong moduleId) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    auto it = map_.find(moduleId);
-    if (it != map_.end()) {
-      return it->second;
+    auto* shard = shardOf(moduleId);
+    if (shard == nullptr) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(shard->mtx);
+    auto* slot = slotOf(*shard, moduleId);
+    if (slot != nullptr) {
+      return slot->holder;
     }
     return nullptr;
   }
 
   void clear() {
-    std::lock_guard<std::mutex> lock(mtx_);
-    map_.clear();
+    for (auto& shard : shards_) {
+      std::vector<Holder> removed;
+      std::lock_guard<std::mutex> lock(shard.mtx);
+      for (uint32_t slotIdx = 0; slotIdx < shard.slots.size(); ++slotIdx) {
+        auto& slot = shard.slots[slotIdx];
+        if (slot.used) {
+          removed.push_back(std::move(slot.holder));
+          release(shard, slot, slotIdx);
+        }
+      }
+    }
   }
 
   size_t size() {
-    std::lock_guard<std::mutex> lock(mtx_);
-    return map_.size();
+    size_t result = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mtx);
+      result += shard.size;
+    }
+    return result;
   }
 
  private:
-  // Initialize the module id starting value to a number greater than zero
-  // to allow for easier debugging of uninitialized java variables.
-  static constexpr int kInitModuleId = 4;
+  // | 1 bit unused | 25 bits generation | 6 bits shard | 32 bits slot |
+  static constexpr uint32_t kNumShards = 64;
+  static constexpr int kShardBits = 6;
+  static constexpr int kSlotBits = 32;
+  static constexpr int kGenerationBits = 25;
+  static constexpr uint32_t kGenerationMask = (1U << kGenerationBits) - 1;
+
+  struct Slot {
+    Holder holder{};
+    // Starts at 1 so that no module id is 0, which eases debugging of uninitialized java variables.
+    uint32_t generation = 1;
+    bool used = false;
+  };
 
-  int64_t moduleId_;
-  std::mutex mtx_;
+  struct alignas(64) Shard {
+    std::mutex mtx;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    size_t size = 0;
+  };
+
+  static jlong makeModuleId(uint32_t generation, uint32_t shardIdx, uint32_t slotIdx) {
+    return (static_cast<jlong>(generation) << (kShardBits + kSlotBits)) | (static_cast<jlong>(shardIdx) << kSlotBits) |
+        slotIdx;
+  }
+
+  static uint32_t slotIndex(jlong moduleId) {
+    return static_cast<uint32_t>(moduleId);
+  }
+
+  Shard* shardOf(jlong moduleId) {
+    if (moduleId <= 0) {
+      return nullptr;
+    }
+    return &shards_[(moduleId >> kSlotBits) & (kNumShards - 1)];
+  }
+
+  static Slot* slotOf(Shard& shard, jlong moduleId) {
+    uint32_t slotIdx = slotIndex(moduleId);
+    uint32_t generation = (moduleId >> (kShardBits + kSlotBits)) & kGenerationMask;
+    if (slotIdx >= shard.slots.size()) {
+      return nullptr;
+    }
+    auto& slot = shard.slots[slotIdx];
+    if (!slot.used || slot.generation != generation) {
+      return nullptr;
+    }
+    return &slot;
+  }
+
+  static void release(Shard& shard, Slot& slot, uint32_t slotIdx) {
+    slot.used = false;
+    slot.generation = (slot.generation & kGenerationMask) == kGenerationMask ? 1 : slot.generation + 1;
+    shard.freeSlots.push_back(slotIdx);
+    shard.size--;
+  }
 
-  // map from module ids returned to Java and module pointers
-  std::unordered_map<jlong, Holder> map_;
+  std::array<Shard, kNumShards> shards_;
 };
 
 } // namespace gluten
@@ -128,6 +128,19 @@ static inline void attachCurrentThreadAsDaemonOrThrow(JavaVM* vm, JNIEnv** out)
   }
 }
 
+// Detaches the owning native thread from JVM on destruction. Meant to be a thread_local.
+class JniThreadDetacher {
+ public:
+  explicit JniThreadDetacher(JavaVM* vm) : vm_(vm) {}
+
+  ~JniThreadDetacher() {
+    vm_->DetachCurrentThread();
+  }
+
+ private:
+  JavaVM* vm_;
+};
+
 static inline void checkException(JNIEnv* env) {
   if (env->ExceptionCheck()) {
     jthrowable t = env->ExceptionOccurred();
@@ -221,6 +234,9 @@ class SparkAllocationListener final : public gluten::AllocationListener {
 class RssClient {
  public:
   virtual ~RssClient() = default;
+
+  // May be called from a thread other than the task thread, e.g. the pusher thread of CelebornPartitionWriter.
+  virtual void pushPartitonData(int32_t partitionId, char* bytes, int64_t size) = 0;
 };
 
 class CelebornClient : public RssClient {
@@ -245,14 +261,18 @@ class CelebornClient : public RssClient {
     env->DeleteGlobalRef(javaCelebornShuffleWriter_);
   }
 
-  void pushPartitonData(int32_t partitionId, char* bytes, int64_t size) {
+  void pushPartitonData(int32_t partitionId, char* bytes, int64_t size) override {
     JNIEnv* env;
     if (vm_->GetEnv(reinterpret_cast<void**>(&env), jniVersion) != JNI_OK) {
-      throw gluten::GlutenException("JNIEnv was not attached to current thread");
+      // A native pusher thread, attach it for its lifetime and detach it when it exits.
+      attachCurrentThreadAsDaemonOrThrow(vm_, &env);
+      thread_local JniThreadDetacher detacher(vm_);
     }
     jbyteArray array = env->NewByteArray(size);
     env->SetByteArrayRegion(array, 0, size, reinterpret_cast<jbyte*>(bytes));
     env->CallIntMethod(javaCelebornShuffleWriter_, javaCelebornPushPartitionData_, partitionId, array);
+    // Native threads never return to Java, so the local reference has to be released explicitly.
+    env->DeleteLocalRef(array);
     checkException(env);
   }
 
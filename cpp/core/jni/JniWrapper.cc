@@ -141,9 +141,10 @@ class JavaInputStreamAdaptor final : public arrow::io::InputStream {
   }
 
   arrow::Result<int64_t> Tell() const override {
-    JNIEnv* env;
-    attachCurrentThreadAsDaemonOrThrow(vm_, &env);
-    return env->CallLongMethod(jniIn_, jniByteInputStreamTell);
+    ARROW_ASSIGN_OR_RAISE(auto env, getEnv());
+    auto position = env->CallLongMethod(jniIn_, jniByteInputStreamTell);
+    RETURN_NOT_OK(toStatus(env));
+    return position;
   }
 
   bool closed() const override {
@@ -151,20 +152,45 @@ class JavaInputStreamAdaptor final : public arrow::io::InputStream {
   }
 
   arrow::Result<int64_t> Read(int64_t nbytes, void* out) override {
-    JNIEnv* env;
-    attachCurrentThreadAsDaemonOrThrow(vm_, &env);
-    return env->CallLongMethod(jniIn_, jniByteInputStreamRead, reinterpret_cast<jlong>(out), nbytes);
+    ARROW_ASSIGN_OR_RAISE(auto env, getEnv());
+    auto bytesRead = env->CallLongMethod(jniIn_, jniByteInputStreamRead, reinterpret_cast<jlong>(out), nbytes);
+    // e.g. a FetchFailedException must fail the read rather than look like the end of stream
+    RETURN_NOT_OK(toStatus(env));
+    return bytesRead;
   }
 
   arrow::Result<std::shared_ptr<arrow::Buffer>> Read(int64_t nbytes) override {
-    GLUTEN_ASSIGN_OR_THROW(auto buffer, arrow::AllocateResizableBuffer(nbytes, getDefaultArrowMemoryPool().get()))
-    GLUTEN_ASSIGN_OR_THROW(int64_t bytes_read, Read(nbytes, buffer->mutable_data()));
-    GLUTEN_THROW_NOT_OK(buffer->Resize(bytes_read, false));
+    ARROW_ASSIGN_OR_RAISE(auto buffer, arrow::AllocateResizableBuffer(nbytes, getDefaultArrowMemoryPool().get()))
+    ARROW_ASSIGN_OR_RAISE(int64_t bytes_read, Read(nbytes, buffer->mutable_data()));
+    RETURN_NOT_OK(buffer->Resize(bytes_read, false));
     buffer->ZeroPadding();
     return std::move(buffer);
   }
 
  private:
+  // Attach the calling thread on first use and detach it when it exits. The shuffle reader only reads on the task
+  // thread, so that a fetch failure thrown by the stream is registered with the task's context.
+  arrow::Result<JNIEnv*> getEnv() const {
+    JNIEnv* env;
+    if (vm_->GetEnv(reinterpret_cast<void**>(&env), jniVersion) != JNI_OK) {
+      if (vm_->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(&env), NULL) != JNI_OK) {
+        return arrow::Status::IOError("Failed to attach current thread to JVM.");
+      }
+      thread_local JniThreadDetacher detacher(vm_);
+    }
+    return env;
+  }
+
+  // Clear the pending Java exception if any and return it as an error.
+  static arrow::Status toStatus(JNIEnv* env) {
+    try {
+      checkException(env);
+    } catch (const std::exception& e) {
+      return arrow::Status::IOError(e.what());
+    }
+    return arrow::Status::OK();
+  }
+
   JavaVM* vm_;
   jobject jniIn_;
   bool closed_ = false;
@@ -275,7 +301,7 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved) {
   metricsBuilderClass = createGlobalClassReferenceOrError(env, "Lio/glutenproject/metrics/Metrics;");
 
   metricsBuilderConstructor =
-      getMethodIdOrError(env, metricsBuilderClass, "<init>", "([J[J[J[J[J[J[J[J[J[JJ[J[J[J[J[J[J[J[J[J[J[J[J[J[J[J)V");
+      getMethodIdOrError(env, metricsBuilderClass, "<init>", "([J[J[J[J[J[J[J[J[J[JJJ[J[J[J[J[J[J[J[J[J[J[J[J[J[J[J)V");
 
   serializedArrowArrayIteratorClass =
       createGlobalClassReferenceOrError(env, "Lio/glutenproject/vectorized/ColumnarBatchInIterator;");
@@ -491,6 +517,7 @@ JNIEXPORT jobject JNICALL Java_io_glutenproject_vectorized_ColumnarBatchOutItera
       cpuCount,
       wallNanos,
       metrics ? metrics->veloxToArrow : -1,
+      metrics ? metrics->numCoalescedBatches : 0,
       peakMemoryBytes,
       numMemoryAllocations,
       spilledBytes,
@@ -740,9 +767,11 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleWriterJniWrapper
     jboolean preferEvict,
     jlong allocatorId,
     jboolean writeSchema,
+    jboolean dictionaryEncode,
     jlong firstBatchHandle,
     jlong taskAttemptId,
     jint pushBufferMaxSize,
+    jint pushQueueSize,
     jobject partitionPusher,
     jstring partitionWriterTypeJstr) {
   JNI_METHOD_START
@@ -773,6 +802,7 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleWriterJniWrapper
     gluten::jniThrow("Memory pool does not exist or has been closed");
   }
   shuffleWriterOptions.memory_pool = asWrappedArrowMemoryPool(allocator);
+  shuffleWriterOptions.memory_allocator = allocator;
 
   jclass cls = env->FindClass("java/lang/Thread");
   jmethodID mid = env->GetStaticMethodID(cls, "currentThread", "()Ljava/lang/Thread;");
@@ -804,6 +834,7 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleWriterJniWrapper
     }
 
     shuffleWriterOptions.write_schema = writeSchema;
+    shuffleWriterOptions.dictionary_encode = dictionaryEncode;
     shuffleWriterOptions.prefer_evict = preferEvict;
 
     if (numSubDirs > 0) {
@@ -827,6 +858,9 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleWriterJniWrapper
     if (pushBufferMaxSize > 0) {
       shuffleWriterOptions.push_buffer_max_size = pushBufferMaxSize;
     }
+    if (pushQueueSize >= 0) {
+      shuffleWriterOptions.push_queue_size = pushQueueSize;
+    }
     JavaVM* vm;
     if (env->GetJavaVM(&vm) != JNI_OK) {
       gluten::jniThrow("Unable to get JavaVM instance");
@@ -948,7 +982,10 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleReaderJniWrapper
     jobject,
     jobject jniIn,
     jlong cSchema,
-    jlong allocId) {
+    jlong allocId,
+    jint prefetchDepth,
+    jlong coalesceTargetRows,
+    jlong coalesceTargetBytes) {
   JNI_METHOD_START
   auto* allocator = reinterpret_cast<MemoryAllocator*>(allocId);
   if (allocator == nullptr) {
@@ -959,6 +996,9 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleReaderJniWrapper
   ReaderOptions options = ReaderOptions::defaults();
   options.ipc_read_options.memory_pool = pool.get();
   options.ipc_read_options.use_threads = false;
+  options.prefetch_depth = prefetchDepth;
+  options.coalesce_target_rows = coalesceTargetRows;
+  options.coalesce_target_bytes = coalesceTargetBytes;
   std::shared_ptr<arrow::Schema> schema =
       gluten::jniGetOrThrow(arrow::ImportSchema(reinterpret_cast<struct ArrowSchema*>(cSchema)));
   auto reader = std::make_shared<Reader>(in, schema, options, pool);
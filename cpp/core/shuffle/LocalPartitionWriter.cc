@@ -29,9 +29,15 @@ class LocalPartitionWriter::LocalPartitionWriterInstance {
 
   arrow::Status spill() {
 #ifndef SKIPWRITE
-    RETURN_NOT_OK(ensureOpened());
+    ARROW_ASSIGN_OR_RAISE(auto fileIndex, partitionWriter_->ensureSpilledFileOpened());
+    const auto& spilledFileOs = partitionWriter_->spilled_files_[fileIndex].os;
+    ARROW_ASSIGN_OR_RAISE(auto before_spill, spilledFileOs->Tell());
+    RETURN_NOT_OK(writeRecordBatchPayload(spilledFileOs.get()));
+    ARROW_ASSIGN_OR_RAISE(auto after_spill, spilledFileOs->Tell());
+    if (after_spill > before_spill) {
+      spilledSegments_.push_back({fileIndex, before_spill, after_spill - before_spill});
+    }
 #endif
-    RETURN_NOT_OK(writeRecordBatchPayload(spilledFileOs_.get()));
     clearCache();
     return arrow::Status::OK();
   }
@@ -44,8 +50,7 @@ class LocalPartitionWriter::LocalPartitionWriterInstance {
       RETURN_NOT_OK(writeSchemaPayload(dataFileOs.get()));
     }
 
-    if (spilledFileOpened_) {
-      RETURN_NOT_OK(spilledFileOs_->Close());
+    if (!spilledSegments_.empty()) {
       RETURN_NOT_OK(mergeSpilled());
     } else {
       if (shuffleWriter_->partitionCachedRecordbatchSize()[partitionId_] == 0) {
@@ -69,28 +74,17 @@ class LocalPartitionWriter::LocalPartitionWriterInstance {
   int64_t compress_time = 0;
 
  private:
-  arrow::Status ensureOpened() {
-    if (!spilledFileOpened_) {
-      ARROW_ASSIGN_OR_RAISE(spilledFile_, createTempShuffleFile(partitionWriter_->nextSpilledFileDir()));
-      ARROW_ASSIGN_OR_RAISE(spilledFileOs_, arrow::io::FileOutputStream::Open(spilledFile_, true));
-      spilledFileOpened_ = true;
-    }
-    return arrow::Status::OK();
-  }
-
   arrow::Status mergeSpilled() {
-    ARROW_ASSIGN_OR_RAISE(
-        auto spilled_file_is_, arrow::io::MemoryMappedFile::Open(spilledFile_, arrow::io::FileMode::READ));
-    // copy spilled data blocks
-    ARROW_ASSIGN_OR_RAISE(auto nbytes, spilled_file_is_->GetSize());
-    ARROW_ASSIGN_OR_RAISE(auto buffer, spilled_file_is_->Read(nbytes));
-    RETURN_NOT_OK(partitionWriter_->data_file_os_->Write(buffer));
-
-    // close spilled file streams and delete the file
-    RETURN_NOT_OK(spilled_file_is_->Close());
-    auto fs = std::make_shared<arrow::fs::LocalFileSystem>();
-    RETURN_NOT_OK(fs->DeleteFile(spilledFile_));
-    bytes_spilled += nbytes;
+    // copy spilled data blocks, segments are in spill order. An eviction of this partition
+    // during the merge appends to spilledSegments_, so iterate by index.
+    for (size_t i = 0; i < spilledSegments_.size(); ++i) {
+      const auto segment = spilledSegments_[i];
+      ARROW_ASSIGN_OR_RAISE(auto spilledFileIs, partitionWriter_->openSpilledFileForMerge(segment.fileIndex));
+      ARROW_ASSIGN_OR_RAISE(auto buffer, spilledFileIs->ReadAt(segment.offset, segment.length));
+      RETURN_NOT_OK(partitionWriter_->data_file_os_->Write(buffer));
+      bytes_spilled += segment.length;
+    }
+    spilledSegments_.clear();
     return arrow::Status::OK();
   }
 
@@ -130,10 +124,14 @@ class LocalPartitionWriter::LocalPartitionWriterInstance {
   LocalPartitionWriter* partitionWriter_;
   ShuffleWriter* shuffleWriter_;
   uint32_t partitionId_;
-  std::string spilledFile_;
-  std::shared_ptr<arrow::io::FileOutputStream> spilledFileOs_;
 
-  bool spilledFileOpened_ = false;
+  struct SpilledSegment {
+    int32_t fileIndex;
+    int64_t offset;
+    int64_t length;
+  };
+  // location of each spilled block of this partition in the shared spilled files
+  std::vector<SpilledSegment> spilledSegments_;
 };
 
 arrow::Status LocalPartitionWriter::init() {
@@ -159,15 +157,60 @@ std::string LocalPartitionWriter::nextSpilledFileDir() {
   return spilledFileDir;
 }
 
+arrow::Result<int32_t> LocalPartitionWriter::ensureSpilledFileOpened() {
+  if (spilled_files_.empty() || spilled_files_.back().os == nullptr) {
+    // the current file is already mapped for the merge, later evictions must not touch it
+    SpilledFile file;
+    ARROW_ASSIGN_OR_RAISE(file.path, createTempShuffleFile(nextSpilledFileDir()));
+    ARROW_ASSIGN_OR_RAISE(auto fout, arrow::io::FileOutputStream::Open(file.path));
+    // evicted payloads are small and frequent, buffer them to avoid one syscall per IPC message
+    ARROW_ASSIGN_OR_RAISE(
+        file.os, arrow::io::BufferedOutputStream::Create(16384, shuffleWriter_->options().memory_pool.get(), fout));
+    spilled_files_.push_back(std::move(file));
+  }
+  return static_cast<int32_t>(spilled_files_.size() - 1);
+}
+
+arrow::Result<std::shared_ptr<arrow::io::MemoryMappedFile>> LocalPartitionWriter::openSpilledFileForMerge(
+    int32_t fileIndex) {
+  auto& file = spilled_files_[fileIndex];
+  if (file.is == nullptr) {
+    if (file.os != nullptr) {
+      RETURN_NOT_OK(file.os->Close());
+      file.os.reset();
+    }
+    ARROW_ASSIGN_OR_RAISE(file.is, arrow::io::MemoryMappedFile::Open(file.path, arrow::io::FileMode::READ));
+  }
+  return file.is;
+}
+
+arrow::Status LocalPartitionWriter::closeAndDeleteSpilledFiles() {
+  auto fs = std::make_shared<arrow::fs::LocalFileSystem>();
+  for (auto& file : spilled_files_) {
+    if (file.os != nullptr) {
+      RETURN_NOT_OK(file.os->Close());
+      file.os.reset();
+    }
+    if (file.is != nullptr) {
+      RETURN_NOT_OK(file.is->Close());
+      file.is.reset();
+    }
+    RETURN_NOT_OK(fs->DeleteFile(file.path));
+  }
+  spilled_files_.clear();
+  return arrow::Status::OK();
+}
+
 arrow::Result<std::shared_ptr<arrow::ipc::IpcPayload>> LocalPartitionWriter::getSchemaPayload(
     std::shared_ptr<arrow::Schema> schema) {
   if (schema_payload_ != nullptr) {
     return schema_payload_;
   }
   schema_payload_ = std::make_shared<arrow::ipc::IpcPayload>();
-  arrow::ipc::DictionaryFieldMapper dictFileMapper; // unused
+  // assigns the ids of the dictionary fields, the dictionary batches of the shuffle writer use the same ones
+  arrow::ipc::DictionaryFieldMapper dictFieldMapper(*schema);
   RETURN_NOT_OK(arrow::ipc::GetSchemaPayload(
-      *schema, shuffleWriter_->options().ipc_write_options, dictFileMapper, schema_payload_.get()));
+      *schema, shuffleWriter_->options().ipc_write_options, dictFieldMapper, schema_payload_.get()));
   return schema_payload_;
 }
 
@@ -220,6 +263,7 @@ arrow::Status LocalPartitionWriter::stop() {
   }
   this->schema_payload_.reset();
   shuffleWriter_->partitionBuffer().clear();
+  RETURN_NOT_OK(closeAndDeleteSpilledFiles());
 
   // close data file output Stream
   RETURN_NOT_OK(data_file_os_->Close());
@@ -40,10 +40,25 @@ class LocalPartitionWriter : public ShuffleWriter::PartitionWriter {
 
   std::string nextSpilledFileDir();
 
+  // All evicted partitions are appended to a single spilled file. Each partition
+  // writer instance keeps the (file, offset, length) of its blocks. Once a spilled file
+  // is mapped for the merge, evictions during the merge go to a new spilled file.
+  // Returns the index of the spilled file open for writing.
+  arrow::Result<int32_t> ensureSpilledFileOpened();
+
+  // Close the spilled file if it is still being written, and map it for reading.
+  arrow::Result<std::shared_ptr<arrow::io::MemoryMappedFile>> openSpilledFileForMerge(int32_t fileIndex);
+
+  arrow::Status closeAndDeleteSpilledFiles();
+
   arrow::Result<std::shared_ptr<arrow::ipc::IpcPayload>> getSchemaPayload(std::shared_ptr<arrow::Schema> schema);
 
-  std::string spilled_file_;
-  std::shared_ptr<arrow::io::FileOutputStream> spilled_file_os_;
+  struct SpilledFile {
+    std::string path;
+    std::shared_ptr<arrow::io::OutputStream> os;
+    std::shared_ptr<arrow::io::MemoryMappedFile> is;
+  };
+  std::vector<SpilledFile> spilled_files_;
   std::shared_ptr<arrow::io::OutputStream> data_file_os_;
   // configured local dirs for spilled file
   int32_t dir_selection_ = 0;
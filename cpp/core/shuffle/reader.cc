@@ -16,13 +16,48 @@
  */
 
 #include "reader.h"
+#include "arrow/array/concatenate.h"
+#include "arrow/io/memory.h"
 #include "arrow/ipc/reader.h"
+#include "arrow/ipc/writer.h"
 #include "arrow/record_batch.h"
 
 #include <utility>
 
+#include "shuffle/utils.h"
+
 namespace gluten {
 
+namespace {
+
+arrow::Result<std::unique_ptr<arrow::ipc::Message>> makeSchemaMessage(const arrow::Schema& schema) {
+  ARROW_ASSIGN_OR_RAISE(auto buffer, arrow::ipc::SerializeSchema(schema));
+  arrow::io::BufferReader reader(buffer);
+  return arrow::ipc::ReadMessage(&reader);
+}
+
+} // namespace
+
+class Reader::MessageSource : public arrow::ipc::MessageReader {
+ public:
+  MessageSource(Reader* reader, std::unique_ptr<arrow::ipc::Message> schemaMessage)
+      : reader_(reader), schemaMessage_(std::move(schemaMessage)) {}
+
+  arrow::Result<std::unique_ptr<arrow::ipc::Message>> ReadNextMessage() override {
+    if (schemaMessage_ != nullptr) {
+      return std::move(schemaMessage_);
+    }
+    if (reader_->options_.prefetch_depth > 0) {
+      return reader_->popMessage();
+    }
+    return reader_->readNextMessage();
+  }
+
+ private:
+  Reader* reader_;
+  std::unique_ptr<arrow::ipc::Message> schemaMessage_;
+};
+
 ReaderOptions ReaderOptions::defaults() {
   return {};
 }
@@ -37,31 +72,178 @@ Reader::Reader(
   if (firstMessage_ == nullptr) {
     throw GlutenException("Failed to read message from shuffle.");
   }
+  std::unique_ptr<arrow::ipc::Message> schemaMessage;
   if (firstMessage_->type() == arrow::ipc::MessageType::SCHEMA) {
-    GLUTEN_ASSIGN_OR_THROW(schema_, arrow::ipc::ReadSchema(*firstMessage_, nullptr))
+    schemaMessage = std::move(firstMessage_);
     firstMessageConsumed_ = true;
+  } else {
+    // no schema written to the stream, decode with the given one
+    GLUTEN_ASSIGN_OR_THROW(schemaMessage, makeSchemaMessage(*schema_))
+  }
+  GLUTEN_ASSIGN_OR_THROW(
+      decoder_,
+      arrow::ipc::RecordBatchStreamReader::Open(
+          std::make_unique<MessageSource>(this, std::move(schemaMessage)), options_.ipc_read_options))
+  schema_ = decoder_->schema();
+  if (options_.prefetch_depth > 0) {
+    prefetchThread_ = std::thread([this] { decodeLoop(); });
   }
 }
 
-arrow::Result<std::shared_ptr<ColumnarBatch>> Reader::next() {
-  std::shared_ptr<arrow::RecordBatch> arrowBatch;
-  std::unique_ptr<arrow::ipc::Message> messageToRead;
+Reader::~Reader() {
+  auto status = close();
+  if (!status.ok()) {
+    ARROW_LOG(WARNING) << "Failed to close shuffle reader: " << status.ToString();
+  }
+}
+
+arrow::Result<std::unique_ptr<arrow::ipc::Message>> Reader::readNextMessage() {
   if (!firstMessageConsumed_) {
-    messageToRead = std::move(firstMessage_);
     firstMessageConsumed_ = true;
-  } else {
-    GLUTEN_ASSIGN_OR_THROW(messageToRead, arrow::ipc::ReadMessage(in_.get()))
+    return std::move(firstMessage_);
+  }
+  return arrow::ipc::ReadMessage(in_.get());
+}
+
+arrow::Result<std::unique_ptr<arrow::ipc::Message>> Reader::popMessage() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  messageReady_.wait(lock, [this] { return stopPrefetch_ || !messages_.empty(); });
+  if (stopPrefetch_) {
+    return arrow::Status::Cancelled("Shuffle reader is closed");
+  }
+  auto message = std::move(messages_.front());
+  messages_.pop_front();
+  return message;
+}
+
+void Reader::readAhead() {
+  while (!inputFinished_ && numInFlight_ < options_.prefetch_depth) {
+    arrow::Result<std::unique_ptr<arrow::ipc::Message>> message = readNextMessage();
+    // stop at the end of stream or on the first error, the consumer sees it after the queued batches
+    inputFinished_ = !message.ok() || *message == nullptr;
+    auto isDictionary = !inputFinished_ && (*message)->type() == arrow::ipc::MessageType::DICTIONARY_BATCH;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      messages_.push_back(std::move(message));
+    }
+    if (!isDictionary) {
+      ++numInFlight_;
+    }
+    messageReady_.notify_one();
+  }
+}
+
+void Reader::decodeLoop() {
+  while (true) {
+    arrow::Result<std::shared_ptr<arrow::RecordBatch>> result;
+    try {
+      result = decoder_->Next();
+    } catch (const std::exception& e) {
+      // an exception must not escape the thread, hand it to the consumer as an error
+      result = arrow::Status::UnknownError(e.what());
+    }
+    bool finished = !result.ok() || *result == nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopPrefetch_) {
+        return;
+      }
+      prefetched_.push_back(std::move(result));
+    }
+    batchReady_.notify_one();
+    if (finished) {
+      return;
+    }
+  }
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> Reader::takeNextBatch() {
+  if (pendingBatch_ != nullptr) {
+    return std::move(pendingBatch_);
+  }
+  if (!prefetchThread_.joinable()) {
+    return decoder_->Next();
+  }
+  readAhead();
+  std::unique_lock<std::mutex> lock(mutex_);
+  batchReady_.wait(lock, [this] { return !prefetched_.empty(); });
+  auto result = prefetched_.front();
+  // keep the end of stream or error in the queue so following calls get it again
+  if (result.ok() && *result != nullptr) {
+    prefetched_.pop_front();
+    --numInFlight_;
+  }
+  return result;
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> Reader::concatenate(
+    const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches) {
+  int64_t numRows = 0;
+  for (const auto& batch : batches) {
+    numRows += batch->num_rows();
+  }
+  std::vector<std::shared_ptr<arrow::Array>> columns(schema_->num_fields());
+  for (int i = 0; i < schema_->num_fields(); ++i) {
+    arrow::ArrayVector arrays;
+    arrays.reserve(batches.size());
+    for (const auto& batch : batches) {
+      arrays.push_back(batch->column(i));
+    }
+    ARROW_ASSIGN_OR_RAISE(columns[i], arrow::Concatenate(arrays, pool_.get()));
   }
-  if (messageToRead == nullptr) {
+  return arrow::RecordBatch::Make(schema_, numRows, std::move(columns));
+}
+
+arrow::Result<std::shared_ptr<ColumnarBatch>> Reader::next() {
+  GLUTEN_ASSIGN_OR_THROW(auto arrowBatch, takeNextBatch())
+  if (arrowBatch == nullptr) {
     return nullptr;
   }
-  GLUTEN_ASSIGN_OR_THROW(
-      arrowBatch, arrow::ipc::ReadRecordBatch(*messageToRead, schema_, nullptr, options_.ipc_read_options))
+
+  if (coalesceEnabled()) {
+    int64_t numRows = arrowBatch->num_rows();
+    int64_t numBytes = getBatchNbytes(*arrowBatch);
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches{arrowBatch};
+    while (!reachCoalesceTarget(numRows, numBytes)) {
+      GLUTEN_ASSIGN_OR_THROW(auto nextBatch, takeNextBatch())
+      if (nextBatch == nullptr) {
+        break;
+      }
+      auto nextBytes = getBatchNbytes(*nextBatch);
+      if (reachCoalesceTarget(nextBatch->num_rows(), nextBytes)) {
+        // a large batch is returned as is by the following call
+        pendingBatch_ = std::move(nextBatch);
+        break;
+      }
+      numRows += nextBatch->num_rows();
+      numBytes += nextBytes;
+      batches.push_back(std::move(nextBatch));
+    }
+    if (batches.size() > 1) {
+      GLUTEN_ASSIGN_OR_THROW(arrowBatch, concatenate(batches))
+    }
+  }
+
   std::shared_ptr<ColumnarBatch> glutenBatch = std::make_shared<ArrowColumnarBatch>(arrowBatch);
   return glutenBatch;
 }
 
 arrow::Status Reader::close() {
+  if (closed_) {
+    return arrow::Status::OK();
+  }
+  closed_ = true;
+  if (prefetchThread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopPrefetch_ = true;
+    }
+    messageReady_.notify_all();
+    prefetchThread_.join();
+    messages_.clear();
+    prefetched_.clear();
+  }
+  pendingBatch_.reset();
   return arrow::Status::OK();
 }
 
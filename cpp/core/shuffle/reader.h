@@ -17,6 +17,13 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <arrow/ipc/reader.h>
+
 #include "memory/ColumnarBatch.h"
 #include "type.h"
 
@@ -30,16 +37,67 @@ class Reader {
       ReaderOptions options,
       std::shared_ptr<arrow::MemoryPool> pool);
 
+  ~Reader();
+
   arrow::Result<std::shared_ptr<ColumnarBatch>> next();
   arrow::Status close();
 
  private:
+  // Feeds the messages to decoder_, from the input stream or from the prefetch queue.
+  class MessageSource;
+
+  // Read the next message from the input stream, nullptr at the end of stream.
+  arrow::Result<std::unique_ptr<arrow::ipc::Message>> readNextMessage();
+
+  // Take the next message queued by readAhead(), called by the decoder on the prefetch thread.
+  arrow::Result<std::unique_ptr<arrow::ipc::Message>> popMessage();
+
+  // Take the next decoded record batch, either from the prefetch queue or from the input stream.
+  arrow::Result<std::shared_ptr<arrow::RecordBatch>> takeNextBatch();
+
+  // Read messages on the calling task thread until prefetch_depth of them are queued or decoded.
+  void readAhead();
+
+  void decodeLoop();
+
+  arrow::Result<std::shared_ptr<arrow::RecordBatch>> concatenate(
+      const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches);
+
+  bool coalesceEnabled() const {
+    return options_.coalesce_target_rows > 0 || options_.coalesce_target_bytes > 0;
+  }
+
+  bool reachCoalesceTarget(int64_t numRows, int64_t numBytes) const {
+    return (options_.coalesce_target_rows > 0 && numRows >= options_.coalesce_target_rows) ||
+        (options_.coalesce_target_bytes > 0 && numBytes >= options_.coalesce_target_bytes);
+  }
+
   std::shared_ptr<arrow::MemoryPool> pool_;
   std::shared_ptr<arrow::io::InputStream> in_;
   ReaderOptions options_;
   std::shared_ptr<arrow::Schema> schema_;
   std::unique_ptr<arrow::ipc::Message> firstMessage_;
   bool firstMessageConsumed_ = false;
+  // decodes the record batches, and keeps the dictionaries of the dictionary batches preceding them
+  std::shared_ptr<arrow::ipc::RecordBatchStreamReader> decoder_;
+
+  // batch read ahead while coalescing but too large to be merged with the current ones
+  std::shared_ptr<arrow::RecordBatch> pendingBatch_;
+
+  // prefetch: the input stream is only read on the task thread, because a java stream may need the task's context,
+  // e.g. to register a fetch failure. The background thread decompresses and deserializes the messages in order.
+  std::thread prefetchThread_;
+  std::mutex mutex_;
+  std::condition_variable messageReady_;
+  std::condition_variable batchReady_;
+  std::deque<arrow::Result<std::unique_ptr<arrow::ipc::Message>>> messages_;
+  std::deque<arrow::Result<std::shared_ptr<arrow::RecordBatch>>> prefetched_;
+  bool stopPrefetch_ = false;
+  // accessed by the task thread only. Record batches read ahead and not taken yet, the dictionary batches are
+  // decoded along with the record batch following them
+  int32_t numInFlight_ = 0;
+  bool inputFinished_ = false;
+  bool closed_ = false;
 };
 
 } // namespace gluten
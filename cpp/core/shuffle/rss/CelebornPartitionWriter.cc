@@ -19,7 +19,23 @@
 
 namespace gluten {
 
+CelebornPartitionWriter::~CelebornPartitionWriter() {
+  if (pusherThread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // the task failed or was cancelled, drop what is not pushed yet
+      stopPusher_ = true;
+      pushQueue_.clear();
+    }
+    notEmpty_.notify_one();
+    pusherThread_.join();
+  }
+}
+
 arrow::Status CelebornPartitionWriter::init() {
+  if (shuffleWriter_->options().push_queue_size > 0) {
+    pusherThread_ = std::thread([this] { pushLoop(); });
+  }
   return arrow::Status::OK();
 }
 
@@ -27,20 +43,25 @@ arrow::Status CelebornPartitionWriter::evictPartition(int32_t partitionId) {
   int64_t tempTotalTime = 0;
   TIME_NANO_OR_RAISE(tempTotalTime, writeArrowToOutputStream(partitionId));
   shuffleWriter_->setTotalWriteTime(shuffleWriter_->totalWriteTime() + tempTotalTime);
+  // with a pusher thread this only counts the time the task thread is blocked on a full queue
   TIME_NANO_OR_RAISE(tempTotalTime, pushPartition(partitionId));
   shuffleWriter_->setTotalEvictTime(shuffleWriter_->totalEvictTime() + tempTotalTime);
   return arrow::Status::OK();
 };
 
 arrow::Status CelebornPartitionWriter::pushPartition(int32_t partitionId) {
-  auto buffer = celebornBufferOs_->Finish();
-  int32_t size = buffer->get()->size();
-  char* dst = reinterpret_cast<char*>(buffer->get()->mutable_data());
-  celebornClient_->pushPartitonData(partitionId, dst, size);
+  ARROW_ASSIGN_OR_RAISE(auto buffer, celebornBufferOs_->Finish());
+  celebornBufferOs_.reset();
+  int64_t size = buffer->size();
   shuffleWriter_->partitionCachedRecordbatch()[partitionId].clear();
   shuffleWriter_->setPartitionCachedRecordbatchSize(partitionId, 0);
   shuffleWriter_->setPartitionLengths(partitionId, shuffleWriter_->partitionLengths()[partitionId] + size);
-  return arrow::Status::OK();
+  if (pusherThread_.joinable()) {
+    return enqueuePush(partitionId, std::move(celebornBuffer_));
+  }
+  auto status = pushToClient(partitionId, *buffer);
+  releaseBuffer(std::move(celebornBuffer_));
+  return status;
 };
 
 arrow::Status CelebornPartitionWriter::stop() {
@@ -56,14 +77,14 @@ arrow::Status CelebornPartitionWriter::stop() {
     shuffleWriter_->combineBuffer().reset();
   }
   shuffleWriter_->partitionBuffer().clear();
+  RETURN_NOT_OK(stopPusher());
+  freeBuffers_.clear();
   return arrow::Status::OK();
 };
 
 arrow::Status CelebornPartitionWriter::writeArrowToOutputStream(int32_t partitionId) {
-  ARROW_ASSIGN_OR_RAISE(
-      celebornBufferOs_,
-      arrow::io::BufferOutputStream::Create(
-          shuffleWriter_->options().buffer_size, shuffleWriter_->options().memory_pool.get()));
+  ARROW_ASSIGN_OR_RAISE(celebornBuffer_, acquireBuffer());
+  celebornBufferOs_ = std::make_shared<arrow::io::BufferOutputStream>(celebornBuffer_);
   int32_t metadataLength = 0; // unused
 #ifndef SKIPWRITE
   for (auto& payload : shuffleWriter_->partitionCachedRecordbatch()[partitionId]) {
@@ -75,7 +96,97 @@ arrow::Status CelebornPartitionWriter::writeArrowToOutputStream(int32_t partitio
   return arrow::Status::OK();
 }
 
-CelebornPartitionWriterCreator::CelebornPartitionWriterCreator(std::shared_ptr<CelebornClient> client)
+arrow::Result<std::shared_ptr<arrow::ResizableBuffer>> CelebornPartitionWriter::acquireBuffer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!freeBuffers_.empty()) {
+      auto buffer = std::move(freeBuffers_.back());
+      freeBuffers_.pop_back();
+      return buffer;
+    }
+  }
+  ARROW_ASSIGN_OR_RAISE(
+      std::shared_ptr<arrow::ResizableBuffer> buffer,
+      arrow::AllocateResizableBuffer(
+          shuffleWriter_->options().buffer_size, shuffleWriter_->options().memory_pool.get()));
+  return buffer;
+}
+
+void CelebornPartitionWriter::releaseBuffer(std::shared_ptr<arrow::ResizableBuffer> buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  freeBuffers_.push_back(std::move(buffer));
+}
+
+arrow::Status CelebornPartitionWriter::pushToClient(int32_t partitionId, arrow::Buffer& buffer) {
+  try {
+    celebornClient_->pushPartitonData(partitionId, reinterpret_cast<char*>(buffer.mutable_data()), buffer.size());
+  } catch (const std::exception& e) {
+    return arrow::Status::IOError("Failed to push partition ", partitionId, ": ", e.what());
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status CelebornPartitionWriter::enqueuePush(
+    int32_t partitionId,
+    std::shared_ptr<arrow::ResizableBuffer> buffer) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notFull_.wait(lock, [this] {
+      return !pushStatus_.ok() || pushQueue_.size() < (size_t)shuffleWriter_->options().push_queue_size;
+    });
+    // surface a failed push to the task thread as early as possible
+    RETURN_NOT_OK(pushStatus_);
+    pushQueue_.push_back({partitionId, std::move(buffer)});
+  }
+  notEmpty_.notify_one();
+  return arrow::Status::OK();
+}
+
+void CelebornPartitionWriter::pushLoop() {
+  while (true) {
+    PushRequest request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      notEmpty_.wait(lock, [this] { return stopPusher_ || !pushQueue_.empty(); });
+      // stop only after the queue is drained
+      if (pushQueue_.empty()) {
+        return;
+      }
+      request = std::move(pushQueue_.front());
+      pushQueue_.pop_front();
+    }
+    notFull_.notify_one();
+    auto status = pushToClient(request.partitionId, *request.buffer);
+    bool failed = !status.ok();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      freeBuffers_.push_back(std::move(request.buffer));
+      if (failed) {
+        pushStatus_ = std::move(status);
+        pushQueue_.clear();
+      }
+    }
+    if (failed) {
+      notFull_.notify_all();
+      return;
+    }
+  }
+}
+
+arrow::Status CelebornPartitionWriter::stopPusher() {
+  if (!pusherThread_.joinable()) {
+    return arrow::Status::OK();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopPusher_ = true;
+  }
+  notEmpty_.notify_one();
+  pusherThread_.join();
+  return pushStatus_;
+}
+
+CelebornPartitionWriterCreator::CelebornPartitionWriterCreator(std::shared_ptr<RssClient> client)
     : PartitionWriterCreator(), client_(client) {}
 
 arrow::Result<std::shared_ptr<ShuffleWriter::PartitionWriter>> CelebornPartitionWriterCreator::make(
@@ -19,6 +19,11 @@
 
 #include <arrow/io/api.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "shuffle/rss/RemotePartitionWriter.h"
 #include "shuffle/type.h"
 
@@ -30,11 +35,13 @@ namespace gluten {
 
 class CelebornPartitionWriter : public RemotePartitionWriter {
  public:
-  CelebornPartitionWriter(ShuffleWriter* shuffleWriter, std::shared_ptr<CelebornClient> celebornClient)
+  CelebornPartitionWriter(ShuffleWriter* shuffleWriter, std::shared_ptr<RssClient> celebornClient)
       : RemotePartitionWriter(shuffleWriter) {
     celebornClient_ = celebornClient;
   }
 
+  ~CelebornPartitionWriter() override;
+
   arrow::Status init() override;
 
   arrow::Status evictPartition(int32_t partitionId) override;
@@ -47,17 +54,50 @@ class CelebornPartitionWriter : public RemotePartitionWriter {
 
   std::shared_ptr<arrow::io::BufferOutputStream> celebornBufferOs_;
 
-  std::shared_ptr<CelebornClient> celebornClient_;
+  std::shared_ptr<RssClient> celebornClient_;
+
+ private:
+  struct PushRequest {
+    int32_t partitionId;
+    std::shared_ptr<arrow::ResizableBuffer> buffer;
+  };
+
+  // Take a serialized buffer released by a finished push, or allocate a new one.
+  arrow::Result<std::shared_ptr<arrow::ResizableBuffer>> acquireBuffer();
+
+  void releaseBuffer(std::shared_ptr<arrow::ResizableBuffer> buffer);
+
+  arrow::Status pushToClient(int32_t partitionId, arrow::Buffer& buffer);
+
+  // Hand the buffer over to the pusher thread, blocks while the push queue is full.
+  arrow::Status enqueuePush(int32_t partitionId, std::shared_ptr<arrow::ResizableBuffer> buffer);
+
+  void pushLoop();
+
+  // Wait until all queued buffers are pushed, returns the first push error.
+  arrow::Status stopPusher();
+
+  std::shared_ptr<arrow::ResizableBuffer> celebornBuffer_;
+
+  // background push
+  std::thread pusherThread_;
+  std::mutex mutex_;
+  std::condition_variable notEmpty_;
+  std::condition_variable notFull_;
+  std::deque<PushRequest> pushQueue_;
+  std::vector<std::shared_ptr<arrow::ResizableBuffer>> freeBuffers_;
+  arrow::Status pushStatus_;
+  bool stopPusher_ = false;
 };
 
 class CelebornPartitionWriterCreator : public ShuffleWriter::PartitionWriterCreator {
  public:
-  explicit CelebornPartitionWriterCreator(std::shared_ptr<CelebornClient> client);
+  explicit CelebornPartitionWriterCreator(std::shared_ptr<RssClient> client);
 
   arrow::Result<std::shared_ptr<ShuffleWriter::PartitionWriter>> make(ShuffleWriter* shuffleWriter) override;
 
  private:
-  std::shared_ptr<CelebornClient> client_;
+  std::shared_ptr<RssClient> client_;
 };
 
 } // namespace gluten
@@ -33,6 +33,7 @@ namespace gluten {
 static constexpr int32_t kDefaultShuffleWriterBufferSize = 4096;
 static constexpr int32_t kDefaultNumSubDirs = 64;
 static constexpr int32_t kDefaultBatchCompressThreshold = 256;
+static constexpr int32_t kDefaultPushQueueSize = 0;
 
 // This 0xFFFFFFFF value is the first 4 bytes of a valid IPC message
 static constexpr int32_t kIpcContinuationToken = -1;
@@ -42,6 +43,13 @@ const unsigned kOnes[] = {1, 1, 1, 1, 1, 1, 1, 1};
 struct ReaderOptions {
   arrow::ipc::IpcReadOptions ipc_read_options = arrow::ipc::IpcReadOptions::Defaults();
 
+  // number of record batches decoded ahead on a background thread, 0 to read synchronously. The input stream itself
+  // is always read on the calling thread.
+  int32_t prefetch_depth = 0;
+  // consecutive small record batches are merged until the row or byte target is reached, 0 to disable
+  int64_t coalesce_target_rows = 0;
+  int64_t coalesce_target_bytes = 0;
+
   static ReaderOptions defaults();
 };
 
@@ -49,6 +57,9 @@ struct ShuffleWriterOptions {
   int64_t offheap_per_task = 0;
   int32_t buffer_size = kDefaultShuffleWriterBufferSize;
   int32_t push_buffer_max_size = kDefaultShuffleWriterBufferSize;
+  // number of serialized partition buffers queued for the background pusher of the rss partition writer,
+  // 0 to push synchronously on the task thread
+  int32_t push_queue_size = kDefaultPushQueueSize;
   int32_t num_sub_dirs = kDefaultNumSubDirs;
   int32_t batch_compress_threshold = kDefaultBatchCompressThreshold;
   arrow::Compression::type compression_type = arrow::Compression::UNCOMPRESSED;
@@ -56,6 +67,10 @@ struct ShuffleWriterOptions {
   bool prefer_evict = true;
   bool write_schema = true;
   bool buffered_write = false;
+  // split the string columns which arrive dictionary-encoded through their indices, and write the dictionary of
+  // every record batch as an IPC dictionary batch. Needs write_schema, the reader takes the dictionary fields
+  // from the schema in the stream
+  bool dictionary_encode = false;
 
   std::string data_file;
   std::string partition_writer_type = "local";
@@ -64,6 +79,9 @@ struct ShuffleWriterOptions {
   int64_t task_attempt_id = -1;
 
   std::shared_ptr<arrow::MemoryPool> memory_pool = getDefaultArrowMemoryPool();
+  // the allocator memory_pool wraps, if any. Backends allocate their own vectors from it so that
+  // the buffered data is accounted to the task
+  MemoryAllocator* memory_allocator = nullptr;
 
   arrow::ipc::IpcWriteOptions ipc_write_options = arrow::ipc::IpcWriteOptions::Defaults();
 
@@ -22,6 +22,7 @@
 #include <arrow/filesystem/localfs.h>
 #include <arrow/filesystem/path_util.h>
 #include <arrow/ipc/writer.h>
+#include <arrow/record_batch.h>
 #include <arrow/type.h>
 #include <arrow/util/io_util.h>
 
@@ -163,4 +164,21 @@ static inline int64_t getBufferSizes(const std::shared_ptr<arrow::Array>& array)
       });
 }
 
+static inline int64_t getBatchNbytes(const arrow::RecordBatch& rb) {
+  int64_t accumulated = 0L;
+
+  for (const auto& array : rb.columns()) {
+    if (array == nullptr || array->data() == nullptr) {
+      continue;
+    }
+    for (const auto& buf : array->data()->buffers) {
+      if (buf == nullptr) {
+        continue;
+      }
+      accumulated += buf->size();
+    }
+  }
+  return accumulated;
+}
+
 } // namespace gluten
@@ -0,0 +1,170 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/c/bridge.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/record_batch.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "memory/ColumnarBatch.h"
+#include "shuffle/ArrowShuffleWriter.h"
+#include "shuffle/rss/CelebornPartitionWriter.h"
+#include "utils/TestUtils.h"
+
+namespace gluten {
+
+// In-process stand-in for the Celeborn client, collects the pushed bytes per partition.
+class FakeRssClient : public RssClient {
+ public:
+  FakeRssClient(int32_t numPartitions, std::chrono::milliseconds latency, bool fail = false)
+      : latency_(latency), fail_(fail), pushed_(numPartitions) {}
+
+  void pushPartitonData(int32_t partitionId, char* bytes, int64_t size) override {
+    std::this_thread::sleep_for(latency_);
+    if (fail_) {
+      throw GlutenException("Fake push failure");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    pushed_[partitionId].append(bytes, size);
+    if (std::this_thread::get_id() != callerThreadId_) {
+      pushedFromOtherThread_ = true;
+    }
+  }
+
+  const std::string& pushed(int32_t partitionId) const {
+    return pushed_[partitionId];
+  }
+
+  bool pushedFromOtherThread() const {
+    return pushedFromOtherThread_;
+  }
+
+ private:
+  std::chrono::milliseconds latency_;
+  bool fail_;
+  std::thread::id callerThreadId_ = std::this_thread::get_id();
+  std::mutex mutex_;
+  std::vector<std::string> pushed_;
+  bool pushedFromOtherThread_ = false;
+};
+
+class CelebornPartitionWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    schema_ = arrow::schema(
+        {arrow::field("f_int32", arrow::int32()),
+         arrow::field("f_double", arrow::float64()),
+         arrow::field("f_string", arrow::utf8())});
+    makeInputBatch(
+        {"[1, 2, 3, null, 4, null, 5, 6, null, 7]",
+         R"([-0.1234567, null, 0.1234567, null, -0.142857, null, 0.142857, 0.285714, 0.428617, null])",
+         R"(["alice0", "bob1", "alice2", "bob3", "Alice4", "Bob5", "AlicE6", "boB7", "ALICE8", "BOB9"])"},
+        schema_,
+        &inputBatch_);
+    options_ = ShuffleWriterOptions::defaults();
+    options_.buffer_size = 4;
+    options_.partitioning_name = "rr";
+    options_.partition_writer_type = "celeborn";
+  }
+
+  std::shared_ptr<ColumnarBatch> toColumnarBatch(const std::shared_ptr<arrow::RecordBatch>& rb) {
+    std::unique_ptr<ArrowSchema> cSchema = std::make_unique<ArrowSchema>();
+    std::unique_ptr<ArrowArray> cArray = std::make_unique<ArrowArray>();
+    GLUTEN_THROW_NOT_OK(arrow::ExportRecordBatch(*rb, cArray.get(), cSchema.get()));
+    return std::make_shared<ArrowCStructColumnarBatch>(std::move(cSchema), std::move(cArray));
+  }
+
+  arrow::Status writeBatches(const std::shared_ptr<RssClient>& client, int32_t numBatches) {
+    auto creator = std::make_shared<CelebornPartitionWriterCreator>(client);
+    ARROW_ASSIGN_OR_RAISE(shuffleWriter_, ArrowShuffleWriter::create(kNumPartitions, creator, options_));
+    for (auto i = 0; i < numBatches; ++i) {
+      RETURN_NOT_OK(shuffleWriter_->split(toColumnarBatch(inputBatch_).get()));
+    }
+    return shuffleWriter_->stop();
+  }
+
+  // Decode the IPC record batch messages pushed for one partition.
+  arrow::Result<int64_t> countPushedRows(const std::string& pushed) {
+    auto in = std::make_shared<arrow::io::BufferReader>(arrow::Buffer::FromString(pushed));
+    int64_t numRows = 0;
+    while (true) {
+      ARROW_ASSIGN_OR_RAISE(auto message, arrow::ipc::ReadMessage(in.get()));
+      if (message == nullptr) {
+        break;
+      }
+      if (message->type() != arrow::ipc::MessageType::RECORD_BATCH) {
+        continue;
+      }
+      ARROW_ASSIGN_OR_RAISE(auto rb, arrow::ipc::ReadRecordBatch(*message, schema_, nullptr, {}));
+      numRows += rb->num_rows();
+    }
+    return numRows;
+  }
+
+  static constexpr int32_t kNumPartitions = 4;
+  static constexpr int32_t kNumBatches = 20;
+
+  std::shared_ptr<arrow::Schema> schema_;
+  std::shared_ptr<arrow::RecordBatch> inputBatch_;
+  ShuffleWriterOptions options_;
+  std::shared_ptr<ArrowShuffleWriter> shuffleWriter_;
+};
+
+TEST_F(CelebornPartitionWriterTest, TestAsyncPush) {
+  options_.push_queue_size = 1;
+  auto client = std::make_shared<FakeRssClient>(kNumPartitions, std::chrono::milliseconds(5));
+  ASSERT_NOT_OK(writeBatches(client, kNumBatches));
+  ASSERT_TRUE(client->pushedFromOtherThread());
+
+  int64_t numRows = 0;
+  const auto& lengths = shuffleWriter_->partitionLengths();
+  for (auto pid = 0; pid < kNumPartitions; ++pid) {
+    ASSERT_EQ(lengths[pid], (int64_t)client->pushed(pid).size());
+    ARROW_ASSIGN_OR_THROW(auto partitionRows, countPushedRows(client->pushed(pid)));
+    numRows += partitionRows;
+  }
+  ASSERT_EQ(numRows, kNumBatches * inputBatch_->num_rows());
+}
+
+TEST_F(CelebornPartitionWriterTest, TestAsyncPushMatchesSyncPush) {
+  // the push queue is off by default
+  auto syncClient = std::make_shared<FakeRssClient>(kNumPartitions, std::chrono::milliseconds(0));
+  ASSERT_NOT_OK(writeBatches(syncClient, kNumBatches));
+  ASSERT_FALSE(syncClient->pushedFromOtherThread());
+
+  options_.push_queue_size = 2;
+  auto asyncClient = std::make_shared<FakeRssClient>(kNumPartitions, std::chrono::milliseconds(1));
+  ASSERT_NOT_OK(writeBatches(asyncClient, kNumBatches));
+
+  for (auto pid = 0; pid < kNumPartitions; ++pid) {
+    ASSERT_EQ(syncClient->pushed(pid), asyncClient->pushed(pid));
+  }
+}
+
+TEST_F(CelebornPartitionWriterTest, TestPushFailure) {
+  options_.push_queue_size = 2;
+  auto client = std::make_shared<FakeRssClient>(kNumPartitions, std::chrono::milliseconds(1), true);
+  auto status = writeBatches(client, kNumBatches);
+  ASSERT_TRUE(status.IsIOError()) << status.ToString();
+}
+
+} // namespace gluten
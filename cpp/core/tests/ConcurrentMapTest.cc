@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "jni/ConcurrentMap.h"
+
+namespace gluten {
+
+TEST(ConcurrentMapTest, staleHandleIsRejected) {
+  ConcurrentMap<std::shared_ptr<int>> map;
+  auto oldId = map.insert(std::make_shared<int>(1));
+  ASSERT_EQ(*map.lookup(oldId), 1);
+  map.erase(oldId);
+  ASSERT_EQ(map.lookup(oldId), nullptr);
+
+  // the freed slot is reused by the next insert on this thread, under a new generation
+  auto newId = map.insert(std::make_shared<int>(2));
+  ASSERT_EQ(static_cast<uint32_t>(newId), static_cast<uint32_t>(oldId));
+  ASSERT_NE(newId, oldId);
+  ASSERT_EQ(map.lookup(oldId), nullptr);
+  ASSERT_EQ(*map.lookup(newId), 2);
+
+  // erasing the stale handle again must not remove the new object
+  map.erase(oldId);
+  ASSERT_EQ(*map.lookup(newId), 2);
+  ASSERT_EQ(map.size(), 1u);
+
+  map.erase(newId);
+  ASSERT_EQ(map.lookup(newId), nullptr);
+  ASSERT_EQ(map.size(), 0u);
+}
+
+TEST(ConcurrentMapTest, invalidHandleIsRejected) {
+  ConcurrentMap<std::shared_ptr<int>> map;
+  auto id = map.insert(std::make_shared<int>(1));
+  ASSERT_EQ(map.lookup(0), nullptr);
+  ASSERT_EQ(map.lookup(-1), nullptr);
+  // a slot that was never allocated
+  ASSERT_EQ(map.lookup(id + 1), nullptr);
+  map.erase(id + 1);
+  ASSERT_EQ(map.size(), 1u);
+}
+
+} // namespace gluten
@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "memory/MemoryAllocator.h"
+
+namespace gluten {
+
+class CountingAllocationListener final : public AllocationListener {
+ public:
+  void allocationChanged(int64_t diff) override {
+    bytes_ += diff;
+    calls_++;
+  }
+
+  int64_t bytes() const {
+    return bytes_;
+  }
+
+  int64_t calls() const {
+    return calls_;
+  }
+
+ private:
+  int64_t bytes_ = 0;
+  int64_t calls_ = 0;
+};
+
+class ListenableMemoryAllocatorTest : public ::testing::Test {
+ protected:
+  ListenableMemoryAllocatorTest()
+      : listener_(std::make_shared<CountingAllocationListener>()),
+        allocator_(std::make_unique<ListenableMemoryAllocator>(&delegated_, listener_)) {}
+
+  StdMemoryAllocator delegated_;
+  std::shared_ptr<CountingAllocationListener> listener_;
+  std::unique_ptr<ListenableMemoryAllocator> allocator_;
+};
+
+TEST_F(ListenableMemoryAllocatorTest, listenerTracksAllocatedBytes) {
+  void* buf = nullptr;
+  ASSERT_TRUE(allocator_->allocate(100, &buf));
+  ASSERT_EQ(listener_->bytes(), 100);
+
+  ASSERT_TRUE(allocator_->reallocate(buf, 100, 300, &buf));
+  ASSERT_EQ(listener_->bytes(), 300);
+  ASSERT_EQ(allocator_->getBytes(), 300);
+
+  ASSERT_TRUE(allocator_->free(buf, 300));
+  ASSERT_EQ(allocator_->getBytes(), 0);
+  ASSERT_EQ(listener_->bytes(), 0);
+}
+
+TEST_F(ListenableMemoryAllocatorTest, reserveAndUnreserve) {
+  ASSERT_TRUE(allocator_->reserveBytes(100));
+  ASSERT_EQ(listener_->bytes(), 100);
+  ASSERT_TRUE(allocator_->unreserveBytes(100));
+  ASSERT_EQ(listener_->bytes(), 0);
+  ASSERT_EQ(listener_->calls(), 2);
+}
+
+} // namespace gluten
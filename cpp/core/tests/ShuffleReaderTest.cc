@@ -0,0 +1,235 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/io/api.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/record_batch.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <optional>
+#include <thread>
+
+#include "memory/ArrowMemoryPool.h"
+#include "memory/ColumnarBatch.h"
+#include "shuffle/reader.h"
+#include "utils/TestUtils.h"
+#include "utils/exception.h"
+
+namespace gluten {
+
+// Stand-in for the java shuffle stream: every read takes latency_, and reading beyond failAt_ fails like a fetch
+// failure. Records whether it was read from a thread other than the one that created it.
+class FakeShuffleStream : public arrow::io::InputStream {
+ public:
+  FakeShuffleStream(std::shared_ptr<arrow::Buffer> data, std::chrono::milliseconds latency, int64_t failAt = -1)
+      : in_(std::make_shared<arrow::io::BufferReader>(std::move(data))), latency_(latency), failAt_(failAt) {}
+
+  arrow::Status Close() override {
+    return in_->Close();
+  }
+
+  bool closed() const override {
+    return in_->closed();
+  }
+
+  arrow::Result<int64_t> Tell() const override {
+    return in_->Tell();
+  }
+
+  arrow::Result<int64_t> Read(int64_t nbytes, void* out) override {
+    RETURN_NOT_OK(beforeRead(nbytes));
+    return in_->Read(nbytes, out);
+  }
+
+  arrow::Result<std::shared_ptr<arrow::Buffer>> Read(int64_t nbytes) override {
+    RETURN_NOT_OK(beforeRead(nbytes));
+    return in_->Read(nbytes);
+  }
+
+  bool readFromOtherThread() const {
+    return readFromOtherThread_;
+  }
+
+ private:
+  arrow::Status beforeRead(int64_t nbytes) {
+    if (std::this_thread::get_id() != callerThreadId_) {
+      readFromOtherThread_ = true;
+    }
+    std::this_thread::sleep_for(latency_);
+    ARROW_ASSIGN_OR_RAISE(auto position, in_->Tell());
+    if (failAt_ >= 0 && position + nbytes > failAt_) {
+      return arrow::Status::IOError("Fake fetch failure");
+    }
+    return arrow::Status::OK();
+  }
+
+  std::shared_ptr<arrow::io::BufferReader> in_;
+  std::chrono::milliseconds latency_;
+  int64_t failAt_;
+  std::thread::id callerThreadId_ = std::this_thread::get_id();
+  bool readFromOtherThread_ = false;
+};
+
+class ShuffleReaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    schema_ = arrow::schema({arrow::field("f_int32", arrow::int32()), arrow::field("f_string", arrow::utf8())});
+    makeInputBatch(
+        {"[1, 2, 3, null, 4, null, 5, 6, null, 7]",
+         R"(["alice0", "bob1", "alice2", "bob3", "Alice4", "Bob5", "AlicE6", "boB7", "ALICE8", "BOB9"])"},
+        schema_,
+        &inputBatch_);
+
+    // the IPC stream of kNumBatches batches, with the end offset of every batch
+    ARROW_ASSIGN_OR_THROW(auto sink, arrow::io::BufferOutputStream::Create());
+    ARROW_ASSIGN_OR_THROW(auto writer, arrow::ipc::MakeStreamWriter(sink, schema_));
+    for (auto i = 0; i < kNumBatches; ++i) {
+      ASSERT_NOT_OK(writer->WriteRecordBatch(*inputBatch_));
+      ARROW_ASSIGN_OR_THROW(auto offset, sink->Tell());
+      batchEndOffsets_.push_back(offset);
+    }
+    ASSERT_NOT_OK(writer->Close());
+    ARROW_ASSIGN_OR_THROW(data_, sink->Finish());
+  }
+
+  std::unique_ptr<Reader> makeReader(const std::shared_ptr<arrow::io::InputStream>& in, ReaderOptions options) {
+    return std::make_unique<Reader>(in, schema_, options, getDefaultArrowMemoryPool());
+  }
+
+  // Read all the batches, return their numbers of rows.
+  std::vector<int64_t> readAll(Reader& reader) {
+    std::vector<int64_t> numRows;
+    while (true) {
+      GLUTEN_ASSIGN_OR_THROW(auto batch, reader.next());
+      if (batch == nullptr) {
+        break;
+      }
+      auto rb = std::dynamic_pointer_cast<ArrowColumnarBatch>(batch)->getRecordBatch();
+      for (auto i = 0; i < rb->num_columns(); ++i) {
+        for (auto offset = 0; offset < rb->num_rows(); offset += inputBatch_->num_rows()) {
+          ASSERT_NOT_OK(equals(*inputBatch_->column(i), *rb->column(i)->Slice(offset, inputBatch_->num_rows())));
+        }
+      }
+      numRows.push_back(rb->num_rows());
+    }
+    return numRows;
+  }
+
+  static constexpr int32_t kNumBatches = 10;
+
+  std::shared_ptr<arrow::Schema> schema_;
+  std::shared_ptr<arrow::RecordBatch> inputBatch_;
+  std::vector<int64_t> batchEndOffsets_;
+  std::shared_ptr<arrow::Buffer> data_;
+};
+
+TEST_F(ShuffleReaderTest, TestPrefetchSlowStream) {
+  auto options = ReaderOptions::defaults();
+  options.prefetch_depth = 3;
+  auto in = std::make_shared<FakeShuffleStream>(data_, std::chrono::milliseconds(1));
+  auto reader = makeReader(in, options);
+  ASSERT_EQ(readAll(*reader), std::vector<int64_t>(kNumBatches, inputBatch_->num_rows()));
+  // only the decoding runs on the prefetch thread, the stream is read on the task thread
+  ASSERT_FALSE(in->readFromOtherThread());
+  ASSERT_NOT_OK(reader->close());
+}
+
+TEST_F(ShuffleReaderTest, TestPrefetchCoalesce) {
+  auto options = ReaderOptions::defaults();
+  options.prefetch_depth = 2;
+  options.coalesce_target_rows = 25;
+  auto in = std::make_shared<FakeShuffleStream>(data_, std::chrono::milliseconds(1));
+  auto reader = makeReader(in, options);
+  ASSERT_EQ(readAll(*reader), (std::vector<int64_t>{30, 30, 30, 10}));
+  ASSERT_FALSE(in->readFromOtherThread());
+}
+
+TEST_F(ShuffleReaderTest, TestPrefetchFailingStream) {
+  auto options = ReaderOptions::defaults();
+  options.prefetch_depth = 4;
+  auto in = std::make_shared<FakeShuffleStream>(data_, std::chrono::milliseconds(0), batchEndOffsets_[2] + 1);
+  auto reader = makeReader(in, options);
+  // the batches read before the failure are returned, then the failure on every call
+  for (auto i = 0; i < 3; ++i) {
+    GLUTEN_ASSIGN_OR_THROW(auto batch, reader->next());
+    ASSERT_NE(batch, nullptr);
+  }
+  ASSERT_THROW(reader->next(), GlutenException);
+  ASSERT_THROW(reader->next(), GlutenException);
+  ASSERT_FALSE(in->readFromOtherThread());
+  ASSERT_NOT_OK(reader->close());
+}
+
+TEST_F(ShuffleReaderTest, TestDictionaryBatches) {
+  // every record batch is preceded by the dictionary batch replacing the previous dictionary, as the shuffle writer
+  // writes it with dictionary_encode
+  auto dictionarySchema = arrow::schema({arrow::field("f_dict", arrow::dictionary(arrow::int32(), arrow::utf8()))});
+  const std::vector<std::pair<std::string, std::string>> dictionariesAndIndices = {
+      {R"(["asia", "europe"])", "[0, 1, null, 0]"},
+      {R"(["africa"])", "[0, 0]"},
+      {R"(["europe", "asia"])", "[1, null, 0]"}};
+  const std::vector<std::optional<std::string>> expected = {
+      "asia", "europe", std::nullopt, "asia", "africa", "africa", "asia", std::nullopt, "europe"};
+
+  ARROW_ASSIGN_OR_THROW(auto sink, arrow::io::BufferOutputStream::Create());
+  ARROW_ASSIGN_OR_THROW(auto writer, arrow::ipc::MakeStreamWriter(sink, dictionarySchema));
+  for (const auto& [dictionaryJson, indicesJson] : dictionariesAndIndices) {
+    ARROW_ASSIGN_OR_THROW(auto dictionary, arrow::ipc::internal::json::ArrayFromJSON(arrow::utf8(), dictionaryJson));
+    ARROW_ASSIGN_OR_THROW(auto indices, arrow::ipc::internal::json::ArrayFromJSON(arrow::int32(), indicesJson));
+    ARROW_ASSIGN_OR_THROW(
+        auto array, arrow::DictionaryArray::FromArrays(dictionarySchema->field(0)->type(), indices, dictionary));
+    ASSERT_NOT_OK(writer->WriteRecordBatch(*arrow::RecordBatch::Make(dictionarySchema, array->length(), {array})));
+  }
+  ASSERT_NOT_OK(writer->Close());
+  ARROW_ASSIGN_OR_THROW(auto data, sink->Finish());
+
+  // synchronously batch by batch, and prefetched with all the batches merged into one
+  for (auto prefetchDepth : {0, 3}) {
+    auto options = ReaderOptions::defaults();
+    options.prefetch_depth = prefetchDepth;
+    options.coalesce_target_rows = prefetchDepth > 0 ? 100 : 0;
+    auto in = std::make_shared<FakeShuffleStream>(data, std::chrono::milliseconds(0));
+    Reader reader(in, dictionarySchema, options, getDefaultArrowMemoryPool());
+
+    std::vector<std::optional<std::string>> values;
+    size_t numBatches = 0;
+    while (true) {
+      GLUTEN_ASSIGN_OR_THROW(auto batch, reader.next());
+      if (batch == nullptr) {
+        break;
+      }
+      ++numBatches;
+      auto rb = std::dynamic_pointer_cast<ArrowColumnarBatch>(batch)->getRecordBatch();
+      ASSERT_EQ(rb->column(0)->type_id(), arrow::Type::DICTIONARY);
+      auto array = std::static_pointer_cast<arrow::DictionaryArray>(rb->column(0));
+      auto dictionary = std::static_pointer_cast<arrow::StringArray>(array->dictionary());
+      for (auto i = 0; i < array->length(); ++i) {
+        if (array->IsNull(i)) {
+          values.emplace_back(std::nullopt);
+        } else {
+          values.emplace_back(dictionary->GetString(array->GetValueIndex(i)));
+        }
+      }
+    }
+    ASSERT_EQ(numBatches, prefetchDepth > 0 ? 1 : dictionariesAndIndices.size());
+    ASSERT_EQ(values, expected);
+    ASSERT_NOT_OK(reader.close());
+  }
+}
+
+} // namespace gluten
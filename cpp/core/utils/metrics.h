@@ -35,6 +35,8 @@ struct Metrics {
   long* cpuCount;
   long* wallNanos;
   long veloxToArrow;
+  // Output batches merged by the result iterator.
+  long numCoalescedBatches = 0;
 
   long* peakMemoryBytes;
   long* numMemoryAllocations;
@@ -40,6 +40,7 @@ using namespace gluten;
 
 DEFINE_bool(skip_input, false, "Skip specifying input files.");
 DEFINE_bool(gen_orc_input, false, "Generate orc files from parquet as input files.");
+DEFINE_int32(task_drivers, 1, "Number of drivers to run each Velox task with. Only applied to scan-based plans.");
 
 static const std::string kParquetSuffix = ".parquet";
 static const std::string kOrcSuffix = ".orc";
@@ -215,6 +216,7 @@ int main(int argc, char** argv) {
   std::shared_ptr<OrcFileGuard> orcFileGuard;
 
   conf.insert({gluten::kSparkBatchSize, FLAGS_batch_size});
+  conf.insert({gluten::kNumTaskDrivers, std::to_string(FLAGS_task_drivers)});
   initVeloxBackend(conf);
 
   try {
@@ -266,6 +268,7 @@ int main(int argc, char** argv) {
   std::cout << "FLAGS_print_result:" << FLAGS_print_result << std::endl;
   std::cout << "FLAGS_write_file:" << FLAGS_write_file << std::endl;
   std::cout << "FLAGS_batch_size:" << FLAGS_batch_size << std::endl;
+  std::cout << "FLAGS_task_drivers:" << FLAGS_task_drivers << std::endl;
 #endif
 
   if (FLAGS_skip_input) {
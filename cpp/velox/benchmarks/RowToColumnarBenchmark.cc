@@ -0,0 +1,238 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/c/abi.h>
+#include <arrow/c/bridge.h>
+#include <arrow/filesystem/filesystem.h>
+#include <arrow/io/interfaces.h>
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/type.h>
+#include <arrow/util/io_util.h>
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/file_reader.h>
+
+#include <chrono>
+
+#include "compute/VeloxColumnarToRowConverter.h"
+#include "compute/VeloxRowToColumnarConverter.h"
+#include "memory/ArrowMemoryPool.h"
+#include "memory/VeloxColumnarBatch.h"
+#include "memory/VeloxMemoryPool.h"
+#include "utils/TestUtils.h"
+#include "velox/vector/arrow/Bridge.h"
+
+using namespace facebook;
+using namespace arrow;
+namespace gluten {
+
+const int kBatchBufferSize = 32768;
+
+// The UnsafeRows of one batch, as handed to the converter by the JVM.
+struct RowBatch {
+  int64_t numRows;
+  std::vector<int64_t> lengths;
+  std::vector<uint8_t> buffer;
+};
+
+class GoogleBenchmarkRowToColumnar {
+ public:
+  GoogleBenchmarkRowToColumnar(std::string fileName) {
+    getRecordBatchReader(fileName);
+  }
+
+  void getRecordBatchReader(const std::string& inputFile) {
+    std::unique_ptr<::parquet::arrow::FileReader> parquetReader;
+    std::shared_ptr<RecordBatchReader> recordBatchReader;
+
+    std::shared_ptr<arrow::fs::FileSystem> fs;
+    std::string fileName;
+    ARROW_ASSIGN_OR_THROW(fs, arrow::fs::FileSystemFromUriOrPath(inputFile, &fileName))
+
+    ARROW_ASSIGN_OR_THROW(file_, fs->OpenInputFile(fileName));
+
+    properties_.set_batch_size(kBatchBufferSize);
+    properties_.set_pre_buffer(false);
+    properties_.set_use_threads(false);
+
+    ASSERT_NOT_OK(::parquet::arrow::FileReader::Make(
+        arrow::default_memory_pool(), ::parquet::ParquetFileReader::Open(file_), properties_, &parquetReader));
+
+    ASSERT_NOT_OK(parquetReader->GetSchema(&schema_));
+
+    auto numRowgroups = parquetReader->num_row_groups();
+
+    for (int i = 0; i < numRowgroups; ++i) {
+      rowGroupIndices_.push_back(i);
+    }
+
+    auto numColumns = schema_->num_fields();
+    for (int i = 0; i < numColumns; ++i) {
+      columnIndices_.push_back(i);
+    }
+  }
+
+  void operator()(benchmark::State& state) {
+    if (state.range(0) == 0xffffffff) {
+      setCpu(state.thread_index());
+    } else {
+      setCpu(state.range(0));
+    }
+
+    std::shared_ptr<arrow::RecordBatch> recordBatch;
+    int64_t elapseRead = 0;
+    int64_t numBatches = 0;
+    int64_t numRows = 0;
+    int64_t writeTime = 0;
+    int64_t convertTime = 0;
+
+    if (state.thread_index() == 0)
+      std::cout << schema_->ToString() << std::endl;
+
+    std::unique_ptr<::parquet::arrow::FileReader> parquetReader;
+    std::shared_ptr<RecordBatchReader> recordBatchReader;
+    ASSERT_NOT_OK(::parquet::arrow::FileReader::Make(
+        ::arrow::default_memory_pool(), ::parquet::ParquetFileReader::Open(file_), properties_, &parquetReader));
+
+    // Convert the file to UnsafeRows once, only the row to columnar conversion is measured.
+    auto arrowPool = getDefaultArrowMemoryPool();
+    auto ctxPool = getDefaultVeloxLeafMemoryPool();
+    std::vector<RowBatch> rowBatches;
+    ASSERT_NOT_OK(parquetReader->GetRecordBatchReader(rowGroupIndices_, columnIndices_, &recordBatchReader));
+    do {
+      TIME_NANO_OR_THROW(elapseRead, recordBatchReader->ReadNext(&recordBatch));
+
+      if (recordBatch) {
+        auto row = std::dynamic_pointer_cast<velox::RowVector>(recordBatch2RowVector(*recordBatch));
+        auto columnarToRowConverter = std::make_shared<gluten::VeloxColumnarToRowConverter>(arrowPool, ctxPool);
+        TIME_NANO_OR_THROW(writeTime, columnarToRowConverter->write(std::make_shared<VeloxColumnarBatch>(row)));
+        const auto& lengths = columnarToRowConverter->getLengths();
+        auto& rowBatch = rowBatches.emplace_back();
+        rowBatch.numRows = recordBatch->num_rows();
+        rowBatch.lengths.assign(lengths.begin(), lengths.end());
+        int64_t totalLength = 0;
+        for (auto length : rowBatch.lengths) {
+          totalLength += length;
+        }
+        auto address = columnarToRowConverter->getBufferAddress();
+        rowBatch.buffer.assign(address, address + totalLength);
+        numBatches += 1;
+        numRows += recordBatch->num_rows();
+      }
+    } while (recordBatch);
+
+    std::cout << " parquet parse done elapsed time = " << elapseRead / 1000000 << " rows = " << numRows << std::endl;
+
+    for (auto _ : state) {
+      ArrowSchema cSchema;
+      ASSERT_NOT_OK(arrow::ExportSchema(*schema_, &cSchema));
+      auto rowToColumnarConverter = std::make_shared<gluten::VeloxRowToColumnarConverter>(&cSchema, ctxPool);
+      for (auto& rowBatch : rowBatches) {
+        std::shared_ptr<ColumnarBatch> cb;
+        TIME_NANO(
+            convertTime,
+            cb = rowToColumnarConverter->convert(rowBatch.numRows, rowBatch.lengths.data(), rowBatch.buffer.data()));
+        benchmark::DoNotOptimize(cb);
+      }
+    }
+
+    state.counters["rowgroups"] =
+        benchmark::Counter(rowGroupIndices_.size(), benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+    state.counters["columns"] =
+        benchmark::Counter(columnIndices_.size(), benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+    state.counters["batches"] =
+        benchmark::Counter(numBatches, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+    state.counters["num_rows"] =
+        benchmark::Counter(numRows, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+    state.counters["batch_buffer_size"] =
+        benchmark::Counter(kBatchBufferSize, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1024);
+
+    state.counters["parquet_parse"] =
+        benchmark::Counter(elapseRead, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+    state.counters["write_time"] =
+        benchmark::Counter(writeTime, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+    state.counters["convert_time"] =
+        benchmark::Counter(convertTime, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+  }
+
+ protected:
+  long setCpu(uint32_t cpuindex) {
+    cpu_set_t cs;
+    CPU_ZERO(&cs);
+    CPU_SET(cpuindex, &cs);
+    return sched_setaffinity(0, sizeof(cs), &cs);
+  }
+
+  velox::VectorPtr recordBatch2RowVector(const arrow::RecordBatch& rb) {
+    ArrowArray arrowArray;
+    ArrowSchema arrowSchema;
+    ASSERT_NOT_OK(arrow::ExportRecordBatch(rb, &arrowArray, &arrowSchema));
+    return velox::importFromArrowAsOwner(arrowSchema, arrowArray, gluten::getDefaultVeloxLeafMemoryPool().get());
+  }
+
+ protected:
+  std::shared_ptr<arrow::io::RandomAccessFile> file_;
+  std::vector<int> rowGroupIndices_;
+  std::vector<int> columnIndices_;
+  std::shared_ptr<arrow::Schema> schema_;
+  parquet::ArrowReaderProperties properties_;
+};
+
+} // namespace gluten
+
+// usage
+// ./row_to_columnar_benchmark --threads=1 --file /mnt/DP_disk1/int.parquet
+int main(int argc, char** argv) {
+  uint32_t iterations = 1;
+  uint32_t threads = 1;
+  std::string datafile;
+  uint32_t cpu = 0xffffffff;
+
+  for (int i = 0; i < argc; i++) {
+    if (strcmp(argv[i], "--iterations") == 0) {
+      iterations = atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "--threads") == 0) {
+      threads = atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "--file") == 0) {
+      datafile = argv[i + 1];
+    } else if (strcmp(argv[i], "--cpu") == 0) {
+      cpu = atol(argv[i + 1]);
+    }
+  }
+  std::cout << "iterations = " << iterations << std::endl;
+  std::cout << "threads = " << threads << std::endl;
+  std::cout << "datafile = " << datafile << std::endl;
+  std::cout << "cpu = " << cpu << std::endl;
+
+  gluten::GoogleBenchmarkRowToColumnar bck(datafile);
+
+  benchmark::RegisterBenchmark("GoogleBenchmarkRowToColumnar::CacheScan", bck)
+      ->Args({
+          cpu,
+      })
+      ->Iterations(iterations)
+      ->Threads(threads)
+      ->ReportAggregatesOnly(false)
+      ->MeasureProcessCPUTime()
+      ->Unit(benchmark::kSecond);
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+}
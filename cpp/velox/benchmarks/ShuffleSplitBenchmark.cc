@@ -15,6 +15,7 @@
  * limitations under the License.
  */
 
+#include <arrow/builder.h>
 #include <arrow/filesystem/filesystem.h>
 #include <arrow/io/interfaces.h>
 #include <arrow/memory_pool.h>
@@ -29,8 +30,11 @@
 #include <sys/mman.h>
 
 #include <chrono>
+#include <random>
 
 #include "memory/ColumnarBatch.h"
+#include "memory/VeloxColumnarBatch.h"
+#include "memory/VeloxMemoryPool.h"
 #include "shuffle/LocalPartitionWriter.h"
 #include "shuffle/VeloxShuffleWriter.h"
 #include "utils/TestUtils.h"
@@ -50,6 +54,8 @@ void printTrace(void) {
   free(strings);
 }
 
+using namespace facebook;
+
 using arrow::RecordBatchReader;
 using arrow::Status;
 
@@ -145,6 +151,8 @@ class BenchmarkShuffleSplit {
     getRecordBatchReader(fileName);
   }
 
+  BenchmarkShuffleSplit() = default;
+
   void getRecordBatchReader(const std::string& inputFile) {
     std::unique_ptr<::parquet::arrow::FileReader> parquetReader;
     std::shared_ptr<RecordBatchReader> recordBatchReader;
@@ -422,12 +430,242 @@ class BenchmarkShuffleSplitIterateScanBenchmark : public BenchmarkShuffleSplit {
   }
 };
 
+class BenchmarkShuffleSplitNestedTypeBenchmark : public BenchmarkShuffleSplit {
+ public:
+  // Generated batches of array<string>, map<string, int64> and struct<int64, string> columns.
+  BenchmarkShuffleSplitNestedTypeBenchmark(int32_t numBatches) {
+    schema_ = arrow::schema(
+        {arrow::field("a", arrow::list(arrow::utf8())),
+         arrow::field("m", arrow::map(arrow::utf8(), arrow::int64())),
+         arrow::field("s", arrow::struct_({arrow::field("s0", arrow::int64()), arrow::field("s1", arrow::utf8())}))});
+    for (int i = 0; i < schema_->num_fields(); ++i) {
+      columnIndices_.push_back(i);
+    }
+    for (int32_t i = 0; i < numBatches; ++i) {
+      batches_.push_back(makeBatch(kBatchBufferSize, i));
+    }
+  }
+
+ protected:
+  std::shared_ptr<arrow::RecordBatch> makeBatch(int32_t numRows, int32_t seed) {
+    auto pool = arrow::default_memory_pool();
+
+    arrow::ListBuilder listBuilder(pool, std::make_shared<arrow::StringBuilder>(pool));
+    auto listValueBuilder = static_cast<arrow::StringBuilder*>(listBuilder.value_builder());
+
+    arrow::MapBuilder mapBuilder(
+        pool, std::make_shared<arrow::StringBuilder>(pool), std::make_shared<arrow::Int64Builder>(pool));
+    auto mapKeyBuilder = static_cast<arrow::StringBuilder*>(mapBuilder.key_builder());
+    auto mapItemBuilder = static_cast<arrow::Int64Builder*>(mapBuilder.item_builder());
+
+    arrow::StructBuilder structBuilder(
+        schema_->field(2)->type(),
+        pool,
+        {std::make_shared<arrow::Int64Builder>(pool), std::make_shared<arrow::StringBuilder>(pool)});
+    auto structIntBuilder = static_cast<arrow::Int64Builder*>(structBuilder.field_builder(0));
+    auto structStringBuilder = static_cast<arrow::StringBuilder*>(structBuilder.field_builder(1));
+
+    for (int32_t row = 0; row < numRows; ++row) {
+      auto value = static_cast<int64_t>(row) * 31 + seed;
+      auto str = "value_" + std::to_string(value);
+
+      GLUTEN_THROW_NOT_OK(listBuilder.Append());
+      for (int32_t j = 0; j < row % 5; ++j) {
+        GLUTEN_THROW_NOT_OK(listValueBuilder->Append(str));
+      }
+
+      GLUTEN_THROW_NOT_OK(mapBuilder.Append());
+      for (int32_t j = 0; j < row % 3; ++j) {
+        GLUTEN_THROW_NOT_OK(mapKeyBuilder->Append("key_" + std::to_string(j)));
+        GLUTEN_THROW_NOT_OK(mapItemBuilder->Append(value + j));
+      }
+
+      if (row % 7 == 0) {
+        GLUTEN_THROW_NOT_OK(structBuilder.AppendNull());
+        GLUTEN_THROW_NOT_OK(structIntBuilder->AppendNull());
+        GLUTEN_THROW_NOT_OK(structStringBuilder->AppendNull());
+      } else {
+        GLUTEN_THROW_NOT_OK(structBuilder.Append());
+        GLUTEN_THROW_NOT_OK(structIntBuilder->Append(value));
+        GLUTEN_THROW_NOT_OK(structStringBuilder->Append(str));
+      }
+    }
+
+    std::vector<std::shared_ptr<arrow::Array>> columns(3);
+    GLUTEN_THROW_NOT_OK(listBuilder.Finish(&columns[0]));
+    GLUTEN_THROW_NOT_OK(mapBuilder.Finish(&columns[1]));
+    GLUTEN_THROW_NOT_OK(structBuilder.Finish(&columns[2]));
+    return arrow::RecordBatch::Make(schema_, numRows, std::move(columns));
+  }
+
+  void doSplit(
+      std::shared_ptr<VeloxShuffleWriter>& shuffleWriter,
+      int64_t& elapseRead,
+      int64_t& numBatches,
+      int64_t& numRows,
+      int64_t& splitTime,
+      const int numPartitions,
+      std::shared_ptr<ShuffleWriter::PartitionWriterCreator> partitionWriterCreator,
+      ShuffleWriterOptions options,
+      benchmark::State& state) {
+    if (state.thread_index() == 0)
+      std::cout << schema_->ToString() << std::endl;
+
+    GLUTEN_ASSIGN_OR_THROW(
+        shuffleWriter,
+        VeloxShuffleWriter::create(numPartitions, std::move(partitionWriterCreator), std::move(options)));
+
+    for (auto _ : state) {
+      for (const auto& recordBatch : batches_) {
+        numBatches += 1;
+        numRows += recordBatch->num_rows();
+        std::shared_ptr<ColumnarBatch> cb;
+        ARROW_ASSIGN_OR_THROW(cb, recordBatch2VeloxColumnarBatch(*recordBatch));
+        TIME_NANO_OR_THROW(splitTime, shuffleWriter->split(cb.get()));
+      }
+    }
+    TIME_NANO_OR_THROW(splitTime, shuffleWriter->stop());
+  }
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches_;
+};
+
+class BenchmarkShuffleSplitFixedWidthBenchmark : public BenchmarkShuffleSplit {
+ public:
+  // Generated batches of a single nullable column of the given fixed-width type, to report the split throughput
+  // per type width.
+  BenchmarkShuffleSplitFixedWidthBenchmark(int32_t numBatches, const velox::TypePtr& type) {
+    auto pool = getDefaultVeloxLeafMemoryPool().get();
+    auto rowType = velox::ROW({"c0"}, {type});
+    std::mt19937 gen(0);
+    for (int32_t i = 0; i < numBatches; ++i) {
+      auto column = velox::BaseVector::create(type, kBatchBufferSize, pool);
+      auto values = column->values()->asMutable<uint8_t>();
+      std::generate(values, values + column->values()->size(), [&gen]() { return static_cast<uint8_t>(gen()); });
+      for (int32_t row = 0; row < kBatchBufferSize; row += 8) {
+        column->setNull(row, true);
+      }
+      auto rv = std::make_shared<velox::RowVector>(
+          pool, rowType, nullptr, kBatchBufferSize, std::vector<velox::VectorPtr>{column});
+      batches_.push_back(std::make_shared<VeloxColumnarBatch>(rv));
+    }
+    columnIndices_.push_back(0);
+  }
+
+ protected:
+  void doSplit(
+      std::shared_ptr<VeloxShuffleWriter>& shuffleWriter,
+      int64_t& elapseRead,
+      int64_t& numBatches,
+      int64_t& numRows,
+      int64_t& splitTime,
+      const int numPartitions,
+      std::shared_ptr<ShuffleWriter::PartitionWriterCreator> partitionWriterCreator,
+      ShuffleWriterOptions options,
+      benchmark::State& state) {
+    GLUTEN_ASSIGN_OR_THROW(
+        shuffleWriter,
+        VeloxShuffleWriter::create(numPartitions, std::move(partitionWriterCreator), std::move(options)));
+
+    for (auto _ : state) {
+      for (const auto& batch : batches_) {
+        numBatches += 1;
+        numRows += batch->getNumRows();
+        TIME_NANO_OR_THROW(splitTime, shuffleWriter->split(batch.get()));
+      }
+    }
+    TIME_NANO_OR_THROW(splitTime, shuffleWriter->stop());
+  }
+
+  std::vector<std::shared_ptr<VeloxColumnarBatch>> batches_;
+};
+
+class BenchmarkShuffleSplitDictionaryBenchmark : public BenchmarkShuffleSplit {
+ public:
+  // Generated batches of a bigint column and two low-cardinality string columns wrapped in dictionaries, as read
+  // from Parquet dictionary pages. If 'dictionaryEncode' is false, the writer flattens the strings for comparison.
+  BenchmarkShuffleSplitDictionaryBenchmark(int32_t numBatches, bool dictionaryEncode)
+      : dictionaryEncode_(dictionaryEncode) {
+    auto pool = getDefaultVeloxLeafMemoryPool().get();
+    auto rowType = velox::ROW({"key", "s0", "s1"}, {velox::BIGINT(), velox::VARCHAR(), velox::VARCHAR()});
+    auto dictionary0 = makeDictionary(16, "nation_", pool);
+    auto dictionary1 = makeDictionary(1024, "customer_segment_", pool);
+    for (int32_t i = 0; i < numBatches; ++i) {
+      auto keys = velox::BaseVector::create<velox::FlatVector<int64_t>>(velox::BIGINT(), kBatchBufferSize, pool);
+      auto indices0 = velox::allocateIndices(kBatchBufferSize, pool);
+      auto indices1 = velox::allocateIndices(kBatchBufferSize, pool);
+      auto rawIndices0 = indices0->asMutable<velox::vector_size_t>();
+      auto rawIndices1 = indices1->asMutable<velox::vector_size_t>();
+      for (int32_t row = 0; row < kBatchBufferSize; ++row) {
+        auto value = static_cast<int64_t>(row) * 31 + i;
+        keys->set(row, value);
+        rawIndices0[row] = value % dictionary0->size();
+        rawIndices1[row] = (value * 7) % dictionary1->size();
+      }
+      auto rv = std::make_shared<velox::RowVector>(
+          pool,
+          rowType,
+          nullptr,
+          kBatchBufferSize,
+          std::vector<velox::VectorPtr>{
+              keys,
+              velox::BaseVector::wrapInDictionary(nullptr, indices0, kBatchBufferSize, dictionary0),
+              velox::BaseVector::wrapInDictionary(nullptr, indices1, kBatchBufferSize, dictionary1)});
+      batches_.push_back(std::make_shared<VeloxColumnarBatch>(rv));
+    }
+    for (int i = 0; i < rowType->size(); ++i) {
+      columnIndices_.push_back(i);
+    }
+  }
+
+ protected:
+  static velox::VectorPtr makeDictionary(int32_t size, const std::string& prefix, velox::memory::MemoryPool* pool) {
+    auto dictionary = velox::BaseVector::create<velox::FlatVector<velox::StringView>>(velox::VARCHAR(), size, pool);
+    for (int32_t i = 0; i < size; ++i) {
+      dictionary->set(i, velox::StringView(prefix + std::to_string(i)));
+    }
+    return dictionary;
+  }
+
+  void doSplit(
+      std::shared_ptr<VeloxShuffleWriter>& shuffleWriter,
+      int64_t& elapseRead,
+      int64_t& numBatches,
+      int64_t& numRows,
+      int64_t& splitTime,
+      const int numPartitions,
+      std::shared_ptr<ShuffleWriter::PartitionWriterCreator> partitionWriterCreator,
+      ShuffleWriterOptions options,
+      benchmark::State& state) {
+    options.dictionary_encode = dictionaryEncode_;
+    options.write_schema = dictionaryEncode_;
+    GLUTEN_ASSIGN_OR_THROW(
+        shuffleWriter,
+        VeloxShuffleWriter::create(numPartitions, std::move(partitionWriterCreator), std::move(options)));
+
+    for (auto _ : state) {
+      for (const auto& batch : batches_) {
+        numBatches += 1;
+        numRows += batch->getNumRows();
+        TIME_NANO_OR_THROW(splitTime, shuffleWriter->split(batch.get()));
+      }
+    }
+    TIME_NANO_OR_THROW(splitTime, shuffleWriter->stop());
+  }
+
+  bool dictionaryEncode_;
+  std::vector<std::shared_ptr<VeloxColumnarBatch>> batches_;
+};
+
 } // namespace gluten
 
 int main(int argc, char** argv) {
   uint32_t iterations = 1;
   uint32_t partitions = 192;
   uint32_t threads = 1;
+  uint32_t nestedBatches = 0;
+  uint32_t fixedWidthBatches = 0;
+  uint32_t dictionaryBatches = 0;
   std::string datafile;
   auto compressionCodec = arrow::Compression::LZ4_FRAME;
 
@@ -440,6 +678,12 @@ int main(int argc, char** argv) {
       threads = atol(argv[i + 1]);
     } else if (strcmp(argv[i], "--file") == 0) {
       datafile = argv[i + 1];
+    } else if (strcmp(argv[i], "--nested") == 0) {
+      nestedBatches = atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "--fixed-width") == 0) {
+      fixedWidthBatches = atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "--dictionary") == 0) {
+      dictionaryBatches = atol(argv[i + 1]);
     } else if (strcmp(argv[i], "--qat") == 0) {
       compressionCodec = arrow::Compression::GZIP;
     }
@@ -463,18 +707,74 @@ int main(int argc, char** argv) {
 
   */
 
-  gluten::BenchmarkShuffleSplitIterateScanBenchmark bck(datafile);
-
-  benchmark::RegisterBenchmark("BenchmarkShuffleSplit::IterateScan", bck)
-      ->Iterations(iterations)
-      ->Args({
-          partitions,
-          compressionCodec,
-      })
-      ->Threads(threads)
-      ->ReportAggregatesOnly(false)
-      ->MeasureProcessCPUTime()
-      ->Unit(benchmark::kSecond);
+  if (!datafile.empty()) {
+    gluten::BenchmarkShuffleSplitIterateScanBenchmark bck(datafile);
+
+    benchmark::RegisterBenchmark("BenchmarkShuffleSplit::IterateScan", bck)
+        ->Iterations(iterations)
+        ->Args({
+            partitions,
+            compressionCodec,
+        })
+        ->Threads(threads)
+        ->ReportAggregatesOnly(false)
+        ->MeasureProcessCPUTime()
+        ->Unit(benchmark::kSecond);
+  }
+
+  if (nestedBatches > 0) {
+    gluten::BenchmarkShuffleSplitNestedTypeBenchmark nested(nestedBatches);
+    benchmark::RegisterBenchmark("BenchmarkShuffleSplit::NestedType", nested)
+        ->Iterations(iterations)
+        ->Args({
+            partitions,
+            compressionCodec,
+        })
+        ->Threads(threads)
+        ->ReportAggregatesOnly(false)
+        ->MeasureProcessCPUTime()
+        ->Unit(benchmark::kSecond);
+  }
+
+  if (fixedWidthBatches > 0) {
+    std::vector<std::pair<std::string, velox::TypePtr>> types = {
+        {"Bool", velox::BOOLEAN()},
+        {"Int8", velox::TINYINT()},
+        {"Int16", velox::SMALLINT()},
+        {"Int32", velox::INTEGER()},
+        {"Int64", velox::BIGINT()},
+        {"Decimal128", velox::DECIMAL(38, 10)}};
+    for (const auto& [name, type] : types) {
+      gluten::BenchmarkShuffleSplitFixedWidthBenchmark fixedWidth(fixedWidthBatches, type);
+      benchmark::RegisterBenchmark(("BenchmarkShuffleSplit::FixedWidth" + name).c_str(), fixedWidth)
+          ->Iterations(iterations)
+          ->Args({
+              partitions,
+              compressionCodec,
+          })
+          ->Threads(threads)
+          ->ReportAggregatesOnly(false)
+          ->MeasureProcessCPUTime()
+          ->Unit(benchmark::kSecond);
+    }
+  }
+
+  if (dictionaryBatches > 0) {
+    for (auto dictionaryEncode : {true, false}) {
+      gluten::BenchmarkShuffleSplitDictionaryBenchmark dictionary(dictionaryBatches, dictionaryEncode);
+      std::string name = dictionaryEncode ? "DictionaryEncoded" : "DictionaryFlattened";
+      benchmark::RegisterBenchmark(("BenchmarkShuffleSplit::" + name).c_str(), dictionary)
+          ->Iterations(iterations)
+          ->Args({
+              partitions,
+              compressionCodec,
+          })
+          ->Threads(threads)
+          ->ReportAggregatesOnly(false)
+          ->MeasureProcessCPUTime()
+          ->Unit(benchmark::kSecond);
+    }
+  }
 
   benchmark::Initialize(&argc, argv);
   benchmark::RunSpecifiedBenchmarks();
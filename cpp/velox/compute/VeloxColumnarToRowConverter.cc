@@ -17,44 +17,48 @@
 
 #include "VeloxColumnarToRowConverter.h"
 
-#include <arrow/array/array_base.h>
 #include <arrow/buffer.h>
-#include <arrow/c/abi.h>
-#include <arrow/type_traits.h>
 #include <arrow/util/decimal.h>
 
-#include "ArrowTypeUtils.h"
-#include "arrow/c/bridge.h"
-#include "arrow/c/helpers.h"
 #include "memory/VeloxColumnarBatch.h"
-#include "velox/row/UnsafeRowDeserializers.h"
-#include "velox/row/UnsafeRowSerializers.h"
-#include "velox/vector/arrow/Bridge.h"
 
 using namespace facebook;
-using arrow::MemoryPool;
 
 namespace gluten {
 
+namespace {
+
+// Zero-extend a fixed-width value to a full field slot, UnsafeRow compares rows bytewise.
+template <typename T>
+inline int64_t toWord(const T& value) {
+  static_assert(sizeof(T) <= sizeof(int64_t), "Value does not fit in an UnsafeRow field slot");
+  int64_t word = 0;
+  memcpy(&word, &value, sizeof(T));
+  return word;
+}
+
+inline bool isVariableWidth(velox::TypeKind kind) {
+  return kind == velox::TypeKind::VARCHAR || kind == velox::TypeKind::VARBINARY;
+}
+
+} // namespace
+
 arrow::Status VeloxColumnarToRowConverter::init() {
   numRows_ = rv_->size();
   numCols_ = rv_->childrenSize();
 
-  ArrowSchema cSchema{};
-  velox::exportToArrow(rv_, cSchema);
-  ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::Schema> schema, arrow::ImportSchema(&cSchema));
-  if (numCols_ != schema->num_fields()) {
-    return arrow::Status::Invalid("Mismatch: num_cols_ != schema->num_fields()");
-  }
-  schema_ = schema;
-
   // The input is Arrow batch. We need to resume Velox Vector here.
   vecs_.clear();
   resumeVeloxVector();
 
-  // Calculate the initial size
+  // Calculate the initial size, decimals of precision > 18 take 16 more bytes in the variable length region.
   nullBitsetWidthInBytes_ = calculateBitSetWidthInBytes(numCols_);
-  int64_t fixedSizePerRow = calculatedFixeSizePerRow(schema_, numCols_);
+  int64_t fixedSizePerRow = nullBitsetWidthInBytes_ + 8 * numCols_;
+  for (const auto& vec : vecs_) {
+    if (vec->typeKind() == velox::TypeKind::LONG_DECIMAL) {
+      fixedSizePerRow += 16;
+    }
+  }
 
   // Initialize the offsets_ , lengths_, buffer_cursor_
   lengths_.clear();
@@ -66,22 +70,24 @@ arrow::Status VeloxColumnarToRowConverter::init() {
   bufferCursor_.resize(numRows_, nullBitsetWidthInBytes_ + 8 * numCols_);
 
   // Calculated the lengths_
-  for (int64_t colIdx = 0; colIdx < numCols_; colIdx++) {
-    std::shared_ptr<arrow::Field> field = schema_->field(colIdx);
-    if (arrow::is_binary_like(field->type()->id())) {
-      auto strViews = vecs_[colIdx]->asFlatVector<velox::StringView>()->rawValues();
-      for (int rowIdx = 0; rowIdx < numRows_; rowIdx++) {
-        auto length = strViews[rowIdx].size();
-        int64_t bytes = roundNumberOfBytesToNearestWord(length);
-        lengths_[rowIdx] += bytes;
+  for (int32_t colIdx = 0; colIdx < numCols_; colIdx++) {
+    const auto& vec = vecs_[colIdx];
+    if (!isVariableWidth(vec->typeKind())) {
+      continue;
+    }
+    auto strViews = vec->asFlatVector<velox::StringView>()->rawValues();
+    const uint64_t* rawNulls = vec->mayHaveNulls() ? vec->rawNulls() : nullptr;
+    for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+      if (rawNulls == nullptr || !velox::bits::isBitNull(rawNulls, rowIdx)) {
+        lengths_[rowIdx] += roundNumberOfBytesToNearestWord(strViews[rowIdx].size());
       }
     }
   }
 
   // Calculated the offsets_  and total memory size based on lengths_
-  int64_t totalMemorySize = lengths_[0];
-  for (int64_t rowIdx = 1; rowIdx < numRows_; rowIdx++) {
-    offsets_[rowIdx] = offsets_[rowIdx - 1] + lengths_[rowIdx - 1];
+  int64_t totalMemorySize = 0;
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    offsets_[rowIdx] = totalMemorySize;
     totalMemorySize += lengths_[rowIdx];
   }
 
@@ -93,7 +99,10 @@ arrow::Status VeloxColumnarToRowConverter::init() {
   }
 
   bufferAddress_ = buffer_->mutable_data();
-  memset(bufferAddress_, 0, sizeof(int8_t) * totalMemorySize);
+  // Every field slot and padding word is written by the column writers, only the null bitsets need zeroing.
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    memset(bufferAddress_ + offsets_[rowIdx], 0, nullBitsetWidthInBytes_);
+  }
   return arrow::Status::OK();
 }
 
@@ -104,141 +113,150 @@ void VeloxColumnarToRowConverter::resumeVeloxVector() {
   }
 }
 
+template <typename GetWord>
+void VeloxColumnarToRowConverter::writeFixedWidthColumn(int32_t colIdx, const uint64_t* rawNulls, GetWord getWord) {
+  int64_t fieldOffset = getFieldOffset(nullBitsetWidthInBytes_, colIdx);
+  uint8_t* fieldAddress = bufferAddress_ + fieldOffset;
+  if (rawNulls == nullptr) {
+    for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+      *reinterpret_cast<int64_t*>(fieldAddress + offsets_[rowIdx]) = getWord(rowIdx);
+    }
+    return;
+  }
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    if (velox::bits::isBitNull(rawNulls, rowIdx)) {
+      setNullAt(bufferAddress_, offsets_[rowIdx], fieldOffset, colIdx);
+    } else {
+      *reinterpret_cast<int64_t*>(fieldAddress + offsets_[rowIdx]) = getWord(rowIdx);
+    }
+  }
+}
+
+template <velox::TypeKind kind>
+void VeloxColumnarToRowConverter::writePrimitiveColumn(int32_t colIdx, const uint64_t* rawNulls) {
+  using T = typename velox::TypeTraits<kind>::NativeType;
+  auto values = vecs_[colIdx]->asFlatVector<T>()->rawValues();
+  writeFixedWidthColumn(colIdx, rawNulls, [values](int32_t rowIdx) { return toWord(values[rowIdx]); });
+}
+
+void VeloxColumnarToRowConverter::writeBoolColumn(int32_t colIdx, const uint64_t* rawNulls) {
+  // Velox bools are bit packed, UnsafeRow takes one byte per value.
+  auto values = vecs_[colIdx]->asFlatVector<bool>()->rawValues<uint64_t>();
+  writeFixedWidthColumn(
+      colIdx, rawNulls, [values](int32_t rowIdx) { return velox::bits::isBitSet(values, rowIdx) ? 1L : 0L; });
+}
+
+void VeloxColumnarToRowConverter::writeTimestampColumn(int32_t colIdx, const uint64_t* rawNulls) {
+  auto values = vecs_[colIdx]->asFlatVector<velox::Timestamp>()->rawValues();
+  writeFixedWidthColumn(colIdx, rawNulls, [values](int32_t rowIdx) { return values[rowIdx].toMicros(); });
+}
+
+void VeloxColumnarToRowConverter::writeStringColumn(int32_t colIdx, const uint64_t* rawNulls) {
+  int64_t fieldOffset = getFieldOffset(nullBitsetWidthInBytes_, colIdx);
+  auto strViews = vecs_[colIdx]->asFlatVector<velox::StringView>()->rawValues();
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    if (rawNulls != nullptr && velox::bits::isBitNull(rawNulls, rowIdx)) {
+      setNullAt(bufferAddress_, offsets_[rowIdx], fieldOffset, colIdx);
+      continue;
+    }
+    uint8_t* rowAddress = bufferAddress_ + offsets_[rowIdx];
+    int32_t cursor = bufferCursor_[rowIdx];
+    int32_t length = (int32_t)strViews[rowIdx].size();
+    int32_t paddedLength = roundNumberOfBytesToNearestWord(length);
+    // Zero the last word first, the copy below overwrites all but the padding bytes.
+    if (paddedLength > length) {
+      *reinterpret_cast<int64_t*>(rowAddress + cursor + paddedLength - 8) = 0;
+    }
+    // Write the variable value.
+    memcpy(rowAddress + cursor, strViews[rowIdx].data(), length);
+    // Write the offset and size.
+    *reinterpret_cast<int64_t*>(rowAddress + fieldOffset) = ((int64_t)cursor << 32) | length;
+    bufferCursor_[rowIdx] += paddedLength;
+  }
+}
+
+void VeloxColumnarToRowConverter::writeLongDecimalColumn(int32_t colIdx, const uint64_t* rawNulls) {
+  int64_t fieldOffset = getFieldOffset(nullBitsetWidthInBytes_, colIdx);
+  auto longDecimal = vecs_[colIdx]->asFlatVector<velox::UnscaledLongDecimal>()->rawValues();
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    uint8_t* rowAddress = bufferAddress_ + offsets_[rowIdx];
+    int32_t cursor = bufferCursor_[rowIdx];
+    // The 16 bytes are reserved for null values as well.
+    memset(rowAddress + cursor, 0, 16);
+    if (rawNulls != nullptr && velox::bits::isBitNull(rawNulls, rowIdx)) {
+      setNullAt(bufferAddress_, offsets_[rowIdx], fieldOffset, colIdx);
+    } else {
+      int32_t size;
+      velox::int128_t veloxInt128 = longDecimal[rowIdx].unscaledValue();
+
+      velox::int128_t orignalValue = veloxInt128;
+      int64_t high = veloxInt128 >> 64;
+      uint64_t lower = (uint64_t)orignalValue;
+
+      auto out = toByteArray(arrow::Decimal128(high, lower), &size);
+      assert(size <= 16);
+
+      // write the variable value
+      memcpy(rowAddress + cursor, &out[0], size);
+      // write the offset and size
+      *reinterpret_cast<int64_t*>(rowAddress + fieldOffset) = ((int64_t)cursor << 32) | size;
+    }
+    // Update the cursor of the buffer.
+    bufferCursor_[rowIdx] += 16;
+  }
+}
+
 arrow::Status VeloxColumnarToRowConverter::write(std::shared_ptr<ColumnarBatch> cb) {
   auto veloxBatch = std::dynamic_pointer_cast<VeloxColumnarBatch>(cb);
   rv_ = veloxBatch->getFlattenedRowVector();
   RETURN_NOT_OK(init());
-  for (int col_idx = 0; col_idx < numCols_; col_idx++) {
-    auto vec = vecs_[col_idx];
-    bool mayHaveNulls = vec->mayHaveNulls();
-
-    int64_t field_offset = getFieldOffset(nullBitsetWidthInBytes_, col_idx);
-    auto field_address = (char*)(bufferAddress_ + field_offset);
-
-#define SERIALIZE_COLUMN(DataType)                                                                  \
-  do {                                                                                              \
-    if (mayHaveNulls) {                                                                             \
-      for (int row_idx = 0; row_idx < numRows_; row_idx++) {                                        \
-        if (vec->isNullAt(row_idx)) {                                                               \
-          setNullAt(bufferAddress_, offsets_[row_idx], field_offset, col_idx);                      \
-        } else {                                                                                    \
-          auto write_address = (char*)(field_address + offsets_[row_idx]);                          \
-          velox::row::UnsafeRowSerializer::serialize<velox::DataType>(vec, write_address, row_idx); \
-        }                                                                                           \
-      }                                                                                             \
-    } else {                                                                                        \
-      for (int row_idx = 0; row_idx < numRows_; row_idx++) {                                        \
-        auto write_address = (char*)(field_address + offsets_[row_idx]);                            \
-        velox::row::UnsafeRowSerializer::serialize<velox::DataType>(vec, write_address, row_idx);   \
-      }                                                                                             \
-    }                                                                                               \
-  } while (0)
-
-    auto colTypeId = schema_->field(col_idx)->type()->id();
-    switch (colTypeId) {
+  for (int32_t colIdx = 0; colIdx < numCols_; colIdx++) {
+    const auto& vec = vecs_[colIdx];
+    const uint64_t* rawNulls = vec->mayHaveNulls() ? vec->rawNulls() : nullptr;
+    switch (vec->typeKind()) {
       // We should keep supported types consistent with that in #buildCheck of GlutenColumnarToRowExec.scala.
-      case arrow::Int8Type::type_id: {
-        SERIALIZE_COLUMN(TinyintType);
+      case velox::TypeKind::TINYINT:
+        writePrimitiveColumn<velox::TypeKind::TINYINT>(colIdx, rawNulls);
         break;
-      }
-      case arrow::Int16Type::type_id: {
-        SERIALIZE_COLUMN(SmallintType);
+      case velox::TypeKind::SMALLINT:
+        writePrimitiveColumn<velox::TypeKind::SMALLINT>(colIdx, rawNulls);
         break;
-      }
-      case arrow::Int32Type::type_id: {
-        SERIALIZE_COLUMN(IntegerType);
+      case velox::TypeKind::INTEGER:
+        writePrimitiveColumn<velox::TypeKind::INTEGER>(colIdx, rawNulls);
         break;
-      }
-      case arrow::Int64Type::type_id: {
-        SERIALIZE_COLUMN(BigintType);
+      case velox::TypeKind::BIGINT:
+        writePrimitiveColumn<velox::TypeKind::BIGINT>(colIdx, rawNulls);
         break;
-      }
-      case arrow::Date32Type::type_id: {
-        SERIALIZE_COLUMN(DateType);
+      case velox::TypeKind::DATE:
+        writePrimitiveColumn<velox::TypeKind::DATE>(colIdx, rawNulls);
         break;
-      }
-      case arrow::FloatType::type_id: {
-        SERIALIZE_COLUMN(RealType);
+      case velox::TypeKind::REAL:
+        writePrimitiveColumn<velox::TypeKind::REAL>(colIdx, rawNulls);
         break;
-      }
-      case arrow::DoubleType::type_id: {
-        SERIALIZE_COLUMN(DoubleType);
+      case velox::TypeKind::DOUBLE:
+        writePrimitiveColumn<velox::TypeKind::DOUBLE>(colIdx, rawNulls);
         break;
-      }
-      case arrow::BooleanType::type_id: {
-        SERIALIZE_COLUMN(BooleanType);
+      case velox::TypeKind::SHORT_DECIMAL:
+        // The unscaled long value, refer to the int64_t() method of Decimal128.
+        writePrimitiveColumn<velox::TypeKind::SHORT_DECIMAL>(colIdx, rawNulls);
         break;
-      }
-      case arrow::BinaryType::type_id:
-      case arrow::StringType::type_id: {
-        auto strViews = vec->asFlatVector<velox::StringView>()->rawValues();
-        for (int rowIdx = 0; rowIdx < numRows_; rowIdx++) {
-          if (mayHaveNulls && vec->isNullAt(rowIdx)) {
-            setNullAt(bufferAddress_, offsets_[rowIdx], field_offset, col_idx);
-          } else {
-            int32_t length = (int32_t)strViews[rowIdx].size();
-            auto value = strViews[rowIdx].data();
-            // Write the variable value.
-            memcpy(bufferAddress_ + offsets_[rowIdx] + bufferCursor_[rowIdx], value, length);
-            int64_t offsetAndSize = ((int64_t)bufferCursor_[rowIdx] << 32) | length;
-            // Write the offset and size.
-            memcpy(bufferAddress_ + offsets_[rowIdx] + field_offset, &offsetAndSize, sizeof(int64_t));
-            bufferCursor_[rowIdx] += length;
-          }
-        }
+      case velox::TypeKind::BOOLEAN:
+        writeBoolColumn(colIdx, rawNulls);
         break;
-      }
-      case arrow::Decimal128Type::type_id: {
-        for (auto rowIdx = 0; rowIdx < numRows_; rowIdx++) {
-          bool flag = vec->isNullAt(rowIdx);
-          if (vec->typeKind() == velox::TypeKind::SHORT_DECIMAL) {
-            auto shortDecimal = vec->asFlatVector<velox::UnscaledShortDecimal>()->rawValues();
-            if (!flag) {
-              // Get the long value and write the long value
-              // Refer to the int64_t() method of Decimal128
-              int64_t longValue = shortDecimal[rowIdx].unscaledValue();
-              memcpy(bufferAddress_ + offsets_[rowIdx] + field_offset, &longValue, sizeof(long));
-            } else {
-              setNullAt(bufferAddress_, offsets_[rowIdx], field_offset, col_idx);
-            }
-          } else {
-            if (flag) {
-              setNullAt(bufferAddress_, offsets_[rowIdx], field_offset, col_idx);
-            } else {
-              auto longDecimal = vec->asFlatVector<velox::UnscaledLongDecimal>()->rawValues();
-              int32_t size;
-              velox::int128_t veloxInt128 = longDecimal[rowIdx].unscaledValue();
-
-              velox::int128_t orignalValue = veloxInt128;
-              int64_t high = veloxInt128 >> 64;
-              uint64_t lower = (uint64_t)orignalValue;
-
-              auto out = toByteArray(arrow::Decimal128(high, lower), &size);
-              assert(size <= 16);
-
-              // write the variable value
-              memcpy(bufferAddress_ + bufferCursor_[rowIdx] + offsets_[rowIdx], &out[0], size);
-              // write the offset and size
-              int64_t offsetAndSize = ((int64_t)bufferCursor_[rowIdx] << 32) | size;
-              memcpy(bufferAddress_ + offsets_[rowIdx] + field_offset, &offsetAndSize, sizeof(int64_t));
-            }
-
-            // Update the cursor of the buffer.
-            bufferCursor_[rowIdx] += 16;
-          }
-        }
+      case velox::TypeKind::TIMESTAMP:
+        writeTimestampColumn(colIdx, rawNulls);
         break;
-      }
-      case arrow::TimestampType::type_id: {
-        SERIALIZE_COLUMN(TimestampType);
+      case velox::TypeKind::VARCHAR:
+      case velox::TypeKind::VARBINARY:
+        writeStringColumn(colIdx, rawNulls);
+        break;
+      case velox::TypeKind::LONG_DECIMAL:
+        writeLongDecimalColumn(colIdx, rawNulls);
         break;
-      }
       default:
         return arrow::Status::Invalid(
-            "Type " + schema_->field(col_idx)->type()->name() + " is not supported in VeloxToRow conversion.");
+            "Type " + vec->type()->toString() + " is not supported in VeloxToRow conversion.");
     }
-
-#undef SERIALIZE_COLUMN
   }
   return arrow::Status::OK();
 }
@@ -40,10 +40,24 @@ class VeloxColumnarToRowConverter final : public ColumnarToRowConverter {
 
   arrow::Status init();
 
+  // Write one 8-byte field slot per row, getWord returns the zero-extended value of a non-null row.
+  template <typename GetWord>
+  void writeFixedWidthColumn(int32_t colIdx, const uint64_t* rawNulls, GetWord getWord);
+
+  template <facebook::velox::TypeKind kind>
+  void writePrimitiveColumn(int32_t colIdx, const uint64_t* rawNulls);
+
+  void writeBoolColumn(int32_t colIdx, const uint64_t* rawNulls);
+
+  void writeTimestampColumn(int32_t colIdx, const uint64_t* rawNulls);
+
+  void writeStringColumn(int32_t colIdx, const uint64_t* rawNulls);
+
+  void writeLongDecimalColumn(int32_t colIdx, const uint64_t* rawNulls);
+
   facebook::velox::RowVectorPtr rv_;
   std::shared_ptr<facebook::velox::memory::MemoryPool> veloxPool_;
   std::vector<facebook::velox::VectorPtr> vecs_;
-  std::shared_ptr<arrow::Schema> schema_;
 };
 
 } // namespace gluten
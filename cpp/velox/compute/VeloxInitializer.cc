@@ -18,6 +18,7 @@
 
 #include "VeloxInitializer.h"
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/executors/IOThreadPoolExecutor.h>
 
 #include "RegistrationAllFunctions.h"
@@ -67,6 +68,10 @@ const std::string kVeloxIOThreadsDefault = "0";
 const std::string kVeloxSplitPreloadPerDriver = "spark.gluten.sql.columnar.backend.velox.SplitPreloadPerDriver";
 const std::string kVeloxSplitPreloadPerDriverDefault = "2";
 
+// 0 means using the number of hardware threads.
+const std::string kVeloxDriverThreads = "spark.gluten.sql.columnar.backend.velox.driverThreads";
+const std::string kVeloxDriverThreadsDefault = "0";
+
 // mem ratios and thresholds
 const std::string kMemoryCapRatio = "spark.gluten.sql.columnar.backend.velox.memoryCapRatio";
 const std::string kSpillThresholdRatio = "spark.gluten.sql.columnar.backend.velox.spillMemoryThresholdRatio";
@@ -166,6 +171,7 @@ void VeloxInitializer::init(const std::unordered_map<std::string, std::string>&
 
   initCache(conf);
   initIOExecutor(conf);
+  initDriverExecutor(conf);
   auto properties = std::make_shared<const velox::core::MemConfig>(configurationValues);
   auto hiveConnector =
       velox::connector::getConnectorFactory(velox::connector::hive::HiveConnectorFactory::kHiveConnectorName)
@@ -266,6 +272,25 @@ void VeloxInitializer::initIOExecutor(const std::unordered_map<std::string, std:
   }
 }
 
+void VeloxInitializer::initDriverExecutor(const std::unordered_map<std::string, std::string>& conf) {
+  driverThreads_ = std::stoi(kVeloxDriverThreadsDefault);
+  auto got = conf.find(kVeloxDriverThreads);
+  if (got != conf.end()) {
+    driverThreads_ = std::stoi(got->second);
+  }
+  if (driverThreads_ <= 0) {
+    driverThreads_ = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+folly::Executor* VeloxInitializer::getDriverExecutor() {
+  std::call_once(driverExecutorFlag_, [this]() {
+    driverExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(driverThreads_);
+    LOG(INFO) << "Created driver executor with " << driverThreads_ << " threads";
+  });
+  return driverExecutor_.get();
+}
+
 void VeloxInitializer::create(const std::unordered_map<std::string, std::string>& conf) {
   std::lock_guard<std::mutex> lockGuard(mutex_);
   if (instance_ != nullptr) {
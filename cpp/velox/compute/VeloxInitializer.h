@@ -21,6 +21,7 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/executors/IOThreadPoolExecutor.h>
 
 #include "VeloxColumnarToRowConverter.h"
@@ -57,6 +58,9 @@ class VeloxInitializer {
     return spillThreshold_;
   }
 
+  /// Executor shared by all the tasks running with more than one driver. Created on first use.
+  folly::Executor* getDriverExecutor();
+
  private:
   explicit VeloxInitializer(const std::unordered_map<std::string, std::string>& conf) {
     init(conf);
@@ -65,6 +69,7 @@ class VeloxInitializer {
   void init(const std::unordered_map<std::string, std::string>& conf);
   void initCache(const std::unordered_map<std::string, std::string>& conf);
   void initIOExecutor(const std::unordered_map<std::string, std::string>& conf);
+  void initDriverExecutor(const std::unordered_map<std::string, std::string>& conf);
 
   std::string getCacheFilePrefix() {
     return "cache." + boost::lexical_cast<std::string>(boost::uuids::random_generator()()) + ".";
@@ -84,6 +89,10 @@ class VeloxInitializer {
   std::unique_ptr<folly::IOThreadPoolExecutor> ssdCacheExecutor_;
   std::unique_ptr<folly::IOThreadPoolExecutor> ioExecutor_;
 
+  int32_t driverThreads_ = 0;
+  std::once_flag driverExecutorFlag_;
+  std::unique_ptr<folly::CPUThreadPoolExecutor> driverExecutor_;
+
   std::string cachePathPrefix_;
   std::string cacheFilePrefix_;
 };
@@ -22,17 +22,262 @@
 
 using namespace facebook::velox;
 namespace gluten {
+
+namespace {
+
+inline bool isNullAt(const uint8_t* row, int32_t colIdx) {
+  return bits::isBitSet(reinterpret_cast<const uint64_t*>(row), colIdx);
+}
+
+inline int64_t readWord(const uint8_t* address) {
+  int64_t word;
+  memcpy(&word, address, sizeof(word));
+  return word;
+}
+
+bool isFlatSupported(TypeKind kind) {
+  switch (kind) {
+    case TypeKind::BOOLEAN:
+    case TypeKind::TINYINT:
+    case TypeKind::SMALLINT:
+    case TypeKind::INTEGER:
+    case TypeKind::BIGINT:
+    case TypeKind::DATE:
+    case TypeKind::REAL:
+    case TypeKind::DOUBLE:
+    case TypeKind::SHORT_DECIMAL:
+    case TypeKind::LONG_DECIMAL:
+    case TypeKind::TIMESTAMP:
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
 VeloxRowToColumnarConverter::VeloxRowToColumnarConverter(
     struct ArrowSchema* cSchema,
     std::shared_ptr<memory::MemoryPool> memoryPool)
     : RowToColumnarConverter(cSchema), pool_(memoryPool) {
   rowType_ = importFromArrow(*cSchema);
   ArrowSchemaRelease(cSchema);
+
+  const auto& rowType = rowType_->asRow();
+  auto numFields = rowType.size();
+  nullBitsetWidthInBytes_ = ((numFields + 63) / 64) * 8;
+  fieldOffsets_.reserve(numFields);
+  for (auto i = 0; i < numFields; i++) {
+    fieldOffsets_.push_back(nullBitsetWidthInBytes_ + 8L * i);
+    flat_ = flat_ && isFlatSupported(rowType.childAt(i)->kind());
+  }
+}
+
+template <TypeKind kind>
+VectorPtr VeloxRowToColumnarConverter::readPrimitiveColumn(
+    int32_t colIdx,
+    const TypePtr& type,
+    int64_t numRows,
+    const uint8_t* memoryAddress) {
+  using T = typename TypeTraits<kind>::NativeType;
+  auto vector = BaseVector::create(type, numRows, pool_.get());
+  auto flatVector = vector->asFlatVector<T>();
+  auto values = flatVector->mutableRawValues();
+  int64_t fieldOffset = fieldOffsets_[colIdx];
+  for (auto rowIdx = 0; rowIdx < numRows; rowIdx++) {
+    const uint8_t* row = memoryAddress + rowOffsets_[rowIdx];
+    // The slot of a null field is zeroed, so it can be loaded unconditionally.
+    memcpy(&values[rowIdx], row + fieldOffset, sizeof(T));
+    if (isNullAt(row, colIdx)) {
+      flatVector->setNull(rowIdx, true);
+    }
+  }
+  return vector;
+}
+
+VectorPtr VeloxRowToColumnarConverter::readBoolColumn(
+    int32_t colIdx,
+    const TypePtr& type,
+    int64_t numRows,
+    const uint8_t* memoryAddress) {
+  auto vector = BaseVector::create(type, numRows, pool_.get());
+  auto flatVector = vector->asFlatVector<bool>();
+  // Velox bools are bit packed, UnsafeRow takes one byte per value.
+  auto values = flatVector->mutableRawValues<uint64_t>();
+  int64_t fieldOffset = fieldOffsets_[colIdx];
+  for (auto rowIdx = 0; rowIdx < numRows; rowIdx++) {
+    const uint8_t* row = memoryAddress + rowOffsets_[rowIdx];
+    bits::setBit(values, rowIdx, row[fieldOffset] != 0);
+    if (isNullAt(row, colIdx)) {
+      flatVector->setNull(rowIdx, true);
+    }
+  }
+  return vector;
+}
+
+VectorPtr VeloxRowToColumnarConverter::readTimestampColumn(
+    int32_t colIdx,
+    const TypePtr& type,
+    int64_t numRows,
+    const uint8_t* memoryAddress) {
+  auto vector = BaseVector::create(type, numRows, pool_.get());
+  auto flatVector = vector->asFlatVector<Timestamp>();
+  auto values = flatVector->mutableRawValues();
+  int64_t fieldOffset = fieldOffsets_[colIdx];
+  for (auto rowIdx = 0; rowIdx < numRows; rowIdx++) {
+    const uint8_t* row = memoryAddress + rowOffsets_[rowIdx];
+    values[rowIdx] = Timestamp::fromMicros(readWord(row + fieldOffset));
+    if (isNullAt(row, colIdx)) {
+      flatVector->setNull(rowIdx, true);
+    }
+  }
+  return vector;
+}
+
+VectorPtr VeloxRowToColumnarConverter::readStringColumn(
+    int32_t colIdx,
+    const TypePtr& type,
+    int64_t numRows,
+    const uint8_t* memoryAddress) {
+  auto vector = BaseVector::create(type, numRows, pool_.get());
+  auto flatVector = vector->asFlatVector<StringView>();
+  auto values = flatVector->mutableRawValues();
+  int64_t fieldOffset = fieldOffsets_[colIdx];
+
+  // Size the string buffer in one pass, short strings are inlined in the StringViews.
+  size_t bufferSize = 0;
+  for (auto rowIdx = 0; rowIdx < numRows; rowIdx++) {
+    const uint8_t* row = memoryAddress + rowOffsets_[rowIdx];
+    uint32_t length = static_cast<uint32_t>(readWord(row + fieldOffset));
+    if (!isNullAt(row, colIdx) && length > StringView::kInlineSize) {
+      bufferSize += length;
+    }
+  }
+  char* rawBuffer = nullptr;
+  if (bufferSize > 0) {
+    auto buffer = AlignedBuffer::allocate<char>(bufferSize, pool_.get());
+    rawBuffer = buffer->asMutable<char>();
+    flatVector->setStringBuffers({buffer});
+  }
+
+  for (auto rowIdx = 0; rowIdx < numRows; rowIdx++) {
+    const uint8_t* row = memoryAddress + rowOffsets_[rowIdx];
+    if (isNullAt(row, colIdx)) {
+      values[rowIdx] = StringView();
+      flatVector->setNull(rowIdx, true);
+      continue;
+    }
+    int64_t offsetAndSize = readWord(row + fieldOffset);
+    uint32_t length = static_cast<uint32_t>(offsetAndSize);
+    const char* data = reinterpret_cast<const char*>(row + (offsetAndSize >> 32));
+    if (length <= StringView::kInlineSize) {
+      values[rowIdx] = StringView(data, length);
+    } else {
+      memcpy(rawBuffer, data, length);
+      values[rowIdx] = StringView(rawBuffer, length);
+      rawBuffer += length;
+    }
+  }
+  return vector;
+}
+
+VectorPtr VeloxRowToColumnarConverter::readLongDecimalColumn(
+    int32_t colIdx,
+    const TypePtr& type,
+    int64_t numRows,
+    const uint8_t* memoryAddress) {
+  auto vector = BaseVector::create(type, numRows, pool_.get());
+  auto flatVector = vector->asFlatVector<UnscaledLongDecimal>();
+  auto values = flatVector->mutableRawValues();
+  int64_t fieldOffset = fieldOffsets_[colIdx];
+  for (auto rowIdx = 0; rowIdx < numRows; rowIdx++) {
+    const uint8_t* row = memoryAddress + rowOffsets_[rowIdx];
+    if (isNullAt(row, colIdx)) {
+      values[rowIdx] = UnscaledLongDecimal(0);
+      flatVector->setNull(rowIdx, true);
+      continue;
+    }
+    // The value is the big-endian two's complement of the unscaled value, as written by BigInteger.toByteArray.
+    int64_t offsetAndSize = readWord(row + fieldOffset);
+    uint32_t size = static_cast<uint32_t>(offsetAndSize);
+    const uint8_t* bytes = row + (offsetAndSize >> 32);
+    __uint128_t value = (size > 0 && (bytes[0] & 0x80)) ? ~static_cast<__uint128_t>(0) : 0;
+    for (uint32_t i = 0; i < size; i++) {
+      value = (value << 8) | bytes[i];
+    }
+    values[rowIdx] = UnscaledLongDecimal(static_cast<int128_t>(value));
+  }
+  return vector;
+}
+
+RowVectorPtr VeloxRowToColumnarConverter::convertFlat(int64_t numRows, const uint8_t* memoryAddress) {
+  const auto& rowType = rowType_->asRow();
+  std::vector<VectorPtr> columns;
+  columns.reserve(rowType.size());
+  for (auto colIdx = 0; colIdx < rowType.size(); colIdx++) {
+    const auto& type = rowType.childAt(colIdx);
+    switch (type->kind()) {
+      case TypeKind::BOOLEAN:
+        columns.push_back(readBoolColumn(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::TINYINT:
+        columns.push_back(readPrimitiveColumn<TypeKind::TINYINT>(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::SMALLINT:
+        columns.push_back(readPrimitiveColumn<TypeKind::SMALLINT>(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::INTEGER:
+        columns.push_back(readPrimitiveColumn<TypeKind::INTEGER>(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::BIGINT:
+        columns.push_back(readPrimitiveColumn<TypeKind::BIGINT>(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::DATE:
+        columns.push_back(readPrimitiveColumn<TypeKind::DATE>(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::REAL:
+        columns.push_back(readPrimitiveColumn<TypeKind::REAL>(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::DOUBLE:
+        columns.push_back(readPrimitiveColumn<TypeKind::DOUBLE>(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::SHORT_DECIMAL:
+        // The unscaled long value is stored in the field slot.
+        columns.push_back(readPrimitiveColumn<TypeKind::SHORT_DECIMAL>(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::LONG_DECIMAL:
+        columns.push_back(readLongDecimalColumn(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::TIMESTAMP:
+        columns.push_back(readTimestampColumn(colIdx, type, numRows, memoryAddress));
+        break;
+      case TypeKind::VARCHAR:
+      case TypeKind::VARBINARY:
+        columns.push_back(readStringColumn(colIdx, type, numRows, memoryAddress));
+        break;
+      default:
+        throw GlutenException("Type " + type->toString() + " is not supported in RowToVelox conversion.");
+    }
+  }
+  return std::make_shared<RowVector>(pool_.get(), rowType_, BufferPtr(nullptr), numRows, std::move(columns));
 }
 
 std::shared_ptr<ColumnarBatch>
 VeloxRowToColumnarConverter::convert(int64_t numRows, int64_t* rowLength, uint8_t* memoryAddress) {
+  if (flat_) {
+    rowOffsets_.resize(numRows);
+    int64_t offset = 0;
+    for (auto i = 0; i < numRows; i++) {
+      rowOffsets_[i] = offset;
+      offset += rowLength[i];
+    }
+    return std::make_shared<VeloxColumnarBatch>(convertFlat(numRows, memoryAddress));
+  }
+
   std::vector<std::optional<std::string_view>> data;
+  data.reserve(numRows);
   int64_t offset = 0;
   for (auto i = 0; i < numRows; i++) {
     data.emplace_back(std::string_view(reinterpret_cast<const char*>(memoryAddress + offset), rowLength[i]));
@@ -34,8 +34,34 @@ class VeloxRowToColumnarConverter final : public RowToColumnarConverter {
   std::shared_ptr<ColumnarBatch> convert(int64_t numRows, int64_t* rowLength, uint8_t* memoryAddress);
 
  protected:
+  // Decode the flat columns of rowType_ straight from the UnsafeRows, rowOffsets_ must be filled.
+  facebook::velox::RowVectorPtr convertFlat(int64_t numRows, const uint8_t* memoryAddress);
+
+  template <facebook::velox::TypeKind kind>
+  facebook::velox::VectorPtr
+  readPrimitiveColumn(int32_t colIdx, const facebook::velox::TypePtr& type, int64_t numRows, const uint8_t* memoryAddress);
+
+  facebook::velox::VectorPtr
+  readBoolColumn(int32_t colIdx, const facebook::velox::TypePtr& type, int64_t numRows, const uint8_t* memoryAddress);
+
+  facebook::velox::VectorPtr
+  readTimestampColumn(int32_t colIdx, const facebook::velox::TypePtr& type, int64_t numRows, const uint8_t* memoryAddress);
+
+  facebook::velox::VectorPtr
+  readStringColumn(int32_t colIdx, const facebook::velox::TypePtr& type, int64_t numRows, const uint8_t* memoryAddress);
+
+  facebook::velox::VectorPtr
+  readLongDecimalColumn(int32_t colIdx, const facebook::velox::TypePtr& type, int64_t numRows, const uint8_t* memoryAddress);
+
   facebook::velox::TypePtr rowType_;
   std::shared_ptr<facebook::velox::memory::MemoryPool> pool_;
+  // Whether all the columns are of types decoded by convertFlat, otherwise the UnsafeRowDeserializer is used.
+  bool flat_ = true;
+  int64_t nullBitsetWidthInBytes_;
+  // Offset of the field slot of every column in a row.
+  std::vector<int64_t> fieldOffsets_;
+  // Offset of every row of the current batch in the row buffer.
+  std::vector<int64_t> rowOffsets_;
 };
 
 } // namespace gluten
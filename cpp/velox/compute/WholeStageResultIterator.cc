@@ -31,6 +31,9 @@ const std::string kSpillStartPartitionBit = "spark.gluten.sql.columnar.backend.v
 const std::string kSpillPartitionBits = "spark.gluten.sql.columnar.backend.velox.spillPartitionBits";
 const std::string kSpillableReservationGrowthPct =
     "spark.gluten.sql.columnar.backend.velox.spillableReservationGrowthPct";
+const std::string kOutputCoalesceTargetRows = "spark.gluten.sql.columnar.backend.velox.outputCoalesceTargetRows";
+const std::string kOutputCoalesceTargetBytes = "spark.gluten.sql.columnar.backend.velox.outputCoalesceTargetBytes";
+const std::string kOutputCoalesceMaxBatches = "spark.gluten.sql.columnar.backend.velox.outputCoalesceMaxBatches";
 
 // metrics
 const std::string kDynamicFiltersProduced = "dynamicFiltersProduced";
@@ -46,13 +49,62 @@ const std::string kProcessedStrides = "processedStrides";
 // others
 const std::string kHiveDefaultPartition = "__HIVE_DEFAULT_PARTITION__";
 
+// Whether every node of the plan produces the same result when split across multiple drivers.
+// Streams fed by Java iterators are not thread safe and always need a single driver.
+bool supportsMultipleDrivers(const velox::core::PlanNodePtr& planNode) {
+  if (auto aggregation = std::dynamic_pointer_cast<const velox::core::AggregationNode>(planNode)) {
+    if (aggregation->step() != velox::core::AggregationNode::Step::kPartial &&
+        aggregation->step() != velox::core::AggregationNode::Step::kIntermediate) {
+      return false;
+    }
+  } else if (
+      !std::dynamic_pointer_cast<const velox::core::TableScanNode>(planNode) &&
+      !std::dynamic_pointer_cast<const velox::core::FilterNode>(planNode) &&
+      !std::dynamic_pointer_cast<const velox::core::ProjectNode>(planNode) &&
+      !std::dynamic_pointer_cast<const velox::core::HashJoinNode>(planNode)) {
+    return false;
+  }
+  for (const auto& source : planNode->sources()) {
+    if (!supportsMultipleDrivers(source)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Return a plan which can run with multiple drivers. A root node that needs all the input in a single
+// driver is put on top of a local gather exchange, so that the pipeline below it still runs in parallel.
+// Return nullptr if the plan has to run single-threaded.
+velox::core::PlanNodePtr toMultiDriverPlan(const velox::core::PlanNodePtr& planNode) {
+  if (supportsMultipleDrivers(planNode)) {
+    return planNode;
+  }
+  if (planNode->sources().size() != 1 || !supportsMultipleDrivers(planNode->sources()[0])) {
+    return nullptr;
+  }
+  auto gather = velox::core::LocalPartitionNode::gather(planNode->id() + "-gather", planNode->sources());
+  if (auto orderBy = std::dynamic_pointer_cast<const velox::core::OrderByNode>(planNode)) {
+    return std::make_shared<velox::core::OrderByNode>(
+        orderBy->id(), orderBy->sortingKeys(), orderBy->sortingOrders(), orderBy->isPartial(), gather);
+  }
+  if (auto topN = std::dynamic_pointer_cast<const velox::core::TopNNode>(planNode)) {
+    return std::make_shared<velox::core::TopNNode>(
+        topN->id(), topN->sortingKeys(), topN->sortingOrders(), topN->count(), topN->isPartial(), gather);
+  }
+  if (auto limit = std::dynamic_pointer_cast<const velox::core::LimitNode>(planNode)) {
+    return std::make_shared<velox::core::LimitNode>(
+        limit->id(), limit->offset(), limit->count(), limit->isPartial(), gather);
+  }
+  return nullptr;
+}
+
 } // namespace
 
-std::shared_ptr<velox::core::QueryCtx> WholeStageResultIterator::createNewVeloxQueryCtx() {
+std::shared_ptr<velox::core::QueryCtx> WholeStageResultIterator::createNewVeloxQueryCtx(folly::Executor* executor) {
   std::unordered_map<std::string, std::shared_ptr<velox::Config>> connectorConfigs;
   connectorConfigs[kHiveConnectorId] = createConnectorConfig();
   std::shared_ptr<velox::core::QueryCtx> ctx = std::make_shared<velox::core::QueryCtx>(
-      nullptr,
+      executor,
       std::make_shared<velox::core::MemConfig>(),
       connectorConfigs,
       gluten::VeloxInitializer::get()->getAsyncDataCache(),
@@ -64,20 +116,188 @@ std::shared_ptr<velox::core::QueryCtx> WholeStageResultIterator::createNewVeloxQ
   return ctx;
 }
 
+void WholeStageResultIterator::createTask(const std::string& taskId, const std::string& spillDir) {
+  auto planNode = veloxPlan_;
+  auto numDrivers = std::stoi(getConfigValue(kNumTaskDrivers, "1"));
+  if (numDrivers > 1) {
+    if (auto multiDriverPlan = toMultiDriverPlan(veloxPlan_)) {
+      planNode = multiDriverPlan;
+      numDrivers_ = numDrivers;
+    } else {
+      LOG(INFO) << "Plan of " << taskId << " requires a single driver, ignoring " << kNumTaskDrivers;
+    }
+  }
+  coalesceTargetRows_ = std::stoull(getConfigValue(kOutputCoalesceTargetRows, "0"));
+  coalesceTargetBytes_ = std::stoull(getConfigValue(kOutputCoalesceTargetBytes, "0"));
+  coalesceMaxBatches_ = std::stoul(getConfigValue(kOutputCoalesceMaxBatches, "0"));
+
+  std::unordered_set<velox::core::PlanNodeId> emptySet;
+  velox::core::PlanFragment planFragment{planNode, velox::core::ExecutionStrategy::kUngrouped, 1, emptySet};
+  if (numDrivers_ > 0) {
+    std::shared_ptr<velox::core::QueryCtx> queryCtx =
+        createNewVeloxQueryCtx(gluten::VeloxInitializer::get()->getDriverExecutor());
+    task_ = std::make_shared<velox::exec::Task>(
+        taskId,
+        std::move(planFragment),
+        0,
+        std::move(queryCtx),
+        [this](velox::RowVectorPtr vector, velox::ContinueFuture* future) {
+          return enqueueOutput(std::move(vector), future);
+        });
+  } else {
+    std::shared_ptr<velox::core::QueryCtx> queryCtx = createNewVeloxQueryCtx();
+    task_ = std::make_shared<velox::exec::Task>(taskId, std::move(planFragment), 0, std::move(queryCtx));
+    if (!task_->supportsSingleThreadedExecution()) {
+      throw std::runtime_error("Task doesn't support single thread execution: " + planNode->toString());
+    }
+  }
+  task_->setSpillDirectory(spillDir);
+}
+
+velox::exec::BlockingReason WholeStageResultIterator::enqueueOutput(
+    velox::RowVectorPtr vector,
+    velox::ContinueFuture* future) {
+  if (vector == nullptr) {
+    // One of the drivers has finished.
+    outputCv_.notify_all();
+    return velox::exec::BlockingReason::kNotBlocked;
+  }
+  // Lazy vectors have to be loaded by the driver owning the reader.
+  for (auto& child : vector->children()) {
+    child->loadedVector();
+  }
+  std::lock_guard<std::mutex> lock(outputMutex_);
+  outputQueue_.push_back(std::move(vector));
+  outputCv_.notify_one();
+  if (outputQueue_.size() < kMaxQueuedOutputBatches) {
+    return velox::exec::BlockingReason::kNotBlocked;
+  }
+  auto [promise, blockedFuture] = velox::makeVeloxContinuePromiseContract("WholeStageResultIterator::enqueueOutput");
+  blockedProducers_.push_back(std::move(promise));
+  *future = std::move(blockedFuture);
+  return velox::exec::BlockingReason::kWaitForConsumer;
+}
+
+velox::RowVectorPtr WholeStageResultIterator::dequeueOutput() {
+  velox::RowVectorPtr vector;
+  {
+    std::unique_lock<std::mutex> lock(outputMutex_);
+    // The last driver finishes its output before the task state changes, so poll the state while waiting.
+    while (outputQueue_.empty() && task_->isRunning()) {
+      outputCv_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    if (!outputQueue_.empty()) {
+      vector = std::move(outputQueue_.front());
+      outputQueue_.pop_front();
+    }
+  }
+  releaseBlockedProducers(false);
+  if (vector == nullptr) {
+    if (auto error = task_->error()) {
+      std::rethrow_exception(error);
+    }
+  }
+  return vector;
+}
+
+void WholeStageResultIterator::releaseBlockedProducers(bool clear) {
+  std::vector<velox::ContinuePromise> promises;
+  {
+    std::lock_guard<std::mutex> lock(outputMutex_);
+    if (clear) {
+      outputQueue_.clear();
+    }
+    if (outputQueue_.size() < kMaxQueuedOutputBatches) {
+      promises.swap(blockedProducers_);
+    }
+  }
+  for (auto& promise : promises) {
+    promise.setValue();
+  }
+}
+
 std::shared_ptr<ColumnarBatch> WholeStageResultIterator::next() {
-  addSplits_(task_.get());
-  if (task_->isFinished()) {
+  auto vector = coalesceTargetRows_ > 0 ? nextCoalescedVector() : nextVector();
+  if (vector == nullptr) {
     return nullptr;
   }
-  velox::RowVectorPtr vector = task_->next();
-  if (vector == nullptr) {
+  return std::make_shared<VeloxColumnarBatch>(vector);
+}
+
+velox::RowVectorPtr WholeStageResultIterator::nextVector() {
+  if (outputFinished_) {
     return nullptr;
   }
-  uint64_t numRows = vector->size();
-  if (numRows == 0) {
+  velox::RowVectorPtr vector;
+  if (numDrivers_ > 0) {
+    if (!taskStarted_) {
+      velox::exec::Task::start(task_, numDrivers_);
+      taskStarted_ = true;
+    }
+    addSplits_(task_.get());
+    vector = dequeueOutput();
+  } else {
+    addSplits_(task_.get());
+    if (task_->isFinished()) {
+      outputFinished_ = true;
+      return nullptr;
+    }
+    vector = task_->next();
+  }
+  if (vector == nullptr || vector->size() == 0) {
+    outputFinished_ = true;
     return nullptr;
   }
-  return std::make_shared<VeloxColumnarBatch>(vector);
+  return vector;
+}
+
+velox::RowVectorPtr WholeStageResultIterator::nextCoalescedVector() {
+  if (heldVector_ != nullptr) {
+    return std::move(heldVector_);
+  }
+
+  std::vector<velox::RowVectorPtr> pending;
+  uint64_t pendingRows = 0;
+  uint64_t pendingBytes = 0;
+  while (auto vector = nextVector()) {
+    // The pending vectors outlive the next call into the task, so lazy vectors have to be loaded now.
+    for (auto& child : vector->children()) {
+      child->loadedVector();
+    }
+    auto bytes = vector->estimateFlatSize();
+    uint64_t rows = vector->size();
+    if (rows >= coalesceTargetRows_ || (coalesceTargetBytes_ > 0 && bytes >= coalesceTargetBytes_)) {
+      // Large enough on its own, pass it through untouched after the pending output.
+      if (pending.empty()) {
+        return vector;
+      }
+      heldVector_ = std::move(vector);
+      break;
+    }
+    pendingRows += rows;
+    pendingBytes += bytes;
+    pending.push_back(std::move(vector));
+    if (pendingRows >= coalesceTargetRows_ || (coalesceTargetBytes_ > 0 && pendingBytes >= coalesceTargetBytes_) ||
+        (coalesceMaxBatches_ > 0 && pending.size() >= coalesceMaxBatches_)) {
+      break;
+    }
+  }
+
+  if (pending.empty()) {
+    return nullptr;
+  }
+  if (pending.size() == 1) {
+    return pending[0];
+  }
+  auto result = std::static_pointer_cast<velox::RowVector>(
+      velox::BaseVector::create(pending[0]->type(), pendingRows, resultLeafPool_.get()));
+  velox::vector_size_t offset = 0;
+  for (const auto& vector : pending) {
+    result->copy(vector.get(), offset, 0, vector->size());
+    offset += vector->size();
+  }
+  numCoalescedBatches_ += pending.size();
+  return result;
 }
 
 void WholeStageResultIterator::getOrderedNodeIds(
@@ -306,20 +526,7 @@ WholeStageResultIteratorFirstStage::WholeStageResultIteratorFirstStage(
   }
 
   // Set task parameters.
-  std::unordered_set<velox::core::PlanNodeId> emptySet;
-  velox::core::PlanFragment planFragment{planNode, velox::core::ExecutionStrategy::kUngrouped, 1, emptySet};
-  std::shared_ptr<velox::core::QueryCtx> queryCtx = createNewVeloxQueryCtx();
-
-  task_ = std::make_shared<velox::exec::Task>(
-      fmt::format("Gluten stage-{} task-{}", taskInfo.stageId, taskInfo.taskId),
-      std::move(planFragment),
-      0,
-      std::move(queryCtx));
-
-  if (!task_->supportsSingleThreadedExecution()) {
-    throw std::runtime_error("Task doesn't support single thread execution: " + planNode->toString());
-  }
-  task_->setSpillDirectory(spillDir);
+  createTask(fmt::format("Gluten stage-{} task-{}", taskInfo.stageId, taskInfo.taskId), spillDir);
   addSplits_ = [&](velox::exec::Task* task) {
     if (noMoreSplits_) {
       return;
@@ -386,20 +593,7 @@ WholeStageResultIteratorMiddleStage::WholeStageResultIteratorMiddleStage(
     const std::unordered_map<std::string, std::string>& confMap,
     const SparkTaskInfo taskInfo)
     : WholeStageResultIterator(pool, resultLeafPool, planNode, confMap), streamIds_(streamIds) {
-  std::unordered_set<velox::core::PlanNodeId> emptySet;
-  velox::core::PlanFragment planFragment{planNode, velox::core::ExecutionStrategy::kUngrouped, 1, emptySet};
-  std::shared_ptr<velox::core::QueryCtx> queryCtx = createNewVeloxQueryCtx();
-
-  task_ = std::make_shared<velox::exec::Task>(
-      fmt::format("Gluten stage-{} task-{}", taskInfo.stageId, taskInfo.taskId),
-      std::move(planFragment),
-      0,
-      std::move(queryCtx));
-
-  if (!task_->supportsSingleThreadedExecution()) {
-    throw std::runtime_error("Task doesn't support single thread execution: " + planNode->toString());
-  }
-  task_->setSpillDirectory(spillDir);
+  createTask(fmt::format("Gluten stage-{} task-{}", taskInfo.stageId, taskInfo.taskId), spillDir);
   addSplits_ = [&](velox::exec::Task* task) {
     if (noMoreSplits_) {
       return;
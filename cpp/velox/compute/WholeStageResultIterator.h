@@ -1,5 +1,9 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 #include "compute/Backend.h"
 #include "memory/ColumnarBatchIterator.h"
 #include "memory/VeloxColumnarBatch.h"
@@ -11,6 +15,10 @@
 
 namespace gluten {
 
+/// Number of drivers to run a task with. Values greater than 1 enable multi-driver execution
+/// for the plans that can be split into parallel pipelines.
+const std::string kNumTaskDrivers = "spark.gluten.sql.columnar.backend.velox.numTaskDrivers";
+
 class WholeStageResultIterator : public ColumnarBatchIterator {
  public:
   WholeStageResultIterator(
@@ -24,8 +32,11 @@ class WholeStageResultIterator : public ColumnarBatchIterator {
 
   virtual ~WholeStageResultIterator() {
     if (task_ != nullptr && task_->isRunning()) {
+      auto future = task_->requestCancel();
+      // Unblock the drivers waiting for the output queue to drain so that they can observe the cancellation.
+      releaseBlockedProducers(true);
       // calling .wait() may take no effect in single thread execution mode
-      task_->requestCancel().wait();
+      future.wait();
     }
   };
 
@@ -34,6 +45,7 @@ class WholeStageResultIterator : public ColumnarBatchIterator {
   std::shared_ptr<Metrics> getMetrics(int64_t exportNanos) {
     collectMetrics();
     metrics_->veloxToArrow = exportNanos;
+    metrics_->numCoalescedBatches = numCoalescedBatches_;
     return metrics_;
   }
 
@@ -53,9 +65,34 @@ class WholeStageResultIterator : public ColumnarBatchIterator {
   /// Get config value by key.
   std::string getConfigValue(const std::string& key, const std::optional<std::string>& fallbackValue = std::nullopt);
 
-  std::shared_ptr<facebook::velox::core::QueryCtx> createNewVeloxQueryCtx();
+  std::shared_ptr<facebook::velox::core::QueryCtx> createNewVeloxQueryCtx(folly::Executor* executor = nullptr);
+
+  /// Create the Velox task. Runs it with multiple drivers on the shared driver executor if requested by
+  /// kNumTaskDrivers and permitted by the plan, otherwise in single-threaded mode.
+  void createTask(const std::string& taskId, const std::string& spillDir);
 
  private:
+  /// Output batches are buffered by at most this many batches before the drivers get blocked.
+  static constexpr size_t kMaxQueuedOutputBatches = 4;
+
+  /// Next output vector of the task. Return nullptr when the task is done.
+  facebook::velox::RowVectorPtr nextVector();
+
+  /// Merge consecutive small output vectors into one until reaching the coalesce targets. Vectors reaching
+  /// the targets on their own are passed through.
+  facebook::velox::RowVectorPtr nextCoalescedVector();
+
+  /// Callback of the task output in multi-driver mode. Called from the driver threads.
+  facebook::velox::exec::BlockingReason enqueueOutput(
+      facebook::velox::RowVectorPtr vector,
+      facebook::velox::ContinueFuture* future);
+
+  /// Wait for the next output vector produced by the drivers. Return nullptr when the task is done.
+  facebook::velox::RowVectorPtr dequeueOutput();
+
+  /// Resume the drivers blocked on a full output queue. Drop the queued output if 'clear' is true.
+  void releaseBlockedProducers(bool clear);
+
   /// Set the Spark confs to Velox query context.
   void setConfToQueryContext(const std::shared_ptr<facebook::velox::core::QueryCtx>& queryCtx);
 
@@ -86,6 +123,26 @@ class WholeStageResultIterator : public ColumnarBatchIterator {
 
   /// Node ids should be ommited in metrics.
   std::unordered_set<facebook::velox::core::PlanNodeId> omittedNodeIds_;
+
+  /// Number of drivers the task is started with. 0 means single-threaded execution through Task::next().
+  uint32_t numDrivers_ = 0;
+  bool taskStarted_ = false;
+  bool outputFinished_ = false;
+
+  /// Output coalescing, disabled if the target rows is 0. A target bytes or max batches of 0 means unlimited.
+  uint64_t coalesceTargetRows_ = 0;
+  uint64_t coalesceTargetBytes_ = 0;
+  uint32_t coalesceMaxBatches_ = 0;
+  /// A large vector read while coalescing, returned on the next call.
+  facebook::velox::RowVectorPtr heldVector_;
+  /// Number of task output vectors merged into coalesced batches.
+  int64_t numCoalescedBatches_ = 0;
+
+  /// Output of the drivers in multi-driver mode.
+  std::mutex outputMutex_;
+  std::condition_variable outputCv_;
+  std::deque<facebook::velox::RowVectorPtr> outputQueue_;
+  std::vector<facebook::velox::ContinuePromise> blockedProducers_;
 };
 
 class WholeStageResultIteratorFirstStage final : public WholeStageResultIterator {
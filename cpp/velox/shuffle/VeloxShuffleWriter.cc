@@ -74,6 +74,19 @@ bool vectorHasNull(const velox::VectorPtr& vp) {
   return vp->countNulls(nulls, vp->size()) != 0;
 }
 
+// Strings wrapped in a dictionary over flat values, e.g. read from Parquet dictionary pages. The validity is taken
+// from the dictionary, so the values must not have nulls.
+bool isDictionaryEncodedBinary(const velox::VectorPtr& vp) {
+  if (vp->encoding() != velox::VectorEncoding::Simple::DICTIONARY) {
+    return false;
+  }
+  if (vp->typeKind() != velox::TypeKind::VARCHAR && vp->typeKind() != velox::TypeKind::VARBINARY) {
+    return false;
+  }
+  const auto& base = vp->valueVector();
+  return base->encoding() == velox::VectorEncoding::Simple::FLAT && !base->mayHaveNulls();
+}
+
 } // namespace
 
 // VeloxShuffleWriter
@@ -100,6 +113,10 @@ arrow::Status VeloxShuffleWriter::init() {
   // split record batch size should be less than 32k
   ARROW_CHECK_LE(options_.buffer_size, 32 * 1024);
 
+  if (options_.dictionary_encode && !options_.write_schema) {
+    return arrow::Status::Invalid("Dictionary-encoded shuffle needs the schema written to the shuffle stream");
+  }
+
   ARROW_ASSIGN_OR_RAISE(partitionWriter_, partitionWriterCreator_->make(this));
 
   ARROW_ASSIGN_OR_RAISE(partitioner_, Partitioner::make(options_.partitioning_name, numPartitions_));
@@ -125,6 +142,13 @@ arrow::Status VeloxShuffleWriter::init() {
 
   RETURN_NOT_OK(initIpcWriteOptions());
 
+  // the split complex vectors are buffered until evicted, allocate them from the task's allocator
+  if (options_.memory_allocator != nullptr) {
+    veloxPool_ = asWrappedVeloxAggregateMemoryPool(options_.memory_allocator)->addLeafChild("velox_shuffle_writer");
+  } else {
+    veloxPool_ = getDefaultVeloxLeafMemoryPool();
+  }
+
   // Allocate first buffer for split reducer
   // when partitioner is SinglePart, don`t need init combine_buffer_
   if (options_.partitioning_name != "single") {
@@ -169,11 +193,18 @@ arrow::Status VeloxShuffleWriter::initPartitions(const velox::RowVector& rv) {
     v.resize(numPartitions_);
   });
 
-  partitionListBuilders_.resize(complexColumnIndices_.size());
+  partitionComplexVectors_.resize(complexColumnIndices_.size());
   for (size_t i = 0; i < complexColumnIndices_.size(); ++i) {
-    partitionListBuilders_[i].resize(numPartitions_);
+    partitionComplexVectors_[i].resize(numPartitions_);
   }
 
+  partitionDictionaries_.resize(dictionaryColumnIndices_.size());
+  for (size_t i = 0; i < dictionaryColumnIndices_.size(); ++i) {
+    partitionDictionaries_[i].resize(numPartitions_);
+  }
+  dictionaryBases_.resize(dictionaryColumnIndices_.size());
+  dictionaryBaseVersions_.resize(dictionaryColumnIndices_.size(), 0);
+
   return arrow::Status::OK();
 }
 
@@ -198,7 +229,9 @@ arrow::Status VeloxShuffleWriter::split(ColumnarBatch* cb) {
     // 2. call CacheRecordBatch with RecordBatch
     RETURN_NOT_OK(cacheRecordBatch(0, *batchPtr));
   } else {
-    auto& rv = *veloxColumnBatch->getFlattenedRowVector();
+    auto rvp = options_.dictionary_encode ? getSplittableRowVector(veloxColumnBatch->getRowVector())
+                                          : veloxColumnBatch->getFlattenedRowVector();
+    auto& rv = *rvp;
     RETURN_NOT_OK(initFromRowVector(rv));
     ARROW_ASSIGN_OR_RAISE(auto pid_arr, getFirstColumn(rv));
     RETURN_NOT_OK(partitioner_->compute(pid_arr, rv.size(), row2Partition_, partition2RowCount_));
@@ -212,6 +245,28 @@ arrow::Status VeloxShuffleWriter::split(ColumnarBatch* cb) {
   return arrow::Status::OK();
 }
 
+velox::RowVectorPtr VeloxShuffleWriter::getSplittableRowVector(const velox::RowVectorPtr& rv) const {
+  auto numPidColumns = partitioner_->hasPid() ? 1 : 0;
+  auto children = rv->children();
+  for (size_t i = 0; i < children.size(); ++i) {
+    auto& child = children[i];
+    child = velox::BaseVector::loadedVectorShared(child);
+    if (child->encoding() == velox::VectorEncoding::Simple::FLAT) {
+      continue;
+    }
+    // the first batch decides which columns are split as dictionaries
+    auto isDictionaryColumn = veloxColumnTypes_.empty() ||
+        (i >= numPidColumns && arrowColumnTypes_[i - numPidColumns]->id() == arrow::DictionaryType::type_id);
+    if (isDictionaryColumn && isDictionaryEncodedBinary(child)) {
+      continue;
+    }
+    auto flattened = velox::BaseVector::create(child->type(), child->size(), rv->pool());
+    flattened->copy(child.get(), 0, 0, child->size());
+    child = std::move(flattened);
+  }
+  return std::make_shared<velox::RowVector>(rv->pool(), rv->type(), nullptr, rv->size(), std::move(children));
+}
+
 arrow::Status VeloxShuffleWriter::stop() {
   EVAL_START("write", options_.thread_id)
   RETURN_NOT_OK(partitionWriter_->stop());
@@ -322,6 +377,7 @@ arrow::Status VeloxShuffleWriter::splitRowVector(const velox::RowVector& rv) {
   RETURN_NOT_OK(splitValidityBuffer(rv));
   RETURN_NOT_OK(splitBinaryArray(rv));
   RETURN_NOT_OK(splitListArray(rv));
+  RETURN_NOT_OK(splitDictionaryArray(rv));
   return arrow::Status::OK();
 }
 
@@ -514,6 +570,32 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
     return arrow::Status::OK();
   }
 
+#if defined(__x86_64__)
+  __attribute__((target("avx512f"))) void VeloxShuffleWriter::gatherAvx512(
+      const uint32_t* src, const uint32_t* rowIds, uint32_t size, uint32_t* dst) {
+    uint32_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+      auto indices = _mm512_loadu_si512(rowIds + i);
+      _mm512_storeu_si512(dst + i, _mm512_i32gather_epi32(indices, src, sizeof(uint32_t)));
+    }
+    for (; i < size; ++i) {
+      dst[i] = src[rowIds[i]];
+    }
+  }
+
+  __attribute__((target("avx512f"))) void VeloxShuffleWriter::gatherAvx512(
+      const uint64_t* src, const uint32_t* rowIds, uint32_t size, uint64_t* dst) {
+    uint32_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+      auto indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowIds + i));
+      _mm512_storeu_si512(dst + i, _mm512_i32gather_epi64(indices, src, sizeof(uint64_t)));
+    }
+    for (; i < size; ++i) {
+      dst[i] = src[rowIds[i]];
+    }
+  }
+#endif
+
   arrow::Status VeloxShuffleWriter::splitBoolType(const uint8_t* srcAddr, const std::vector<uint8_t*>& dstAddrs) {
     // assume batch size = 32k; reducer# = 4K; row/reducer = 8
     for (auto pid = 0; pid < numPartitions_; ++pid) {
@@ -545,7 +627,16 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
           continue;
         }
         dstOffset += dstOffsetInByte;
-        // now dst_offset is 8 aligned
+        // now dst_offset is 8 aligned, assemble 64 bits before each store
+        for (; r + 64 < size; r += 64) {
+          uint64_t word = 0;
+          for (auto i = 0; i < 64; ++i) {
+            auto srcOffset = rowOffset2RowId_[r + i];
+            word |= static_cast<uint64_t>((srcAddr[srcOffset >> 3] >> (srcOffset & 7)) & 1) << i;
+          }
+          memcpy(dstaddr + (dstOffset >> 3), &word, sizeof(word));
+          dstOffset += 64;
+        }
         for (; r + 8 < size; r += 8) {
           uint8_t src = 0;
           auto srcOffset = rowOffset2RowId_[r]; /*16k*/
@@ -697,27 +788,102 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
   }
 
   arrow::Status VeloxShuffleWriter::splitListArray(const velox::RowVector& rv) {
+    std::vector<velox::BaseVector::CopyRange> ranges;
     for (size_t i = 0; i < complexColumnIndices_.size(); ++i) {
       auto colIdx = complexColumnIndices_[i];
-      auto column = rv.childAt(colIdx);
+      const auto& column = rv.childAt(colIdx);
 
-      // TODO: rethink the cost of `exportToArrow+ImportArray`
-      ArrowArray arrowArray;
-      velox::exportToArrow(column, arrowArray, getDefaultVeloxLeafMemoryPool().get());
-
-      auto result = arrow::ImportArray(&arrowArray, arrowColumnTypes_[colIdx]);
-      RETURN_NOT_OK(result);
+      for (auto pid = 0; pid < numPartitions_; ++pid) {
+        auto pos = partition2RowOffset_[pid];
+        auto end = partition2RowOffset_[pid + 1];
+        if (pos == end) {
+          continue;
+        }
 
-      auto numRows = rv.size();
-      for (auto row = 0; row < numRows; ++row) {
-        auto partition = row2Partition_[row];
-        RETURN_NOT_OK(partitionListBuilders_[i][partition]->AppendArraySlice(*((*result)->data().get()), row, 1));
+        // append the rows of this partition to its vector, consecutive rows are merged into one range
+        auto& dst = partitionComplexVectors_[i][pid];
+        velox::vector_size_t targetIndex = dst->size();
+        ranges.clear();
+        for (; pos < end; ++pos) {
+          velox::vector_size_t rowId = rowOffset2RowId_[pos];
+          if (!ranges.empty() && ranges.back().sourceIndex + ranges.back().count == rowId) {
+            ranges.back().count++;
+          } else {
+            ranges.push_back({rowId, targetIndex, 1});
+          }
+          ++targetIndex;
+        }
+        dst->resize(targetIndex);
+        dst->copyRanges(column.get(), folly::Range(ranges.data(), ranges.size()));
       }
     }
 
     return arrow::Status::OK();
   }
 
+  arrow::Status VeloxShuffleWriter::splitDictionaryArray(const velox::RowVector& rv) {
+    for (size_t i = 0; i < dictionaryColumnIndices_.size(); ++i) {
+      const auto& column = rv.childAt(dictionaryColumnIndices_[i]);
+      // dictionary-encoded input is mapped once per distinct index, flat input is looked up by value
+      const velox::StringView* values;
+      const velox::vector_size_t* indices = nullptr;
+      if (column->encoding() == velox::VectorEncoding::Simple::DICTIONARY) {
+        const auto& base = column->valueVector();
+        if (base != dictionaryBases_[i]) {
+          dictionaryBases_[i] = base;
+          ++dictionaryBaseVersions_[i];
+        }
+        values = base->asFlatVector<velox::StringView>()->rawValues();
+        indices = column->wrapInfo()->as<velox::vector_size_t>();
+      } else {
+        auto flatColumn = column->asFlatVector<velox::StringView>();
+        assert(flatColumn);
+        values = flatColumn->rawValues();
+      }
+      auto nulls = column->rawNulls();
+
+      for (auto pid = 0; pid < numPartitions_; ++pid) {
+        auto pos = partition2RowOffset_[pid];
+        auto end = partition2RowOffset_[pid + 1];
+        if (pos == end) {
+          continue;
+        }
+
+        auto& dictionary = partitionDictionaries_[i][pid];
+        if (dictionary.values == nullptr) {
+          dictionary.values = std::make_unique<arrow::BinaryBuilder>(options_.memory_pool.get());
+        }
+        if (indices != nullptr && dictionary.baseVersion != dictionaryBaseVersions_[i]) {
+          dictionary.baseIndices.assign(dictionaryBases_[i]->size(), -1);
+          dictionary.baseVersion = dictionaryBaseVersions_[i];
+        }
+
+        auto validity = dictionary.validity->mutable_data();
+        auto dst = reinterpret_cast<int32_t*>(dictionary.indices->mutable_data());
+        for (auto row = partitionBufferIdxBase_[pid]; pos < end; ++pos, ++row) {
+          auto rowId = rowOffset2RowId_[pos];
+          // the indices of null rows are not necessarily valid
+          if (nulls != nullptr && velox::bits::isBitNull(nulls, rowId)) {
+            arrow::bit_util::ClearBit(validity, row);
+            dst[row] = 0;
+            continue;
+          }
+          arrow::bit_util::SetBit(validity, row);
+          if (indices == nullptr) {
+            ARROW_ASSIGN_OR_RAISE(dst[row], dictionary.indexOf(values[rowId]));
+            continue;
+          }
+          auto& index = dictionary.baseIndices[indices[rowId]];
+          if (index < 0) {
+            ARROW_ASSIGN_OR_RAISE(index, dictionary.indexOf(values[indices[rowId]]));
+          }
+          dst[row] = index;
+        }
+      }
+    }
+    return arrow::Status::OK();
+  }
+
   arrow::Status VeloxShuffleWriter::splitBinaryArray(const velox::RowVector& rv) {
     for (auto col = fixedWidthColumnCount_; col < simpleColumnIndices_.size(); ++col) {
       auto binaryIdx = col - fixedWidthColumnCount_;
@@ -773,8 +939,22 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
     // get arrow_column_types_ from schema
     ARROW_ASSIGN_OR_RAISE(arrowColumnTypes_, toShuffleWriterTypeId(schema_->fields()));
 
+    if (options_.dictionary_encode) {
+      auto numPidColumns = partitioner_->hasPid() ? 1 : 0;
+      for (size_t i = 0; i < arrowColumnTypes_.size(); ++i) {
+        if (isDictionaryEncodedBinary(rv.childAt(i + numPidColumns))) {
+          auto type = arrow::dictionary(arrow::int32(), schema_->field(i)->type());
+          ARROW_ASSIGN_OR_RAISE(schema_, schema_->SetField(i, schema_->field(i)->WithType(type)));
+          arrowColumnTypes_[i] = type;
+        }
+      }
+    }
+
     for (size_t i = 0; i < arrowColumnTypes_.size(); ++i) {
       switch (arrowColumnTypes_[i]->id()) {
+        case arrow::DictionaryType::type_id:
+          dictionaryColumnIndices_.push_back(i);
+          break;
         case arrow::BinaryType::type_id:
         case arrow::StringType::type_id:
         case arrow::LargeBinaryType::type_id:
@@ -805,6 +985,13 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
 
     inputHasNull_.resize(simpleColumnIndices_.size(), false);
 
+    // the ids the reader assigns to the dictionary fields of the schema
+    arrow::ipc::DictionaryFieldMapper dictFieldMapper(*schema_);
+    for (auto colIdx : dictionaryColumnIndices_) {
+      ARROW_ASSIGN_OR_RAISE(auto id, dictFieldMapper.GetFieldId({static_cast<int>(colIdx)}));
+      dictionaryIds_.push_back(id);
+    }
+
     return arrow::Status::OK();
   }
 
@@ -869,6 +1056,7 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
       // `bool(1) >> 3` gets 0, so +7
       sizePerRow += ((arrow::bit_width(arrowColumnTypes_[colIdx]->id()) + 7) >> 3);
     }
+    sizePerRow += dictionaryColumnIndices_.size() * sizeof(int32_t);
 
     VS_PRINTLF(size_per_row);
 
@@ -909,8 +1097,7 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
     auto fixedWidthIdx = 0;
     auto binaryIdx = 0;
     auto listIdx = 0;
-
-    std::vector<std::shared_ptr<arrow::ArrayBuilder>> newListBuilders;
+    auto dictionaryIdx = 0;
 
     for (auto i = 0; i < numFields; ++i) {
       size_t sizeofBinaryOffset = -1;
@@ -957,14 +1144,19 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
         case arrow::MapType::type_id:
         case arrow::LargeListType::type_id:
         case arrow::ListType::type_id: {
-          std::unique_ptr<arrow::ArrayBuilder> arrayBuilder;
-          RETURN_NOT_OK(MakeBuilder(options_.memory_pool.get(), arrowColumnTypes_[i], &arrayBuilder));
-          assert(arrayBuilder != nullptr);
-          RETURN_NOT_OK(arrayBuilder->Reserve(newSize));
-          partitionListBuilders_[listIdx][partitionId] = std::move(arrayBuilder);
+          partitionComplexVectors_[listIdx][partitionId] =
+              velox::BaseVector::create(veloxColumnTypes_[i], 0, veloxPool_.get());
           listIdx++;
           break;
         }
+        case arrow::DictionaryType::type_id: {
+          // every bit of the validity is written by the split, no need to initialize it
+          auto& dictionary = partitionDictionaries_[dictionaryIdx][partitionId];
+          ARROW_RETURN_NOT_OK(allocateBufferFromPool(dictionary.validity, arrow::bit_util::BytesForBits(newSize)));
+          ARROW_RETURN_NOT_OK(allocateBufferFromPool(dictionary.indices, newSize * sizeof(int32_t)));
+          dictionaryIdx++;
+          break;
+        }
         case arrow::NullType::type_id:
           break;
         default: {
@@ -1035,6 +1227,7 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
     auto fixedWidthIdx = 0;
     auto binaryIdx = 0;
     auto listIdx = 0;
+    auto dictionaryIdx = 0;
     auto numFields = schema_->num_fields();
     auto numRows = partitionBufferIdxBase_[partitionId];
 
@@ -1098,16 +1291,39 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
         case arrow::MapType::type_id:
         case arrow::LargeListType::type_id:
         case arrow::ListType::type_id: {
-          auto& builder = partitionListBuilders_[listIdx][partitionId];
+          auto& vector = partitionComplexVectors_[listIdx][partitionId];
+          ArrowArray arrowArray;
+          velox::exportToArrow(vector, arrowArray, veloxPool_.get());
+          ARROW_ASSIGN_OR_RAISE(arrays[i], arrow::ImportArray(&arrowArray, arrowColumnTypes_[i]));
+          // the exported array still references the vector's buffers, collect the following rows into a new one
+          vector = velox::BaseVector::create(veloxColumnTypes_[i], 0, veloxPool_.get());
+          listIdx++;
+          break;
+        }
+        case arrow::DictionaryType::type_id: {
+          auto& dictionary = partitionDictionaries_[dictionaryIdx][partitionId];
+          auto indices = arrow::MakeArray(arrow::ArrayData::Make(
+              arrow::int32(),
+              numRows,
+              {arrow::SliceBuffer(dictionary.validity, 0, arrow::bit_util::BytesForBits(numRows)),
+               arrow::SliceBuffer(dictionary.indices, 0, numRows * sizeof(int32_t))}));
+          std::shared_ptr<arrow::Array> values;
+          RETURN_NOT_OK(dictionary.values->Finish(&values));
+          // the builder makes binary values, the dictionary has the type of the column
+          auto valuesData = values->data()->Copy();
+          valuesData->type =
+              arrow::internal::checked_cast<const arrow::DictionaryType&>(*arrowColumnTypes_[i]).value_type();
+          arrays[i] =
+              std::make_shared<arrow::DictionaryArray>(arrowColumnTypes_[i], indices, arrow::MakeArray(valuesData));
+
+          // the following rows start a new dictionary
+          dictionary.valueIndices.clear();
+          dictionary.baseVersion = -1;
           if (resetBuffers) {
-            RETURN_NOT_OK(builder->Finish(&arrays[i]));
-            builder->Reset();
-          } else {
-            RETURN_NOT_OK(builder->Finish(&arrays[i]));
-            builder->Reset();
-            RETURN_NOT_OK(builder->Reserve(numRows));
+            dictionary.validity.reset();
+            dictionary.indices.reset();
           }
-          listIdx++;
+          dictionaryIdx++;
           break;
         }
         case arrow::NullType::type_id: {
@@ -1143,30 +1359,25 @@ arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVec
     return cacheRecordBatch(partitionId, *rb);
   }
 
-  namespace {
-
-  int64_t getBatchNbytes(const arrow::RecordBatch& rb) {
-    int64_t accumulated = 0L;
-
-    for (const auto& array : rb.columns()) {
-      if (array == nullptr || array->data() == nullptr) {
-        continue;
-      }
-      for (const auto& buf : array->data()->buffers) {
-        if (buf == nullptr) {
-          continue;
-        }
-        accumulated += buf->size();
-      }
-    }
-    return accumulated;
-  }
-
-  } // namespace
-
   arrow::Status VeloxShuffleWriter::cacheRecordBatch(uint32_t partitionId, const arrow::RecordBatch& rb) {
     int64_t rawSize = getBatchNbytes(rb);
     rawPartitionLengths_[partitionId] += rawSize;
+    // the dictionaries of the batch precede it in the stream, replacing those of the previous batch
+    for (size_t i = 0; i < dictionaryColumnIndices_.size(); ++i) {
+      const auto& dictionary =
+          arrow::internal::checked_cast<const arrow::DictionaryArray&>(*rb.column(dictionaryColumnIndices_[i]))
+              .dictionary();
+      const auto& writeOptions = dictionary->length() <= options_.batch_compress_threshold
+          ? tinyBatchWriteOptions_
+          : options_.ipc_write_options;
+      auto dictionaryPayload = std::make_shared<arrow::ipc::IpcPayload>();
+      TIME_NANO_OR_RAISE(
+          totalCompressTime_,
+          arrow::ipc::GetDictionaryPayload(dictionaryIds_[i], dictionary, writeOptions, dictionaryPayload.get()));
+      rawPartitionLengths_[partitionId] += getBufferSizes(dictionary);
+      partitionCachedRecordbatchSize_[partitionId] += dictionaryPayload->body_length;
+      partitionCachedRecordbatch_[partitionId].push_back(std::move(dictionaryPayload));
+    }
     auto payload = std::make_shared<arrow::ipc::IpcPayload>();
 #ifndef SKIPCOMPRESS
     if (rb.num_rows() <= (uint32_t)options_.batch_compress_threshold) {
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "velox/type/Type.h"
@@ -11,7 +12,9 @@
 
 #include <arrow/filesystem/filesystem.h>
 #include <arrow/filesystem/localfs.h>
+#include <arrow/array/builder_binary.h>
 #include <arrow/io/api.h>
+#include <arrow/ipc/dictionary.h>
 #include <arrow/ipc/writer.h>
 #include <arrow/memory_pool.h>
 #include <arrow/record_batch.h>
@@ -92,6 +95,27 @@ class VeloxShuffleWriter final : public ShuffleWriter {
     uint64_t value_offset;
   };
 
+  // Rows of a dictionary-encoded column buffered for one partition, with the distinct values they refer to.
+  struct DictionaryBuff {
+    arrow::Result<int32_t> indexOf(facebook::velox::StringView value) {
+      auto result = valueIndices.try_emplace(std::string(value.data(), value.size()), values->length());
+      if (result.second) {
+        RETURN_NOT_OK(values->Append(value.data(), value.size()));
+      }
+      return result.first->second;
+    }
+
+    std::shared_ptr<arrow::Buffer> validity;
+    // int32 indices into values
+    std::shared_ptr<arrow::Buffer> indices;
+    std::unique_ptr<arrow::BinaryBuilder> values;
+    std::unordered_map<std::string, int32_t> valueIndices;
+    // index in values of each value of the last input dictionary, -1 if it's not added yet
+    std::vector<int32_t> baseIndices;
+    // version of the input dictionary baseIndices refers to
+    int64_t baseVersion = -1;
+  };
+
   static arrow::Result<std::shared_ptr<VeloxShuffleWriter>> create(
       uint32_t numPartitions,
       std::shared_ptr<PartitionWriterCreator> partitionWriterCreator,
@@ -182,6 +206,9 @@ class VeloxShuffleWriter final : public ShuffleWriter {
 
   facebook::velox::RowVector getStrippedRowVector(const facebook::velox::RowVector& rv) const;
 
+  // Flatten the columns, except the dictionary-encoded strings split through their indices.
+  facebook::velox::RowVectorPtr getSplittableRowVector(const facebook::velox::RowVectorPtr& rv) const;
+
   arrow::Status splitRowVector(const facebook::velox::RowVector& rv);
 
   arrow::Status initFromRowVector(const facebook::velox::RowVector& rv);
@@ -223,6 +250,14 @@ class VeloxShuffleWriter final : public ShuffleWriter {
       auto dstPidBase = reinterpret_cast<T*>(partitionBufferIdxOffset_[pid]);
       auto pos = partition2RowOffset_[pid];
       auto end = partition2RowOffset_[pid + 1];
+#if defined(__x86_64__)
+      if constexpr (sizeof(T) == sizeof(uint32_t) || sizeof(T) == sizeof(uint64_t)) {
+        if (supportAvx512_) {
+          gatherAvx512(reinterpret_cast<const T*>(srcAddr), rowOffset2RowId_.data() + pos, end - pos, dstPidBase);
+          continue;
+        }
+      }
+#endif
       for (; pos < end; ++pos) {
         auto rowId = rowOffset2RowId_[pos];
         *dstPidBase++ = reinterpret_cast<const T*>(srcAddr)[rowId]; // copy
@@ -231,6 +266,13 @@ class VeloxShuffleWriter final : public ShuffleWriter {
     return arrow::Status::OK();
   }
 
+#if defined(__x86_64__)
+  // dst[i] = src[rowIds[i]] with 512-bit gathers, only called if supportAvx512_.
+  static void gatherAvx512(const uint32_t* src, const uint32_t* rowIds, uint32_t size, uint32_t* dst);
+
+  static void gatherAvx512(const uint64_t* src, const uint32_t* rowIds, uint32_t size, uint64_t* dst);
+#endif
+
   arrow::Status splitBinaryType(
       uint32_t binaryIdx,
       const facebook::velox::FlatVector<facebook::velox::StringView>& src,
@@ -238,6 +280,8 @@ class VeloxShuffleWriter final : public ShuffleWriter {
 
   arrow::Status splitListArray(const facebook::velox::RowVector& rv);
 
+  arrow::Status splitDictionaryArray(const facebook::velox::RowVector& rv);
+
   arrow::Result<int32_t> evictLargestPartition(int64_t* size);
 
   arrow::Status evictPartition(uint32_t partitionId);
@@ -303,7 +347,21 @@ class VeloxShuffleWriter final : public ShuffleWriter {
   std::vector<std::vector<uint8_t*>> partitionValidityAddrs_;
   std::vector<std::vector<uint8_t*>> partitionFixedWidthValueAddrs_;
 
-  std::vector<std::vector<std::shared_ptr<arrow::ArrayBuilder>>> partitionListBuilders_;
+  // complex column index -> partition id -> rows split from the input RowVectors, exported to Arrow only
+  // when the partition buffer is cached as a record batch
+  std::vector<std::vector<facebook::velox::VectorPtr>> partitionComplexVectors_;
+  // pool of partitionComplexVectors_
+  std::shared_ptr<facebook::velox::memory::MemoryPool> veloxPool_;
+
+  // string columns split as indices into a dictionary per partition, see ShuffleWriterOptions::dictionary_encode
+  std::vector<uint32_t> dictionaryColumnIndices_;
+  // ids of the dictionary fields of schema_, in the IPC dictionary batches
+  std::vector<int64_t> dictionaryIds_;
+  // dictionary column index -> partition id
+  std::vector<std::vector<DictionaryBuff>> partitionDictionaries_;
+  // dictionary column index -> dictionary of the last dictionary-encoded input, and its version
+  std::vector<facebook::velox::VectorPtr> dictionaryBases_;
+  std::vector<int64_t> dictionaryBaseVersions_;
 
   std::vector<uint64_t> binaryArrayEmpiricalSize_;
 
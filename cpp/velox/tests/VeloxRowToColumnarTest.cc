@@ -299,4 +299,28 @@ TEST_F(VeloxRowToColumnarTest, _allTypes_18rows) {
   makeInputBatch(inputData, schema, &inputBatch);
   testRecordBatchEqual(inputBatch);
 }
+TEST_F(VeloxRowToColumnarTest, nullsAndLongStrings) {
+  auto fBool = field("f_bool", arrow::boolean());
+  auto fInt32 = field("f_int32", arrow::int32());
+  auto fDouble = field("f_double", arrow::float64());
+  auto fString = field("f_string", arrow::utf8());
+  auto fDate = field("f_date", arrow::date32());
+  auto fShortDecimal = field("f_decimal_short_128", arrow::decimal(10, 2));
+  auto fLongDecimal = field("f_decimal_long_128", arrow::decimal(20, 2));
+
+  auto schema = arrow::schema({fBool, fInt32, fDouble, fString, fDate, fShortDecimal, fLongDecimal});
+
+  const std::vector<std::string> inputData = {
+      "[true, null, false]",
+      "[null, 2, -3]",
+      "[1.5, null, 3.5]",
+      R"(["a string longer than the inline size", null, "short"])",
+      "[null, 1, 19000]",
+      R"(["-1.01", null, "2.95"])",
+      R"([null, "-123456789012345678.90", "2.95"])"};
+
+  std::shared_ptr<arrow::RecordBatch> inputBatch;
+  makeInputBatch(inputData, schema, &inputBatch);
+  testRecordBatchEqual(inputBatch);
+}
 } // namespace gluten
@@ -16,6 +16,7 @@
  */
 
 #include "shuffle/VeloxShuffleWriter.h"
+#include "memory/VeloxColumnarBatch.h"
 #include "memory/VeloxMemoryPool.h"
 #include "utils/TestUtils.h"
 
@@ -32,7 +33,10 @@
 #include <gtest/gtest.h>
 
 #include <iostream>
+#include <map>
+#include <optional>
 #include "shuffle/LocalPartitionWriter.h"
+#include "shuffle/reader.h"
 #include "utils/VeloxArrowUtils.h"
 
 using namespace facebook;
@@ -314,6 +318,216 @@ TEST_F(VeloxShuffleWriterTest, TestRoundRobinPartitioner) {
   }
 }
 
+TEST_F(VeloxShuffleWriterTest, TestRoundRobinDictionaryEncodedInput) {
+  // Wrap every column in a dictionary reversing the rows.
+  ARROW_ASSIGN_OR_THROW(auto cb, recordBatch2VeloxColumnarBatch(*inputBatch1_));
+  auto rv = std::dynamic_pointer_cast<VeloxColumnarBatch>(cb)->getRowVector();
+  auto pool = getDefaultVeloxLeafMemoryPool().get();
+  auto numRows = rv->size();
+  auto indices = velox::allocateIndices(numRows, pool);
+  auto rawIndices = indices->asMutable<velox::vector_size_t>();
+  for (auto i = 0; i < numRows; ++i) {
+    rawIndices[i] = numRows - 1 - i;
+  }
+  std::vector<velox::VectorPtr> children;
+  for (const auto& child : rv->children()) {
+    children.push_back(velox::BaseVector::wrapInDictionary(nullptr, indices, numRows, child));
+  }
+  auto dictionaryCb = std::make_shared<VeloxColumnarBatch>(
+      std::make_shared<velox::RowVector>(pool, rv->type(), nullptr, numRows, std::move(children)));
+
+  int32_t numPartitions = 2;
+  shuffleWriterOptions_.buffer_size = 4;
+  shuffleWriterOptions_.partitioning_name = "rr";
+  ARROW_ASSIGN_OR_THROW(
+      shuffleWriter_, VeloxShuffleWriter::create(numPartitions, partitionWriterCreator_, shuffleWriterOptions_));
+  ASSERT_NOT_OK(shuffleWriter_->split(dictionaryCb.get()));
+  ASSERT_NOT_OK(shuffleWriter_->stop());
+
+  const auto& lengths = shuffleWriter_->partitionLengths();
+  ASSERT_EQ(lengths.size(), 2);
+
+  std::shared_ptr<arrow::RecordBatch> reversed;
+  ARROW_ASSIGN_OR_THROW(reversed, takeRows(inputBatch1_, "[9, 8, 7, 6, 5, 4, 3, 2, 1, 0]"))
+  std::vector<std::string> partitionRows = {"[0, 2, 4, 6, 8]", "[1, 3, 5, 7, 9]"};
+  for (auto pid = 0; pid < numPartitions; ++pid) {
+    std::shared_ptr<arrow::RecordBatch> expected;
+    ARROW_ASSIGN_OR_THROW(expected, takeRows(reversed, partitionRows[pid]))
+
+    std::shared_ptr<arrow::ipc::RecordBatchReader> fileReader;
+    ARROW_ASSIGN_OR_THROW(fileReader, getRecordBatchStreamReader(shuffleWriter_->dataFile()));
+    if (pid > 0) {
+      ASSERT_NOT_OK(file_->Advance(lengths[0]));
+    }
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    ASSERT_NOT_OK(fileReader->ReadAll(&batches));
+    ASSERT_EQ(batches.size(), 1);
+    ASSERT_TRUE(batches[0]->Equals(*expected));
+  }
+}
+
+TEST_F(VeloxShuffleWriterTest, TestRoundRobinDictionaryEncode) {
+  // The string column arrives dictionary-encoded, then flat, then over another dictionary. Every batch is split
+  // through the indices, and read back as dictionaries by the shuffle reader.
+  auto pool = getDefaultVeloxLeafMemoryPool().get();
+  auto rowType = velox::ROW({"f_int32", "f_string"}, {velox::INTEGER(), velox::VARCHAR()});
+  auto makeStrings = [pool](const std::vector<std::string>& values) {
+    auto vector =
+        velox::BaseVector::create<velox::FlatVector<velox::StringView>>(velox::VARCHAR(), values.size(), pool);
+    for (size_t i = 0; i < values.size(); ++i) {
+      vector->set(i, velox::StringView(values[i]));
+    }
+    return vector;
+  };
+  std::vector<std::string> values0 = {"asia", "europe", "america"};
+  std::vector<std::string> values1 = {"africa", "europe"};
+  auto dictionary0 = makeStrings(values0);
+  auto dictionary1 = makeStrings(values1);
+
+  // row id -> expected string, the ids are unique across the batches
+  std::map<int32_t, std::optional<std::string>> expected;
+  constexpr int32_t kNumRows = 10;
+  auto makeBatch = [&](int32_t batchIdx) {
+    auto ids = velox::BaseVector::create<velox::FlatVector<int32_t>>(velox::INTEGER(), kNumRows, pool);
+    for (int32_t row = 0; row < kNumRows; ++row) {
+      ids->set(row, batchIdx * kNumRows + row);
+    }
+    velox::VectorPtr strings;
+    if (batchIdx == 2) {
+      std::vector<std::string> values;
+      for (int32_t row = 0; row < kNumRows; ++row) {
+        values.push_back(row % 3 == 0 ? "oceania" : "europe");
+      }
+      auto flat = makeStrings(values);
+      flat->setNull(5, true);
+      for (int32_t row = 0; row < kNumRows; ++row) {
+        expected[batchIdx * kNumRows + row] = row == 5 ? std::nullopt : std::optional<std::string>(values[row]);
+      }
+      strings = flat;
+    } else {
+      const auto& dictionary = batchIdx == 1 ? dictionary1 : dictionary0;
+      const auto& values = batchIdx == 1 ? values1 : values0;
+      auto indices = velox::allocateIndices(kNumRows, pool);
+      auto rawIndices = indices->asMutable<velox::vector_size_t>();
+      auto nulls = velox::allocateNulls(kNumRows, pool);
+      for (int32_t row = 0; row < kNumRows; ++row) {
+        rawIndices[row] = row % values.size();
+        auto isNull = batchIdx == 0 && (row == 4 || row == 7);
+        velox::bits::setNull(nulls->asMutable<uint64_t>(), row, isNull);
+        expected[batchIdx * kNumRows + row] =
+            isNull ? std::nullopt : std::optional<std::string>(values[rawIndices[row]]);
+      }
+      strings = velox::BaseVector::wrapInDictionary(nulls, indices, kNumRows, dictionary);
+    }
+    std::vector<velox::VectorPtr> children = {ids, strings};
+    return std::make_shared<VeloxColumnarBatch>(
+        std::make_shared<velox::RowVector>(pool, rowType, nullptr, kNumRows, std::move(children)));
+  };
+
+  int32_t numPartitions = 2;
+  shuffleWriterOptions_.buffer_size = 4;
+  shuffleWriterOptions_.partitioning_name = "rr";
+  shuffleWriterOptions_.dictionary_encode = true;
+  ARROW_ASSIGN_OR_THROW(
+      shuffleWriter_, VeloxShuffleWriter::create(numPartitions, partitionWriterCreator_, shuffleWriterOptions_));
+  for (int32_t batchIdx = 0; batchIdx < 4; ++batchIdx) {
+    ASSERT_NOT_OK(shuffleWriter_->split(makeBatch(batchIdx).get()));
+  }
+  ASSERT_NOT_OK(shuffleWriter_->stop());
+
+  const auto& lengths = shuffleWriter_->partitionLengths();
+  ASSERT_EQ(lengths.size(), 2);
+  ARROW_ASSIGN_OR_THROW(file_, arrow::io::ReadableFile::Open(shuffleWriter_->dataFile()));
+
+  // read synchronously, and with prefetching and coalescing over batches of different dictionaries
+  std::vector<ReaderOptions> readerOptions(2, ReaderOptions::defaults());
+  readerOptions[1].prefetch_depth = 2;
+  readerOptions[1].coalesce_target_rows = 100;
+  auto schema = arrow::schema({arrow::field("f_int32", arrow::int32()), arrow::field("f_string", arrow::utf8())});
+  for (const auto& options : readerOptions) {
+    int64_t offset = 0;
+    int32_t numRowsRead = 0;
+    for (auto pid = 0; pid < numPartitions; ++pid) {
+      ARROW_ASSIGN_OR_THROW(auto in, arrow::io::RandomAccessFile::GetStream(file_, offset, lengths[pid]));
+      offset += lengths[pid];
+      Reader reader(in, schema, options, getDefaultArrowMemoryPool());
+      while (true) {
+        ARROW_ASSIGN_OR_THROW(auto batch, reader.next());
+        if (batch == nullptr) {
+          break;
+        }
+        auto rb = std::dynamic_pointer_cast<ArrowColumnarBatch>(batch)->getRecordBatch();
+        ASSERT_EQ(rb->column(1)->type_id(), arrow::Type::DICTIONARY);
+
+        // the velox batch of the reader side keeps the dictionary
+        auto rv = convertBatch(getDefaultVeloxLeafMemoryPool(), batch);
+        ASSERT_EQ(rv->childAt(1)->encoding(), velox::VectorEncoding::Simple::DICTIONARY);
+        auto ids = rv->childAt(0)->as<velox::SimpleVector<int32_t>>();
+        auto strings = rv->childAt(1)->as<velox::SimpleVector<velox::StringView>>();
+        for (auto row = 0; row < rv->size(); ++row) {
+          auto id = ids->valueAt(row);
+          ASSERT_EQ(id % numPartitions, pid);
+          const auto& value = expected.at(id);
+          ASSERT_EQ(strings->isNullAt(row), !value.has_value());
+          if (value.has_value()) {
+            ASSERT_EQ(strings->valueAt(row).str(), *value);
+          }
+        }
+        numRowsRead += rv->size();
+      }
+      ASSERT_NOT_OK(reader.close());
+    }
+    ASSERT_EQ(numRowsRead, static_cast<int32_t>(expected.size()));
+  }
+}
+
+TEST_F(VeloxShuffleWriterTest, TestRoundRobinLargeFixedWidthBatch) {
+  // More than 64 rows per partition, so that the bitmaps are also assembled a word at a time.
+  auto rbSchema = arrow::schema(
+      {arrow::field("f_int32", arrow::int32()),
+       arrow::field("f_int64", arrow::int64()),
+       arrow::field("f_bool", arrow::boolean())});
+  const int32_t numRows = 300;
+  std::string int32Json, int64Json, boolJson, evenRows, oddRows;
+  for (auto i = 0; i < numRows; ++i) {
+    auto sep = i == 0 ? "" : ", ";
+    int32Json += sep + (i % 5 == 0 ? std::string("null") : std::to_string(i * 7));
+    int64Json += sep + std::to_string(i * 1000003L);
+    boolJson += sep + (i % 7 == 0 ? std::string("null") : (i % 3 == 0 ? "true" : "false"));
+    auto& partitionRows = i % 2 == 0 ? evenRows : oddRows;
+    partitionRows += (partitionRows.empty() ? "" : ", ") + std::to_string(i);
+  }
+  std::shared_ptr<arrow::RecordBatch> inputBatch;
+  makeInputBatch({"[" + int32Json + "]", "[" + int64Json + "]", "[" + boolJson + "]"}, rbSchema, &inputBatch);
+
+  int32_t numPartitions = 2;
+  shuffleWriterOptions_.buffer_size = 4;
+  shuffleWriterOptions_.partitioning_name = "rr";
+  ARROW_ASSIGN_OR_THROW(
+      shuffleWriter_, VeloxShuffleWriter::create(numPartitions, partitionWriterCreator_, shuffleWriterOptions_));
+  ASSERT_NOT_OK(splitRecordBatch(*shuffleWriter_, *inputBatch));
+  ASSERT_NOT_OK(shuffleWriter_->stop());
+
+  const auto& lengths = shuffleWriter_->partitionLengths();
+  ASSERT_EQ(lengths.size(), 2);
+
+  std::vector<std::string> partitionRows = {"[" + evenRows + "]", "[" + oddRows + "]"};
+  for (auto pid = 0; pid < numPartitions; ++pid) {
+    std::shared_ptr<arrow::RecordBatch> expected;
+    ARROW_ASSIGN_OR_THROW(expected, takeRows(inputBatch, partitionRows[pid]))
+
+    std::shared_ptr<arrow::ipc::RecordBatchReader> fileReader;
+    ARROW_ASSIGN_OR_THROW(fileReader, getRecordBatchStreamReader(shuffleWriter_->dataFile()));
+    if (pid > 0) {
+      ASSERT_NOT_OK(file_->Advance(lengths[0]));
+    }
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    ASSERT_NOT_OK(fileReader->ReadAll(&batches));
+    ASSERT_EQ(batches.size(), 1);
+    ASSERT_TRUE(batches[0]->Equals(*expected));
+  }
+}
+
 TEST_F(VeloxShuffleWriterTest, TestShuffleWriterMemoryLeak) {
   std::shared_ptr<arrow::MemoryPool> pool = std::make_shared<MyMemoryPool>(17 * 1024 * 1024);
 
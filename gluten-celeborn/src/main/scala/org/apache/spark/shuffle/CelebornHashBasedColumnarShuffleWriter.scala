@@ -124,6 +124,7 @@ class CelebornHashBasedColumnarShuffleWriter[K, V](
             customizedCompressionCodec,
             batchCompressThreshold,
             celebornConf.pushBufferMaxSize,
+            GlutenConfig.getConf.columnarShuffleCelebornPushQueueSize,
             celebornPartitionPusher,
             NativeMemoryAllocators
               .createSpillable(new Spiller() {
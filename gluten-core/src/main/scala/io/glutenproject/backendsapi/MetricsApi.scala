@@ -29,6 +29,10 @@ trait MetricsApi extends Serializable {
     Map(
       "pipelineTime" -> SQLMetrics.createTimingMetric(sparkContext, "duration"))
 
+  /** Updates the metrics of the whole stage itself, e.g. metrics of its output batches. */
+  def wholeStageMetricsUpdatingFunction(metrics: Map[String, SQLMetric]): IMetrics => Unit =
+    _ => ()
+
   def metricsUpdatingFunction(
       child: SparkPlan,
       relMap: java.util.HashMap[java.lang.Long, java.util.ArrayList[java.lang.Long]],
@@ -50,6 +50,15 @@ object TaskResources extends Logging {
     TaskContext.get() != null
   }
 
+  /** Run the current thread on behalf of the given task, for helper threads of the task. */
+  def setLocalTaskContext(tc: TaskContext): Unit = {
+    TaskContext.setTaskContext(tc)
+  }
+
+  def unsetLocalTaskContext(): Unit = {
+    TaskContext.unset()
+  }
+
   def getSparkMemoryManager(): TaskMemoryManager = {
     getLocalTaskContext().taskMemoryManager()
   }
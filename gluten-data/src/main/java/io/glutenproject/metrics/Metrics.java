@@ -60,6 +60,7 @@ public class Metrics implements IMetrics {
       long[] cpuCount,
       long[] wallNanos,
       long veloxToArrow,
+      long numCoalescedBatches,
       long[] peakMemoryBytes,
       long[] numMemoryAllocations,
       long[] spilledBytes,
@@ -87,6 +88,7 @@ public class Metrics implements IMetrics {
     this.wallNanos = wallNanos;
     this.scanTime = scanTime;
     this.singleMetric.veloxToArrow = veloxToArrow;
+    this.singleMetric.numCoalescedBatches = numCoalescedBatches;
     this.peakMemoryBytes = peakMemoryBytes;
     this.numMemoryAllocations = numMemoryAllocations;
     this.spilledBytes = spilledBytes;
@@ -142,5 +144,6 @@ public class Metrics implements IMetrics {
 
   public static class SingleMetric {
     public long veloxToArrow;
+    public long numCoalescedBatches;
   }
 }
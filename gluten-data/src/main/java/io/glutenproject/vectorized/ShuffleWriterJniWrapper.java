@@ -37,16 +37,18 @@ public class ShuffleWriterJniWrapper extends JniInitialized {
    * @param localDirs configured local directories where Spark can write files
    * @param preferEvict
    * @param memoryPoolId
+   * @param dictionaryEncode split dictionary-encoded string columns through their indices,
+   * requires writeSchema
    * @return native shuffle writer instance id if created successfully.
    */
   public long make(NativePartitioning part, long offheapPerTask, int bufferSize, String codec,
                    int batchCompressThreshold, String dataFile, int subDirsPerLocalDir,
                    String localDirs, boolean preferEvict, long memoryPoolId, boolean writeSchema,
-                   long handle, long taskAttemptId) {
+                   boolean dictionaryEncode, long handle, long taskAttemptId) {
       return nativeMake(part.getShortName(), part.getNumPartitions(),
           offheapPerTask, bufferSize, codec, batchCompressThreshold, dataFile,
           subDirsPerLocalDir, localDirs, preferEvict, memoryPoolId,
-          writeSchema, handle, taskAttemptId, 0, null, "local");
+          writeSchema, dictionaryEncode, handle, taskAttemptId, 0, 0, null, "local");
   }
 
   /**
@@ -55,27 +57,30 @@ public class ShuffleWriterJniWrapper extends JniInitialized {
    * @param part contains the partitioning parameter needed by native shuffle writer
    * @param bufferSize size of native buffers hold by partition writer
    * @param codec compression codec
+   * @param pushQueueSize number of serialized buffers queued for the background pusher,
+   * 0 to push on the task thread
    * @param memoryPoolId
    * @return native shuffle writer instance id if created successfully.
    */
   public long makeForRSS(NativePartitioning part, long offheapPerTask,
                          int bufferSize, String codec, int batchCompressThreshold,
-                         int pushBufferMaxSize, Object pusher,
+                         int pushBufferMaxSize, int pushQueueSize, Object pusher,
                          long memoryPoolId, long handle,
                          long taskAttemptId, String partitionWriterType) {
       return nativeMake(part.getShortName(), part.getNumPartitions(),
           offheapPerTask, bufferSize, codec, batchCompressThreshold, null,
           0, null, true, memoryPoolId,
-          false, handle, taskAttemptId, pushBufferMaxSize, pusher, partitionWriterType);
+          false, false, handle, taskAttemptId, pushBufferMaxSize, pushQueueSize, pusher,
+          partitionWriterType);
   }
 
   public native long nativeMake(String shortName, int numPartitions,
                                 long offheapPerTask, int bufferSize,
                                 String codec, int batchCompressThreshold, String dataFile,
                                 int subDirsPerLocalDir, String localDirs, boolean preferEvict,
-                                long memoryPoolId, boolean writeSchema,
+                                long memoryPoolId, boolean writeSchema, boolean dictionaryEncode,
                                 long handle, long taskAttemptId, int pushBufferMaxSize,
-                                Object pusher, String partitionWriterType);
+                                int pushQueueSize, Object pusher, String partitionWriterType);
 
   /**
    * Evict partition data.
@@ -20,6 +20,7 @@ import io.glutenproject.execution._
 import io.glutenproject.substrait.{AggregationParams, JoinParams}
 import org.apache.spark.internal.Logging
 import org.apache.spark.sql.execution.SparkPlan
+import org.apache.spark.sql.execution.metric.SQLMetric
 
 object MetricsUtil extends Logging {
 
@@ -63,6 +64,20 @@ object MetricsUtil extends Logging {
   }
 
 
+  /**
+   * Update the metrics of the whole stage, which are reported once per task and not per operator.
+   *
+   * @param metrics
+   * the metrics of the whole stage transformer
+   */
+  def updateWholeStageMetrics(metrics: Map[String, SQLMetric]): IMetrics => Unit = {
+    val numCoalescedBatches = metrics("numCoalescedBatches")
+    imetrics => {
+      val singleMetrics = imetrics.asInstanceOf[Metrics].getSingleMetrics
+      numCoalescedBatches += singleMetrics.numCoalescedBatches
+    }
+  }
+
   /**
    * Merge several suites of metrics together.
    *
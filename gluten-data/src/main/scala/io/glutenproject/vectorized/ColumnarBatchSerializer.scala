@@ -20,6 +20,7 @@ package io.glutenproject.vectorized
 import java.io._
 import java.nio.ByteBuffer
 import scala.reflect.ClassTag
+import io.glutenproject.GlutenConfig
 import io.glutenproject.columnarbatch.GlutenColumnarBatches
 import io.glutenproject.memory.alloc.NativeMemoryAllocators
 import io.glutenproject.memory.arrowalloc.ArrowBufferAllocators
@@ -68,7 +69,10 @@ private class ColumnarBatchSerializerInstance(schema: StructType,
         ArrowAbiUtil.exportSchema(allocator, arrowSchema, cSchema)
         val handle = ShuffleReaderJniWrapper.INSTANCE.make(
           jniByteInputStream, cSchema.memoryAddress(),
-          NativeMemoryAllocators.contextInstance.getNativeInstanceId)
+          NativeMemoryAllocators.contextInstance.getNativeInstanceId,
+          GlutenConfig.getConf.columnarShuffleReaderPrefetchDepth,
+          GlutenConfig.getConf.columnarShuffleReaderCoalesceTargetRows,
+          GlutenConfig.getConf.columnarShuffleReaderCoalesceTargetBytes)
         // Close shuffle reader instance as lately as the end of task processing,
         // since the native reader could hold a reference to memory pool that
         // was used to create all buffers read from shuffle reader. The pool
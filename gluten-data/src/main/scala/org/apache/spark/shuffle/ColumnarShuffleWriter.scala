@@ -75,7 +75,10 @@ class ColumnarShuffleWriter[K, V](shuffleBlockResolver: IndexShuffleBlockResolve
 
   private val preferSpill = GlutenConfig.getConf.columnarShufflePreferSpill
 
-  private val writeSchema = GlutenConfig.getConf.columnarShuffleWriteSchema
+  private val dictionaryEncode = GlutenConfig.getConf.columnarShuffleDictionaryEncode
+
+  // the reader takes the dictionary fields from the schema in the stream
+  private val writeSchema = GlutenConfig.getConf.columnarShuffleWriteSchema || dictionaryEncode
 
   private val jniWrapper = new ShuffleWriterJniWrapper
 
@@ -148,6 +151,7 @@ class ColumnarShuffleWriter[K, V](shuffleBlockResolver: IndexShuffleBlockResolve
                 }
               }).getNativeInstanceId,
             writeSchema,
+            dictionaryEncode,
             handle,
             taskContext.taskAttemptId())
         }
@@ -116,6 +116,9 @@ class GlutenConfig(conf: SQLConf) extends Logging {
 
   def columnarShuffleWriteSchema: Boolean = conf.getConf(COLUMNAR_SHUFFLE_WRITE_SCHEMA_ENABLED)
 
+  def columnarShuffleDictionaryEncode: Boolean =
+    conf.getConf(COLUMNAR_SHUFFLE_DICTIONARY_ENCODE_ENABLED)
+
   def columnarShuffleUseCustomizedCompressionCodec: String = conf.getConf(COLUMNAR_SHUFFLE_CODEC)
 
   def columnarShuffleCodecBackend: Option[String] = conf.getConf(COLUMNAR_SHUFFLE_CODEC_BACKEND)
@@ -129,6 +132,18 @@ class GlutenConfig(conf: SQLConf) extends Logging {
   def columnarShuffleBatchCompressThreshold: Int =
     conf.getConf(COLUMNAR_SHUFFLE_BATCH_COMPRESS_THRESHOLD)
 
+  def columnarShuffleCelebornPushQueueSize: Int =
+    conf.getConf(COLUMNAR_SHUFFLE_CELEBORN_PUSH_QUEUE_SIZE)
+
+  def columnarShuffleReaderPrefetchDepth: Int =
+    conf.getConf(COLUMNAR_SHUFFLE_READER_PREFETCH_DEPTH)
+
+  def columnarShuffleReaderCoalesceTargetRows: Long =
+    conf.getConf(COLUMNAR_SHUFFLE_READER_COALESCE_TARGET_ROWS)
+
+  def columnarShuffleReaderCoalesceTargetBytes: Long =
+    conf.getConf(COLUMNAR_SHUFFLE_READER_COALESCE_TARGET_BYTES)
+
   def maxBatchSize: Int = conf.getConf(COLUMNAR_MAX_BATCH_SIZE)
 
   def enableCoalesceBatches: Boolean = conf.getConf(COLUMNAR_COALESCE_BATCHES_ENABLED)
@@ -186,6 +201,10 @@ class GlutenConfig(conf: SQLConf) extends Logging {
 
   def veloxSplitPreloadPerDriver: Integer = conf.getConf(COLUMNAR_VELOX_SPLIT_PRELOAD_PER_DRIVER)
 
+  def veloxNumTaskDrivers: Integer = conf.getConf(COLUMNAR_VELOX_NUM_TASK_DRIVERS)
+
+  def veloxDriverThreads: Integer = conf.getConf(COLUMNAR_VELOX_DRIVER_THREADS)
+
   def transformPlanLogLevel: String = conf.getConf(TRANSFORM_PLAN_LOG_LEVEL)
 
   def substraitPlanLogLevel: String = conf.getConf(SUBSTRAIT_PLAN_LOG_LEVEL)
@@ -628,6 +647,16 @@ object GlutenConfig {
       .booleanConf
       .createWithDefault(false)
 
+  val COLUMNAR_SHUFFLE_DICTIONARY_ENCODE_ENABLED =
+    buildConf("spark.gluten.sql.columnar.shuffle.dictionaryEncode")
+      .internal()
+      .doc(
+        "Whether to split the string columns which arrive dictionary-encoded through their " +
+          "indices and write their dictionaries once per record batch. Implies " +
+          "spark.gluten.sql.columnar.shuffle.writeSchema. Not supported by remote shuffle services.")
+      .booleanConf
+      .createWithDefault(false)
+
   val COLUMNAR_SHUFFLE_CODEC =
     buildConf("spark.gluten.sql.columnar.shuffle.codec")
       .internal()
@@ -653,6 +682,46 @@ object GlutenConfig {
       .intConf
       .createWithDefault(100)
 
+  val COLUMNAR_SHUFFLE_CELEBORN_PUSH_QUEUE_SIZE =
+    buildConf("spark.gluten.sql.columnar.shuffle.celeborn.pushQueueSize")
+      .internal()
+      .doc(
+        "Number of serialized partition buffers queued for the background thread pushing them " +
+          "to Celeborn, so splitting overlaps with pushing. 0 pushes on the task thread.")
+      .intConf
+      .checkValue(_ >= 0, "must be non-negative")
+      .createWithDefault(0)
+
+  val COLUMNAR_SHUFFLE_READER_PREFETCH_DEPTH =
+    buildConf("spark.gluten.sql.columnar.shuffle.reader.prefetchDepth")
+      .internal()
+      .doc(
+        "Number of shuffle record batches read ahead and decompressed on a background thread. " +
+          "The shuffle stream is still read on the task thread. 0 reads them synchronously.")
+      .intConf
+      .checkValue(_ >= 0, "must be non-negative")
+      .createWithDefault(0)
+
+  val COLUMNAR_SHUFFLE_READER_COALESCE_TARGET_ROWS =
+    buildConf("spark.gluten.sql.columnar.shuffle.reader.coalesceTargetRows")
+      .internal()
+      .doc(
+        "Consecutive small shuffle record batches are merged until they reach this number " +
+          "of rows. 0 disables the row target.")
+      .longConf
+      .checkValue(_ >= 0, "must be non-negative")
+      .createWithDefault(0)
+
+  val COLUMNAR_SHUFFLE_READER_COALESCE_TARGET_BYTES =
+    buildConf("spark.gluten.sql.columnar.shuffle.reader.coalesceTargetBytes")
+      .internal()
+      .doc(
+        "Consecutive small shuffle record batches are merged until they reach this size " +
+          "in bytes. 0 disables the byte target.")
+      .longConf
+      .checkValue(_ >= 0, "must be non-negative")
+      .createWithDefault(0)
+
   val COLUMNAR_MAX_BATCH_SIZE =
     buildConf(GLUTEN_MAX_BATCH_SIZE_KEY)
       .internal()
@@ -795,6 +864,56 @@ object GlutenConfig {
       .intConf
       .createWithDefault(2)
 
+  val COLUMNAR_VELOX_NUM_TASK_DRIVERS =
+    buildConf("spark.gluten.sql.columnar.backend.velox.numTaskDrivers")
+      .internal()
+      .doc(
+        "The number of drivers to run a Velox task with. Values greater than 1 only take effect " +
+          "on plans reading from table scans, otherwise the task runs single-threaded.")
+      .intConf
+      .checkValue(_ >= 1, "must be at least 1")
+      .createWithDefault(1)
+
+  val COLUMNAR_VELOX_OUTPUT_COALESCE_TARGET_ROWS =
+    buildConf("spark.gluten.sql.columnar.backend.velox.outputCoalesceTargetRows")
+      .internal()
+      .doc(
+        "Consecutive small output batches of a Velox task are merged until they reach this number " +
+          "of rows before being returned to Java. Larger batches are passed through. 0 disables it.")
+      .longConf
+      .checkValue(_ >= 0, "must be non-negative")
+      .createWithDefault(0)
+
+  val COLUMNAR_VELOX_OUTPUT_COALESCE_TARGET_BYTES =
+    buildConf("spark.gluten.sql.columnar.backend.velox.outputCoalesceTargetBytes")
+      .internal()
+      .doc(
+        "Merged Velox task output is returned once it reaches this size in bytes. " +
+          "Only takes effect with outputCoalesceTargetRows. 0 disables the byte target.")
+      .longConf
+      .checkValue(_ >= 0, "must be non-negative")
+      .createWithDefault(0)
+
+  val COLUMNAR_VELOX_OUTPUT_COALESCE_MAX_BATCHES =
+    buildConf("spark.gluten.sql.columnar.backend.velox.outputCoalesceMaxBatches")
+      .internal()
+      .doc(
+        "Merged Velox task output is returned after this many input batches even if the targets " +
+          "are not reached. Only takes effect with outputCoalesceTargetRows. 0 means unlimited.")
+      .intConf
+      .checkValue(_ >= 0, "must be non-negative")
+      .createWithDefault(0)
+
+  val COLUMNAR_VELOX_DRIVER_THREADS =
+    buildConf("spark.gluten.sql.columnar.backend.velox.driverThreads")
+      .internal()
+      .doc(
+        "The threads shared by the Velox tasks running with multiple drivers. " +
+          "0 means the number of available processors.")
+      .intConf
+      .checkValue(_ >= 0, "must be non-negative")
+      .createWithDefault(0)
+
   val TRANSFORM_PLAN_LOG_LEVEL =
     buildConf("spark.gluten.sql.transform.logLevel")
       .internal()